@@ -0,0 +1,172 @@
+/*
+ * Build step that writes the files it is given out as a C source defining embedded_assets, for
+ * assets.c. PNGs are decoded here, once, into ARGB pixels so the game never decodes them at
+ * startup. Anything else is written out as the file's bytes.
+ *
+ * bake_assets <output.c> <files>...
+ */
+#define SDL_MAIN_HANDLED
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#define BAKE_MAX_FILES 64
+
+// The file name without its directory, which is what the game asks for
+char* bake_asset_name(char* path){
+
+    char* name = path;
+    for(char* c = path; *c != '\0'; c++){
+
+        if(*c == '/' || *c == '\\'){
+
+            name = c + 1;
+        }
+    }
+
+    return name;
+}
+
+bool bake_is_image(char* path){
+
+    int length = strlen(path);
+
+    return length > 4 && strcmp(path + length - 4, ".png") == 0;
+}
+
+bool bake_image(FILE* output, int index, char* path, int* width, int* height){
+
+    SDL_Surface* loaded_surface = IMG_Load(path);
+    if(loaded_surface == NULL){
+
+        printf("Unable to load %s! SDL Error: %s\n", path, IMG_GetError());
+        return false;
+    }
+    SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded_surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(loaded_surface);
+    if(surface == NULL){
+
+        printf("Unable to convert %s! SDL Error: %s\n", path, SDL_GetError());
+        return false;
+    }
+
+    *width = surface->w;
+    *height = surface->h;
+    fprintf(output, "static const Uint32 asset_%i[] = {", index);
+    SDL_LockSurface(surface);
+    for(int y = 0; y < surface->h; y++){
+
+        Uint32* row = (Uint32*)((Uint8*)surface->pixels + (y * surface->pitch));
+        for(int x = 0; x < surface->w; x++){
+
+            fprintf(output, "%s0x%08X,", x % 8 == 0 ? "\n    " : " ", row[x]);
+        }
+    }
+    SDL_UnlockSurface(surface);
+    fprintf(output, "\n};\n\n");
+    SDL_FreeSurface(surface);
+
+    return true;
+}
+
+bool bake_bytes(FILE* output, int index, char* path, long* size){
+
+    FILE* file = fopen(path, "rb");
+    if(file == NULL){
+
+        printf("Unable to open %s!\n", path);
+        return false;
+    }
+
+    fprintf(output, "static const unsigned char asset_%i[] = {", index);
+    *size = 0;
+    int byte;
+    while((byte = fgetc(file)) != EOF){
+
+        fprintf(output, "%s%i,", *size % 24 == 0 ? "\n    " : "", byte);
+        (*size)++;
+    }
+    fprintf(output, "\n};\n\n");
+    fclose(file);
+
+    return true;
+}
+
+int main(int argc, char** argv){
+
+    if(argc < 2 || argc - 2 > BAKE_MAX_FILES){
+
+        printf("Usage: bake_assets <output.c> <files>... (at most %i)\n", BAKE_MAX_FILES);
+        return 1;
+    }
+
+    if(!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)){
+
+        printf("Unable to initialize SDL_image! SDL Error: %s\n", IMG_GetError());
+        return 1;
+    }
+
+    // Written next to the real file and renamed, so a failed bake can't leave make a half file that looks up to date
+    char temp_path[256];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", argv[1]);
+    FILE* output = fopen(temp_path, "w");
+    if(output == NULL){
+
+        printf("Unable to write %s!\n", temp_path);
+        return 1;
+    }
+    fprintf(output, "// Generated by bake/bake_assets.c from res/, edit those files instead\n#include \"assets.h\"\n\n");
+
+    int file_count = argc - 2;
+    int widths[BAKE_MAX_FILES];
+    int heights[BAKE_MAX_FILES];
+    long sizes[BAKE_MAX_FILES];
+    bool success = true;
+    for(int i = 0; i < file_count && success; i++){
+
+        char* path = argv[i + 2];
+        widths[i] = 0;
+        heights[i] = 0;
+        sizes[i] = 0;
+        if(bake_is_image(path)){
+
+            success = bake_image(output, i, path, &widths[i], &heights[i]);
+            sizes[i] = widths[i] * heights[i] * sizeof(Uint32);
+
+        }else{
+
+            success = bake_bytes(output, i, path, &sizes[i]);
+        }
+    }
+
+    if(success){
+
+        fprintf(output, "const EmbeddedAsset embedded_assets[] = {\n");
+        for(int i = 0; i < file_count; i++){
+
+            if(widths[i] != 0){
+
+                fprintf(output, "    { \"%s\", %i, %i, asset_%i, NULL, %li },\n", bake_asset_name(argv[i + 2]), widths[i], heights[i], i, sizes[i]);
+
+            }else{
+
+                fprintf(output, "    { \"%s\", 0, 0, NULL, asset_%i, %li },\n", bake_asset_name(argv[i + 2]), i, sizes[i]);
+            }
+        }
+        fprintf(output, "    { NULL, 0, 0, NULL, NULL, 0 }\n};\n\nconst int embedded_asset_count = %i;\n", file_count);
+    }
+
+    success = fclose(output) == 0 && success;
+    if(!success){
+
+        remove(temp_path);
+        return 1;
+    }
+    remove(argv[1]);
+    rename(temp_path, argv[1]);
+    IMG_Quit();
+
+    return 0;
+}
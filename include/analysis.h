@@ -0,0 +1,76 @@
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include "game.h"
+#include "solver.h"
+#include <SDL2/SDL.h>
+
+#define ANALYSIS_NONE 0 // nothing to analyse, the puzzle has no bread yet
+#define ANALYSIS_PENDING 1
+#define ANALYSIS_BOUNDED 2 // known solvable in at most move_count moves, still looking for fewer
+#define ANALYSIS_SOLVABLE 3
+#define ANALYSIS_UNSOLVABLE 4
+#define ANALYSIS_GAVE_UP 5
+
+// How long the layout has to stay unchanged before a search starts
+#define ANALYSIS_DEBOUNCE_MS 250
+#define ANALYSIS_MAX_NODES 5000000
+#define ANALYSIS_CACHE_SIZE 1024 // must be a power of two
+
+typedef struct AnalysisCacheEntry{
+
+    uint64_t hash; // 0 is empty
+    int status;
+    int move_count;
+} AnalysisCacheEntry;
+
+typedef struct AnalysisResult{
+
+    int generation;
+    uint64_t hash;
+    int status;
+    int move_count;
+    long nodes;
+} AnalysisResult;
+
+typedef struct AnalysisRequest{
+
+    int generation;
+    State state;
+} AnalysisRequest;
+
+/*
+ * Solvability of the puzzle being edited, worked out on a worker thread. It follows the same
+ * mailbox and generation scheme as the hint engine. Edits are debounced, and any edit cancels the
+ * search in flight. Layouts seen before come straight from a cache, so undoing an edit is
+ * instant. Small edits usually leave the previous solution working, so the worker replays it
+ * first and reports that length as an upper bound while it searches for the optimum.
+ */
+typedef struct EditorAnalysis{
+
+    SDL_Thread* worker;
+    SDL_sem* wake;
+    SDL_atomic_t generation;
+    SDL_atomic_t quit;
+    void* request_mailbox; // AnalysisRequest*
+    void* result_mailbox; // AnalysisResult*
+
+    // Only touched by the editor thread
+    AnalysisCacheEntry* cache;
+    uint64_t layout_hash; // raw hash of the layout as last seen, to notice edits
+    uint64_t requested_hash; // canonical hash of the layout the status is for
+    unsigned long changed_time;
+    bool request_sent;
+    int status;
+    int move_count;
+    long nodes;
+    int threat_distance[MAX_GOOSE_COUNT]; // turns until each goose reaches its bread, -1 if it can't
+    bool threat_unstoppable[MAX_GOOSE_COUNT]; // nothing the player does can get there first
+} EditorAnalysis;
+
+void analysis_init(EditorAnalysis* analysis);
+void analysis_destroy(EditorAnalysis* analysis);
+// Call every frame with the layout being edited, never blocks. The geese's threats are worked out again only when the layout changes.
+void analysis_update(EditorAnalysis* analysis, State* edited_state, unsigned long current_time);
+
+#endif
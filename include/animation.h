@@ -0,0 +1,60 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include "game.h"
+#include "camera.h"
+#include <SDL2/SDL.h>
+
+#define ANIMATION_TICK_RATE 240 // fixed steps per second
+#define ANIMATION_MOVE_TICKS 30 // an eighth of a second per move
+#define ANIMATION_SCALE 1024 // a blend of this much is all the way to the newer state
+#define ANIMATION_QUEUE_SIZE 8
+#define FRAME_CLOCK_SPIN_US 1000 // the most of a frame's wait spent spinning rather than asleep
+
+/*
+ * Slides everything between the states the game has moved through. States that arrive while one
+ * move is still animating wait in a queue, so input is never held up by an animation. The more
+ * are waiting, the faster they play to catch up, and once the queue is full the oldest waiting
+ * state is skipped. Time advances in fixed ticks, so the animation plays the same at any frame
+ * rate, and the blend includes the part of a tick already elapsed so motion stays smooth.
+ */
+typedef struct Animation{
+
+    State from;
+    State to;
+    int progress; // ticks into the move from from to to
+
+    State queue[ANIMATION_QUEUE_SIZE];
+    int queue_start;
+    int queue_count;
+
+    Uint64 tick_length; // in performance counter units
+    Uint64 accumulator;
+} Animation;
+
+// Paces frames on the performance counter, sleeping for all but the last FRAME_CLOCK_SPIN_US of the wait and spinning for those
+typedef struct FrameClock{
+
+    Uint64 frequency;
+    Uint64 frame_length;
+    Uint64 frame_start;
+    Uint64 second_start;
+    int frames;
+    int fps;
+} FrameClock;
+
+void animation_init(Animation* animation, State* current_state);
+// Queues a state to animate to once everything before it has played
+void animation_push(Animation* animation, State* current_state);
+void animation_advance(Animation* animation, Uint64 elapsed);
+// How far along from animation->from to animation->to things are, 0 to ANIMATION_SCALE
+int animation_blend(Animation* animation);
+bool animation_idle(Animation* animation);
+// Where something is drawn partway through a move, false if it isn't drawn at all
+bool blend_position(Camera* camera, int from_x, int from_y, int to_x, int to_y, int blend, int* screen_x, int* screen_y);
+
+void frame_clock_init(FrameClock* clock, int target_fps);
+// Waits out the rest of the frame and returns how long the whole frame took, in performance counter units
+Uint64 frame_clock_wait(FrameClock* clock);
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <stdbool.h>
+#include "blitter.h"
+
+#define ASSETS_OVERRIDE_PATH "./mods/" // a file here with an asset's name is loaded instead of the built in one
+#define ASSETS_RES_PATH "./res/" // for anything the build didn't embed
+#define ASSETS_FONT "notosans.ttf"
+#define ASSETS_MAX_FONTS 4
+#define ASSETS_MAX_JOBS 64 // requests the pipeline can hold at once, images and fonts together
+#define ASSETS_PIPELINE_THREADS 2
+#define ASSETS_UPLOADS_PER_FRAME 4 // so a burst of finished images can't stall one frame
+
+#define ASSET_PENDING 0
+#define ASSET_DECODED 1 // waiting in the completion queue for the renderer's thread
+#define ASSET_READY 2
+#define ASSET_FAILED 3
+
+/*
+ * Files from res/ baked into the program by bake/bake_assets.c when it is built. Images are
+ * already decoded to ARGB pixels, everything else is kept as the file's bytes.
+ */
+typedef struct EmbeddedAsset{
+
+    const char* name;
+    int width; // 0 for anything that isn't an image
+    int height;
+    const Uint32* pixels;
+    const unsigned char* bytes;
+    long size;
+} EmbeddedAsset;
+
+extern const EmbeddedAsset embedded_assets[];
+extern const int embedded_asset_count;
+// Cleared by starting with --res, everything is then read from ./res/ as though the build had embedded nothing
+extern bool assets_embedded_enabled;
+
+/*
+ * An image the pipeline fills in. The worker decodes into surface and decoded_sprite, only
+ * assets_upload on the renderer's thread moves them into texture and sprite, so drawing code reads
+ * those two without locking and sees NULL until the image is ready.
+ */
+typedef struct AssetImage{
+
+    SDL_Texture* texture;
+    int width;
+    int height;
+    BlitSprite sprite; // the same image for the software framebuffer, if asked for
+
+    char* name;
+    bool make_sprite;
+    SDL_atomic_t status;
+    SDL_Surface* surface;
+    BlitSprite decoded_sprite;
+} AssetImage;
+
+/*
+ * An image by file name, from ./mods/ if it's there, otherwise from the embedded pixels without
+ * decoding anything. A built in image's surface points at the embedded pixels, so it is only for
+ * reading and copying out of. NULL if the image is nowhere to be found.
+ */
+SDL_Surface* assets_load_surface(char* name);
+// The font at a point size, opened once on first use and kept until assets_free. Waits for it if the pipeline is opening it.
+TTF_Font* assets_font(int size);
+// The font if it has been opened, otherwise NULL without waiting, for drawing text as soon as it can be
+TTF_Font* assets_font_ready(int size);
+// Closes the fonts, before TTF_Quit and after assets_pipeline_stop
+void assets_free();
+
+/*
+ * Starts the worker threads that decode images and open fonts in the order they are requested, so
+ * the first frame can be drawn before anything has loaded.
+ */
+bool assets_pipeline_start();
+// Stops the workers, dropping whatever hasn't been uploaded
+void assets_pipeline_stop();
+// Queues an image to be decoded, along with its BlitSprite when make_sprite is set. The image must outlive the pipeline.
+void assets_request_image(AssetImage* image, char* name, bool make_sprite);
+// Queues a font to be opened at a point size
+void assets_request_font(int size);
+// Turns finished images into textures, on the renderer's thread once a frame. Returns how many were uploaded.
+int assets_upload(SDL_Renderer* renderer);
+// Requests not yet opened or uploaded, 0 once everything asked for is ready or has failed
+int assets_outstanding();
+// Destroys an image's texture and sprite
+void assets_free_image(AssetImage* image);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef BLITTER_H
+#define BLITTER_H
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+/*
+ * A sprite kept as premultiplied ARGB pixels. Copies resampled to the tile size being drawn, one
+ * of them mirrored, are made once and reused, so a blit never scales or flips anything.
+ */
+typedef struct BlitSprite{
+
+    Uint32* pixels;
+    int width;
+    int height;
+    bool opaque; // no transparent pixels at all, so rows can just be copied
+
+    int scaled_size; // 0 until first drawn
+    Uint32* scaled;
+    Uint32* scaled_flipped;
+} BlitSprite;
+
+/*
+ * A 32 bit ARGB frame composited on the CPU and uploaded to the renderer once per frame. It
+ * replaces a RenderCopy per sprite with straight row copies for opaque tiles and SIMD alpha
+ * blending for everything else, SSE2 or AVX2 when the CPU has it.
+ */
+typedef struct Framebuffer{
+
+    Uint32* pixels;
+    int width;
+    int height;
+    SDL_Texture* texture;
+} Framebuffer;
+
+bool blit_sprite_from_surface(BlitSprite* sprite, SDL_Surface* surface);
+void blit_sprite_free(BlitSprite* sprite);
+
+bool framebuffer_init(Framebuffer* framebuffer, SDL_Renderer* renderer, int width, int height);
+void framebuffer_free(Framebuffer* framebuffer);
+void framebuffer_clear(Framebuffer* framebuffer, Uint32 color);
+void framebuffer_fill_rect(Framebuffer* framebuffer, int x, int y, int width, int height, Uint32 color);
+// Draws a sprite scaled to size by size with its top left at x, y, clipped to the frame
+void framebuffer_blit(Framebuffer* framebuffer, BlitSprite* sprite, int x, int y, int size, bool flipped);
+// Uploads the frame and copies it over the whole render target
+void framebuffer_present(Framebuffer* framebuffer, SDL_Renderer* renderer);
+
+// Blends a row of premultiplied source pixels over a row of destination pixels
+void blend_row(Uint32* dest, Uint32* source, int count);
+// "avx2", "sse2" or "scalar", whichever blend_row uses on this machine
+char* blitter_kernel_name();
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include "game.h"
+
+#define CAMERA_ZOOM_LEVELS 7
+#define CAMERA_DEFAULT_ZOOM 4 // 32 pixel tiles, the textures' own size
+
+/*
+ * A view onto the map. x and y are the world pixel at the top left of the view, measured at the
+ * current tile size, so a square's screen position is square * tile_size minus them. Tile sizes
+ * are whole pixels so neighbouring tiles never leave seams.
+ */
+typedef struct Camera{
+
+    int x;
+    int y;
+    int zoom; // index into the tile size table
+    int tile_size;
+    int view_width;
+    int view_height;
+} Camera;
+
+void camera_init(Camera* camera, int view_width, int view_height);
+// Keeps as much of the map on screen as possible. A map smaller than the view stays at the top left, as it always was.
+void camera_clamp(Camera* camera, State* current_state);
+void camera_pan(Camera* camera, State* current_state, int delta_x, int delta_y);
+// Zooms by whole levels, keeping the world point under the given screen pixel where it is
+void camera_zoom(Camera* camera, State* current_state, int steps, int screen_x, int screen_y);
+// Scrolls just enough to keep a square at least margin squares from the edge of the view
+void camera_follow(Camera* camera, State* current_state, int square_x, int square_y, int margin);
+
+void camera_screen_to_square(Camera* camera, int screen_x, int screen_y, int* square_x, int* square_y);
+void camera_square_to_screen(Camera* camera, int square_x, int square_y, int* screen_x, int* screen_y);
+bool camera_square_visible(Camera* camera, int square_x, int square_y);
+// Whether a square sized block with its top left at a screen position overlaps the view
+bool camera_block_visible(Camera* camera, int screen_x, int screen_y);
+// The squares of the map inside the view, from left, top up to but not including right, bottom
+void camera_visible_squares(Camera* camera, State* current_state, int* left, int* top, int* right, int* bottom);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include "game.h"
+#include "thumbnail.h"
+
+#define EXPORT_WIDTH 640 // the game's screen
+#define EXPORT_HEIGHT 360
+#define EXPORT_FRAME_RATE 60
+#define EXPORT_BATCH_FRAMES 8 // per thread, rendered together before a raw stream writes them out in order
+
+typedef struct ExportOptions{
+
+    char* puzzle_filename;
+    int* moves; // PLAYER_MOVE_* codes, PLAYER_MOVE_UNDO and REPLAY_RESTART as in a replay
+    int move_count;
+
+    char* output; // a directory for frame_00000.png onwards, or "-" for raw RGBA on stdout
+    int frames_per_move;
+    int hold_frames; // the first and last state are held this long
+    int zoom; // camera zoom level, as in the game
+    int thread_count;
+} ExportOptions;
+
+typedef struct ExportResult{
+
+    int frame_count;
+    double seconds;
+    int thread_count;
+} ExportResult;
+
+void export_default_options(ExportOptions* options);
+/*
+ * Plays the moves through simulate_move once to get every state and where the game's camera would
+ * be for it, then renders the frames on worker threads with render_scene. Every frame
+ * depends only on the two states and the camera it falls between, so threads take frames in any
+ * order. A raw stream still comes out in order, a batch of frames at a time. Returns false if the
+ * puzzle won't load, a move is impossible or the output can't be written.
+ */
+bool export_video(ExportOptions* options, ExportResult* result);
+
+#endif
@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #define NOTHING 0
 #define PLAYER_MOVE_UP 1
@@ -17,11 +18,16 @@
 #define PLAYER_WADDLE_DOWN 8
 #define PLAYER_WADDLE_LEFT 9
 #define PLAYER_MOVE_WAIT 10
+#define MOVE_WORLD_ONLY 16 // flag set by generate_moves on moves after which only the world advances, as with a wait
+#define MOVE_CODE(move) ((move) & 15)
+#define MAX_GENERATED_MOVES 9
 #define TILE_WIDTH 32
 #define TILE_HEIGHT 32
 #define MAX_DUCK_COUNT 16
 #define MAX_BREAD_COUNT 16
 #define MAX_GOOSE_COUNT 16
+#define MAX_MAP_SIZE 512 // squares per side, as far as the editor will resize
+#define MAX_PUZZLE_FILENAME_LENGTH 245 // so "./puzzles/" and the name fit the 256 byte paths puzzles are opened with
 
 typedef struct State{
 
@@ -54,17 +60,57 @@ typedef struct State{
     struct State* previous_state;
 } State;
 
+typedef struct PathNode{
+
+    int direction;
+    int path_length;
+    int x;
+    int y;
+    int score;
+} PathNode;
+
+// Scratch buffers for goose_pathfind, kept around so repeated searches don't allocate
+typedef struct Pathfinder{
+
+    PathNode* frontier;
+    int frontier_capacity;
+    PathNode* explored;
+    int explored_capacity;
+} Pathfinder;
+
 State* get_empty_state();
 void handle_move(State* current_state, int player_move);
+void simulate_move(State* current_state, State* previous_state, int player_move, Pathfinder* pathfinder);
 State* undo_move(State* current_state);
 bool square_occupied(State* current_state, int square_x, int square_y);
 bool square_in_bounds(State* current_state, int square_x, int square_y);
+bool duckling_exists(State* current_state, int duckling_index);
 int get_ducklist_length(State* current_state);
+int generate_moves(State* current_state, int* out);
+void canonicalize_state(State* current_state);
+uint64_t hash_state(State* current_state);
+uint64_t canonical_hash(State* current_state);
+uint64_t get_puzzle_hash(State* initial_state);
+bool states_equal(State* a, State* b);
+int moves_to_win_lower_bound(State* current_state);
+bool state_is_dead(State* current_state);
+int goose_target_bread(State* current_state, int goose_index, int* distance);
+bool goose_wins_race(State* current_state, int goose_index);
+char get_move_char(int player_move);
+int get_move_from_char(char move_char);
 void goose_pathfind(State* current_state, int goose_index);
+void goose_pathfind_with(State* current_state, int goose_index, Pathfinder* pathfinder);
+// Length of goose_pathfind's A* path from the goose to a square, -1 if it can't get there. first_direction gets its first step, -1 if it is already there.
+int goose_path_length(State* current_state, int goose_index, int goal_x, int goal_y, Pathfinder* pathfinder, int* first_direction);
+void pathfinder_init(Pathfinder* pathfinder);
+void pathfinder_free(Pathfinder* pathfinder);
 
 void editor_erase_at(State* current_state, int square_x, int square_y);
-void editor_save_puzzle(State* current_state, char* filename);
+bool editor_save_puzzle(State* current_state, char* filename);
 State* get_from_file(char* filename);
+bool is_puzzle_filename(char* filename);
+char** generate_puzzle_list(int* puzzle_count);
+void free_puzzle_list(char** puzzles, int puzzle_count);
 int get_duckling_count(State* current_state);
 int get_bread_count(State* current_state);
 int get_goose_count(State* current_state);
@@ -0,0 +1,54 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include "game.h"
+#include "solver.h"
+
+// Gives up if this many candidates per requested puzzle turn up nothing
+#define GENERATOR_MAX_CANDIDATES_PER_PUZZLE 100000
+// Workers take candidates from the shared budget this many at a time
+#define GENERATOR_CANDIDATE_BATCH 256
+
+typedef struct GeneratorOptions{
+
+    int puzzle_count;
+    int map_width;
+    int map_height;
+
+    // Entity counts are picked uniformly up to these, with at least one bread
+    int max_ducklings;
+    int max_bread;
+    int max_geese;
+
+    // Accepted puzzles have an optimal solution of this many moves
+    int min_moves;
+    int max_moves;
+    long max_nodes; // candidates that take longer than this to solve are thrown away
+
+    int thread_count;
+    unsigned int seed;
+    char* name_prefix;
+} GeneratorOptions;
+
+typedef struct GeneratorResult{
+
+    int accepted_count;
+    int64_t candidate_count;
+    int64_t trivial_count; // dead from the start or solved in fewer than min_moves
+    int64_t unsolved_count; // unsolvable within max_moves, or too slow to tell
+    int64_t duplicate_count;
+    int move_histogram[SOLVER_MAX_DEPTH + 1];
+    double seconds;
+    int thread_count; // as run, after clamping the options' one
+} GeneratorResult;
+
+void generator_default_options(GeneratorOptions* options);
+/*
+ * Samples random layouts on worker threads and keeps the ones the solver proves solvable in
+ * min_moves to max_moves moves. Accepted puzzles are saved with editor_save_puzzle as
+ * <name_prefix>_<moves>_<hash>.duck and their solutions go in the solution database.
+ * ./puzzles is created if it's missing, and the first puzzle that fails to save stops the run.
+ */
+void generate_puzzles(GeneratorOptions* options, GeneratorResult* result);
+
+#endif
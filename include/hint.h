@@ -0,0 +1,79 @@
+#ifndef HINT_H
+#define HINT_H
+
+#include "game.h"
+#include "solver.h"
+#include <SDL2/SDL.h>
+
+#define HINT_NONE 0
+#define HINT_SEARCHING 1
+#define HINT_FOUND 2
+#define HINT_UNSOLVABLE 3
+#define HINT_GAVE_UP 4 // the node limit was hit, so the state may or may not be solvable
+
+#define HINT_CACHE_SIZE 16384 // must be a power of two
+#define HINT_MAX_NODES 20000000
+
+typedef struct HintCacheEntry{
+
+    uint64_t hash; // 0 is empty
+    signed char move;
+    short moves_left;
+} HintCacheEntry;
+
+// What the worker hands back, covering every state along the solution it found
+typedef struct HintResult{
+
+    int generation;
+    int status;
+    int path_length;
+    uint64_t path_hashes[SOLVER_MAX_DEPTH];
+    signed char path_moves[SOLVER_MAX_DEPTH];
+} HintResult;
+
+typedef struct HintRequest{
+
+    int generation;
+    State state;
+} HintRequest;
+
+/*
+ * Solves for hints on a worker thread so the frame never waits on a search. The game thread and
+ * the worker only meet through two single slot mailboxes that are swapped atomically: the game
+ * thread drops the newest request in one and the worker drops its answer in the other. Every
+ * request or cancel bumps the generation, which the running search polls so that a stale one
+ * stops within a few thousand nodes. Answers are remembered by canonical hash for every state on
+ * the solution, so asking again after following a hint is instant.
+ */
+typedef struct HintEngine{
+
+    SDL_Thread* worker;
+    SDL_sem* wake;
+    SDL_atomic_t generation;
+    SDL_atomic_t quit;
+    void* request_mailbox; // HintRequest*, taken by the worker
+    void* result_mailbox; // HintResult*, taken by hint_poll
+
+    // Only touched by the game thread
+    HintCacheEntry* cache;
+    int status;
+    int move;
+    int moves_left;
+    uint64_t requested_hash;
+
+    // Searches from the puzzle's start are saved to the solution database
+    uint64_t puzzle_hash;
+} HintEngine;
+
+// Starts the worker and seeds the cache with the puzzle's solution if the solution database has it
+void hint_engine_init(HintEngine* engine, State* initial_state);
+void hint_engine_destroy(HintEngine* engine);
+
+// Asks for the next move from current_state, answered at once from the cache when possible, and returns the status
+int hint_request(HintEngine* engine, State* current_state);
+// Drops the current hint and stops any search for it
+void hint_cancel(HintEngine* engine);
+// Collects a finished search, call once a frame
+void hint_poll(HintEngine* engine);
+
+#endif
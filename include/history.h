@@ -0,0 +1,56 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "game.h"
+
+#define HISTORY_DEFAULT_KEYFRAME_INTERVAL 16
+#define HISTORY_DEFAULT_MEMORY_BUDGET (8 * 1024 * 1024)
+// The newest keyframes are never thinned so that undo and recent scrubbing stay cheap
+#define HISTORY_RECENT_KEYFRAMES 8
+
+typedef struct HistoryKeyframe{
+
+    int move_index;
+    State state;
+} HistoryKeyframe;
+
+/*
+ * Timeline of a play session. Moves are deterministic, so a move code is a complete delta:
+ * the timeline stores a full state every keyframe_interval moves plus the moves in between,
+ * four bits each, and rebuilds any point by replaying from the keyframe before it.
+ * Keyframe 0 is the puzzle's start and is always kept, so restarting never replays anything.
+ */
+typedef struct History{
+
+    HistoryKeyframe* keyframes;
+    int keyframe_count;
+    int keyframe_capacity;
+    int keyframe_interval;
+    long memory_budget;
+
+    unsigned char* packed_moves;
+    int move_count;
+    int move_capacity;
+
+    // The state after the first position moves, which is what the game shows
+    State current;
+    int position;
+
+    Pathfinder pathfinder;
+} History;
+
+void history_init(History* history, State* initial_state, int keyframe_interval, long memory_budget);
+void history_free(History* history);
+
+// Plays a move from the current position, discarding any moves after it
+void history_push(History* history, int player_move);
+// Moves the current position to move_index, replaying at most a keyframe interval of moves (more in thinned regions)
+void history_seek(History* history, int move_index);
+// Shortens the timeline to the current position
+void history_truncate(History* history);
+
+State* history_current(History* history);
+int history_get_move(History* history, int index);
+long history_memory_usage(History* history);
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "game.h"
+
+#define EDIT_ENTITY_NONE -1 // painting with nothing erases
+#define EDIT_ENTITY_PLAYER 0
+#define EDIT_ENTITY_DUCKLING 1
+#define EDIT_ENTITY_BREAD 2
+#define EDIT_ENTITY_GOOSE 3
+#define EDIT_ENTITY_MAP 4 // the command's positions are the map's width and height
+
+/*
+ * Every edit is one entity slot moving from one square to another. Placing comes from -1, -1
+ * and erasing goes to -1, -1, so undoing a command is just applying it backwards. Resizing the map
+ * is a command too, moving the map's far corner.
+ */
+typedef struct EditCommand{
+
+    int entity;
+    int slot;
+    int from_x;
+    int from_y;
+    int to_x;
+    int to_y;
+} EditCommand;
+
+/*
+ * Undo/redo journal for the editor. Commands are grouped into batches, so a whole drag or
+ * rectangle is undone in one step. The journal also keeps an occupancy grid of the map. Whether a
+ * square is free is then one lookup instead of a scan over every entity, which keeps big brush
+ * strokes cheap. All edits have to go through the journal so the grid stays in sync.
+ */
+typedef struct EditorJournal{
+
+    EditCommand* commands;
+    int command_count;
+    int command_capacity;
+
+    // Batch i is commands[batch_starts[i]] up to the start of the next one. The first batch_position batches are applied.
+    int* batch_starts;
+    int batch_count;
+    int batch_capacity;
+    int batch_position;
+    bool batch_open;
+
+    // Cell values are entity * 32 + slot, or -1 for empty. Bread sits on its own layer under everything else.
+    short* actor_grid;
+    short* bread_grid;
+    int grid_width;
+    int grid_height;
+} EditorJournal;
+
+void journal_init(EditorJournal* journal, State* current_state);
+void journal_free(EditorJournal* journal);
+// Call after changing the map size outside the journal, journal_resize keeps the grid in step itself
+void journal_rebuild_grid(EditorJournal* journal, State* current_state);
+
+void journal_begin_batch(EditorJournal* journal);
+void journal_end_batch(EditorJournal* journal);
+bool journal_undo(EditorJournal* journal, State* current_state);
+bool journal_redo(EditorJournal* journal, State* current_state);
+
+// True if the player, a duckling or a goose is on the square, the same test as square_occupied
+bool journal_occupied(EditorJournal* journal, int square_x, int square_y);
+/*
+ * Places an entity at a square, or erases the top thing there for EDIT_ENTITY_NONE the same way
+ * editor_erase_at does. Outside a batch the edit is a batch of its own. Anything but
+ * EDIT_ENTITY_NONE up to EDIT_ENTITY_GOOSE paints nothing.
+ */
+bool journal_paint(EditorJournal* journal, State* current_state, int entity, int square_x, int square_y);
+// Paints every square on the line after the first one, for joining up the squares of a drag
+void journal_paint_line(EditorJournal* journal, State* current_state, int entity, int from_x, int from_y, int to_x, int to_y);
+// Paints every square of the rectangle with the given corners as one batch
+void journal_paint_rect(EditorJournal* journal, State* current_state, int entity, int x1, int y1, int x2, int y2);
+/*
+ * Resizes the map as one batch, clamped to 1 up to MAX_MAP_SIZE per side. Anything left outside
+ * is erased, except the player who is pulled back to the nearest square inside.
+ */
+bool journal_resize(EditorJournal* journal, State* current_state, int map_width, int map_height);
+
+#endif
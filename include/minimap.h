@@ -0,0 +1,41 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include "game.h"
+#include "camera.h"
+#include <SDL2/SDL.h>
+
+#define MINIMAP_MAX_SIZE 128 // longest side on screen, in pixels
+#define MINIMAP_MARGIN 4
+
+#define MINIMAP_GRASS 0xFF2E7D32
+#define MINIMAP_PLAYER 0xFFFFFFFF
+#define MINIMAP_DUCKLING 0xFFFFEB3B
+#define MINIMAP_BREAD 0xFFC68642
+#define MINIMAP_GOOSE 0xFF0000FF
+
+/*
+ * An overview of the whole map, one colour per square, written straight into a streaming texture.
+ * The minimap remembers the state it last drew. Each update only repaints the squares that
+ * something entered or left since then, so a move costs a handful of pixel writes however big the
+ * map is. Only a new map size repaints everything.
+ */
+typedef struct Minimap{
+
+    SDL_Texture* texture;
+    int map_width; // of the texture, 0 before the first update
+    int map_height;
+    int scale; // texture pixels per square, more than one on small maps so they aren't blurry
+    State drawn_state;
+} Minimap;
+
+// The colour a square is drawn in, also used by thumbnails of maps too big for sprites
+Uint32 minimap_square_color(State* current_state, int square_x, int square_y);
+
+void minimap_init(Minimap* minimap);
+void minimap_destroy(Minimap* minimap);
+void minimap_update(Minimap* minimap, SDL_Renderer* renderer, State* current_state);
+// Draws the minimap in the top right corner with the camera's view outlined, if the map doesn't fit on screen
+void minimap_render(Minimap* minimap, SDL_Renderer* renderer, Camera* camera);
+
+#endif
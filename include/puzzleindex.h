@@ -0,0 +1,58 @@
+#ifndef PUZZLEINDEX_H
+#define PUZZLEINDEX_H
+
+#include "game.h"
+
+#define PUZZLE_INDEX_PATH "./puzzles.index"
+#define PUZZLE_INDEX_VERSION 2
+#define PUZZLE_INDEX_RESCAN_MS 2000 // without inotify, how often the folder is compared against the index
+
+typedef struct PuzzleIndexEntry{
+
+    char* name;
+    int64_t size;
+    int64_t mtime;
+    uint64_t content_hash; // of the file's bytes
+    uint64_t puzzle_hash; // get_puzzle_hash, to look the puzzle up in the solution database
+
+    bool valid; // false if get_from_file couldn't read it, and the rest is zero
+    int map_width;
+    int map_height;
+    int duckling_count;
+    int bread_count;
+    int goose_count;
+} PuzzleIndexEntry;
+
+/*
+ * Everything the menus need to know about the puzzles folder, kept in ./puzzles.index between
+ * runs. Opening compares the folder against the index by size and modification time and only
+ * reads the puzzles that changed, on a thread of its own so the first frame doesn't wait for it.
+ * Until that is done the index answers nothing and callers read the folder themselves, and the
+ * first puzzle_index_poll after it reports a change. After that the folder is watched with
+ * inotify, so a puzzle saved by the editor or changed by anything else is picked up from its
+ * event alone, without listing the folder again. Where there's no inotify the folder is compared
+ * every PUZZLE_INDEX_RESCAN_MS instead.
+ *
+ * On disk it is the magic "DKPI", a version byte and three reserved bytes, followed by one record
+ * per puzzle: the 16 bit name length, a flags byte (1 is valid), a reserved byte, the 16 bit map
+ * width and height, duckling, bread and goose counts, two reserved bytes, the 64 bit size,
+ * modification time, content hash and puzzle hash, and then the name. Reading stops at the first
+ * torn record, whatever is missing is read from the folder again.
+ */
+bool puzzle_index_open(char* path);
+// Writes the index out if anything changed and stops watching
+void puzzle_index_close();
+
+// Applies whatever has changed in the folder since the last call and returns whether anything did, or whether the index has just finished opening. Only for the main thread.
+bool puzzle_index_poll();
+// Reads one puzzle again right away, for when the game itself has just written it. Waits for the index to finish opening.
+void puzzle_index_update(char* puzzle_filename);
+
+// Copies a puzzle's entry and returns true if it is indexed. The name isn't copied, the entry's is left NULL. Safe to call from any thread, false while the index is opening.
+bool puzzle_index_find(char* puzzle_filename, PuzzleIndexEntry* entry);
+// The indexed names, as generate_puzzle_list would list them, or NULL if the index isn't open yet or is empty
+char** puzzle_index_names(int* puzzle_count);
+// FNV-1a over a file's bytes, 0 if it can't be read. Content hashes are this, so an edit that keeps the size and lands within the same second still shows.
+uint64_t puzzle_index_hash_file(char* path);
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef PUZZLELIST_H
+#define PUZZLELIST_H
+
+#include "game.h"
+#include <SDL2/SDL.h>
+
+#define PUZZLE_LIST_SEARCH_LENGTH 48
+#define PUZZLE_LIST_ROW_CACHE 64 // rows whose text stays drawn, a few screens' worth
+
+#define PUZZLE_METADATA_PENDING 0
+#define PUZZLE_METADATA_READY 1
+#define PUZZLE_METADATA_FAILED 2
+
+typedef struct PuzzleMetadata{
+
+    int map_width;
+    int map_height;
+    int duckling_count;
+    int bread_count;
+    int goose_count;
+    int best_length; // as from solution_db_best_length
+} PuzzleMetadata;
+
+// A row's text, drawn once and kept until another row lands in the same slot
+typedef struct PuzzleListRow{
+
+    int index; // into the sorted files, -1 if empty
+    SDL_Texture* name;
+    int name_width;
+    int name_height;
+    SDL_Texture* details; // NULL until the row's metadata has loaded
+    int details_width;
+    int details_height;
+} PuzzleListRow;
+
+/*
+ * The puzzles folder sorted by name, ignoring case, so a search prefix matches a run of entries
+ * found with two binary searches rather than a pass over the whole library.
+ *
+ * Nothing is read from the puzzle files up front. A loader thread fills in the metadata of
+ * whichever entries were last asked for, normally the rows on screen, and leaves the rest alone.
+ * The names and metadata come from the puzzle index when it's open, so opening the list costs a
+ * copy and a sort, otherwise the folder is listed and each puzzle read as its row comes up.
+ */
+typedef struct PuzzleList{
+
+    char** files;
+    int count;
+
+    char search[PUZZLE_LIST_SEARCH_LENGTH + 1];
+    int search_length;
+    int match_first; // the files starting with the search
+    int match_count;
+    int scroll; // the first match on screen
+
+    PuzzleMetadata* metadata; // only meaningful once its status is READY
+    SDL_atomic_t* metadata_status;
+    SDL_Thread* loader;
+    SDL_sem* wake;
+    SDL_atomic_t window_first;
+    SDL_atomic_t window_last;
+    SDL_atomic_t quit;
+
+    PuzzleListRow rows[PUZZLE_LIST_ROW_CACHE];
+} PuzzleList;
+
+// Lists and sorts the puzzles folder and starts the loader. An empty folder gives an empty list.
+void puzzle_list_load(PuzzleList* list);
+void puzzle_list_free(PuzzleList* list);
+
+// Narrows the matches to the files whose names start with the list's search, in O(log n)
+void puzzle_list_search(PuzzleList* list);
+// Moves scroll as little as possible to put a match on screen
+void puzzle_list_scroll_to(PuzzleList* list, int match, int visible_rows);
+
+// Has the loader read the metadata of files first up to but not including last, before anything else
+void puzzle_list_request(PuzzleList* list, int first, int last);
+// A file's metadata if it has loaded, otherwise NULL
+PuzzleMetadata* puzzle_list_metadata(PuzzleList* list, int index);
+
+// The cache slot for a file's row, emptied first if it last held another row. Only for the renderer's thread.
+PuzzleListRow* puzzle_list_row(PuzzleList* list, int index);
+
+#endif
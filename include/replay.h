@@ -0,0 +1,56 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "game.h"
+
+// Moves are stored as their PLAYER_MOVE_* / PLAYER_WADDLE_* codes, plus this one for a restart after failure
+#define REPLAY_RESTART 11
+#define REPLAY_VERSION 1
+#define REPLAY_MAX_SEQUENCE 100 // replays of one puzzle saved within the same second
+
+/*
+ * A recorded session. On disk it is the magic "DKRP", a version byte, the final victory value,
+ * two reserved bytes, the 64 bit puzzle hash, the 32 bit move count and then the moves packed
+ * two to a byte, low nibble first. All integers are little endian.
+ */
+typedef struct Replay{
+
+    uint64_t puzzle_hash;
+    int victory;
+    int move_count;
+    int move_capacity;
+    unsigned char* packed_moves;
+} Replay;
+
+typedef struct ReplayVerifyResult{
+
+    int replay_count;
+    int valid_count;
+    int mismatch_count; // replayed fine but ended with a different victory than recorded
+    int invalid_count; // unreadable, unknown puzzle or impossible moves
+    long move_count;
+    double seconds;
+
+    // Valid wins whose puzzle is in the solution database, and how many of those matched its move count
+    int known_win_count;
+    int optimal_win_count;
+} ReplayVerifyResult;
+
+void replay_begin(Replay* replay, State* initial_state);
+void replay_record(Replay* replay, int player_move);
+int replay_get_move(Replay* replay, int index);
+void replay_free(Replay* replay);
+bool replay_save(Replay* replay, char* path);
+bool replay_load(Replay* replay, char* path);
+// Saves to ./replays/<puzzle name>_<time>.replay
+bool replay_save_session(Replay* replay, char* puzzle_filename);
+
+/*
+ * Replays each file against the puzzle in ./puzzles/ with the same hash, through handle_move and
+ * undo_move exactly as game_loop applies them, and checks the outcome against the recorded one.
+ * Replays are shared out over thread_count threads. verdicts, if not NULL, gets one entry per path:
+ * 1 valid, 0 outcome mismatch, -1 invalid.
+ */
+void replay_verify_files(char** paths, int path_count, int thread_count, int* verdicts, ReplayVerifyResult* result);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include "game.h"
+#include "camera.h"
+#include "blitter.h"
+#include "assets.h"
+#include <SDL2/SDL.h>
+
+// Each facing sprite set is up, right and down, left being right mirrored
+#define SCENE_DUCK 0
+#define SCENE_DUCKLING 3
+#define SCENE_GOOSE 6
+#define SCENE_GRASS 9
+#define SCENE_BREAD 10
+#define SCENE_SPRITE_COUNT 11
+
+#define SCENE_PLACEHOLDER_COLOR 0xFF404040 // drawn where a sprite is still loading, or missing
+
+/*
+ * Where render_scene draws. With a framebuffer the sprites are blitted into its pixels, which
+ * needs no renderer and so works on any thread. Otherwise the images' textures are copied with
+ * the renderer. Either way a slot that is NULL or not loaded yet is drawn as a flat square.
+ */
+typedef struct SceneTarget{
+
+    SDL_Renderer* renderer;
+    Framebuffer* framebuffer;
+    AssetImage* images[SCENE_SPRITE_COUNT]; // for the renderer
+    BlitSprite* sprites[SCENE_SPRITE_COUNT]; // for the framebuffer
+} SceneTarget;
+
+/*
+ * Draws a camera's view of everything partway between two states, facing the way they do in the
+ * newer one. Only what's in view is drawn, so big maps cost no more than small ones. A framebuffer
+ * is cleared first and left for the caller to present, a renderer is drawn over as it is.
+ */
+void render_scene(SceneTarget* target, State* from, State* to, int blend, Camera* camera);
+
+#endif
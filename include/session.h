@@ -0,0 +1,34 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "game.h"
+#include "history.h"
+
+#define SESSION_VERSION 1
+// Size of one state as written by state_encode
+#define STATE_RECORD_SIZE (2 * (9 + (4 * MAX_DUCK_COUNT) + (2 * MAX_BREAD_COUNT) + (3 * MAX_GOOSE_COUNT)) + MAX_DUCK_COUNT)
+
+/*
+ * Sessions are kept in ./sessions/<puzzle name>.session. The file holds the puzzle hash, the whole
+ * timeline (moves and keyframes as they are in memory) and the current position, so reopening a
+ * puzzle picks up exactly where it was left without replaying anything.
+ */
+
+void state_encode(State* current_state, unsigned char* record);
+void state_decode(unsigned char* record, State* current_state);
+
+/*
+ * Serializes the history right away and queues the bytes for a background thread, which writes
+ * them to a temporary file and renames it over the session, so a crash never leaves half a file.
+ */
+void session_save_async(History* history, char* puzzle_filename);
+// Queues removal of a puzzle's session, ordered after any pending saves
+void session_discard_async(char* puzzle_filename);
+// Waits until every queued save and discard has landed
+void session_flush();
+// Fills history from the puzzle's session if there is one that matches initial_state, otherwise returns false. Flushes first.
+bool session_load(History* history, State* initial_state, char* puzzle_filename);
+// Waits for queued writes to land and stops the writer thread
+void session_shutdown();
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "game.h"
+#include "history.h"
+#include "replay.h"
+#include <SDL2/SDL.h>
+
+#define SIMULATION_MOVE 0 // value is a PLAYER_MOVE_* code, ignored once the puzzle is over
+#define SIMULATION_SEEK 1 // value is a move index, clamped to the timeline
+#define SIMULATION_STEP 2 // value is added to the current position
+#define SIMULATION_RESTART 3 // only after a failure
+#define SIMULATION_QUEUE_SIZE 256 // must be a power of two
+
+typedef struct SimulationCommand{
+
+    int type;
+    int value;
+} SimulationCommand;
+
+// Everything the render thread needs about the timeline, copied out whole
+typedef struct SimulationSnapshot{
+
+    State state;
+    int position;
+    int move_count;
+    int serial; // counts up with every publish, so the render thread can tell a new snapshot from the last one
+} SimulationSnapshot;
+
+/*
+ * Runs a game's moves on a worker thread, so a slow goose turn or a long seek never holds up a
+ * frame. The render thread queues commands into a single producer, single consumer ring. The
+ * worker publishes each state it finishes through a triple buffer: it fills its own back slot and
+ * swaps it with the shared middle one, and the renderer swaps the middle for its front slot
+ * whenever a new one is flagged. Neither side ever waits on the other, and the front slot
+ * holds still for the whole frame.
+ *
+ * The history and replay belong to the worker between simulation_start and simulation_stop.
+ */
+typedef struct Simulation{
+
+    History* history;
+    Replay* replay;
+    int replay_position; // where the replay's line stands in the history, worker only
+
+    SDL_Thread* worker;
+    SDL_sem* wake;
+    SDL_atomic_t quit;
+
+    SimulationCommand commands[SIMULATION_QUEUE_SIZE];
+    SDL_atomic_t command_head; // next slot the render thread writes
+    SDL_atomic_t command_tail; // next slot the worker reads
+
+    SimulationSnapshot snapshots[3];
+    int back; // worker only
+    int publish_count; // worker only
+    SDL_atomic_t middle; // slot index, plus SIMULATION_FRESH when the worker has published since the last take
+    int front; // render thread only
+} Simulation;
+
+void simulation_start(Simulation* simulation, History* history, Replay* replay);
+// Finishes every queued command, then stops the worker and hands the history and replay back
+void simulation_stop(Simulation* simulation);
+// Returns false if the queue is full and the command was dropped
+bool simulation_send(Simulation* simulation, int type, int value);
+// The latest published snapshot, which stays the same until the next call
+SimulationSnapshot* simulation_snapshot(Simulation* simulation);
+
+// Seeks the game's timeline, clamping move_index to it
+void seek_timeline(History* history, int move_index);
+/*
+ * Records the distance between the replay's line and the history's position as undos or replayed
+ * moves. Seeks leave the replay alone, so scrubbing back and forth adds nothing until a move is
+ * made, and then only the net jump goes in ahead of it.
+ */
+void simulation_sync_replay(Simulation* simulation);
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef SOLUTIONDB_H
+#define SOLUTIONDB_H
+
+#include "game.h"
+#include "solver.h"
+
+#define SOLUTION_DB_PATH "./solutions.db"
+#define SOLUTION_DB_VERSION 2
+#define SOLUTION_UNKNOWN -1
+#define SOLUTION_UNSOLVABLE -2
+
+typedef struct SolutionRecord{
+
+    uint64_t puzzle_hash;
+    bool solvable;
+    int move_count;
+    int moves[SOLVER_MAX_DEPTH];
+
+    // How the solution was found
+    long nodes;
+    int milliseconds;
+} SolutionRecord;
+
+/*
+ * Optimal solutions keyed by get_puzzle_hash of the puzzle as loaded by get_from_file. On disk it
+ * is the magic "DKSD", a version byte and three reserved bytes, followed by records that are only
+ * ever appended: the marker "SR", a flags byte (1 is solvable), a reserved byte, the 16 bit move
+ * count, two reserved bytes, the 64 bit hash, the 64 bit node count, the 32 bit solve time in
+ * milliseconds, four reserved bytes and then the moves packed two to a byte, low nibble first.
+ * A later record for the same hash replaces an earlier one. The file is memory mapped and
+ * indexed once when opened, and reading stops at the first torn record. Storing locks the file
+ * and indexes whatever other processes appended before adding to the end.
+ */
+bool solution_db_open(char* path);
+void solution_db_close();
+
+// Fills record and returns true if the puzzle is in the database, safe to call from any thread
+bool solution_db_lookup(uint64_t puzzle_hash, SolutionRecord* record);
+/*
+ * Adds a solution to the database, safe alongside other processes storing to the same file.
+ * Unsolved results aren't kept: a solution can be played back, an unsolvable verdict rests on the
+ * search having merged states correctly. Returns whether anything was written.
+ */
+bool solution_db_store(uint64_t puzzle_hash, SolverResult* result);
+// Returns the optimal move count for a puzzle, SOLUTION_UNKNOWN or SOLUTION_UNSOLVABLE. Never reads the puzzle file, that is up to the caller's thread.
+int solution_db_best_length(uint64_t puzzle_hash);
+
+// Little endian fields, as the database and the puzzle index lay them out
+uint64_t read_uint_le(unsigned char* bytes, int byte_count);
+void write_uint_le(unsigned char* bytes, uint64_t value, int byte_count);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include "game.h"
+
+#define SOLVER_MODE_BFS 0
+#define SOLVER_MODE_IDA 1
+#define SOLVER_MAX_DEPTH 256
+#define SOLVER_CANCEL_INTERVAL 4096
+
+typedef struct SolverOptions{
+
+    int mode;
+    int max_depth;
+    long max_nodes; // 0 is no limit
+    int table_megabytes; // size of the IDA* transposition table
+
+    // Polled every SOLVER_CANCEL_INTERVAL nodes, the search gives up once it returns true. NULL never cancels.
+    bool (*cancelled)(void* data);
+    void* cancel_data;
+} SolverOptions;
+
+typedef struct SolverResult{
+
+    bool solved;
+    bool exhausted; // the whole space within max_depth was searched, so an unsolved puzzle really is unsolvable
+    int move_count;
+    int moves[SOLVER_MAX_DEPTH];
+
+    long nodes;
+    double seconds;
+    long peak_memory_kb;
+} SolverResult;
+
+void solver_default_options(SolverOptions* options);
+/*
+ * Searches for a shortest winning move sequence from initial_state, which is left unchanged.
+ * BFS keeps every distinct state it has seen and needs memory in proportion. IDA* only keeps
+ * the current path plus a fixed size transposition table.
+ */
+bool solve_state(State* initial_state, SolverOptions* options, SolverResult* result);
+long get_peak_memory_kb();
+
+#endif
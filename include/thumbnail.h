@@ -0,0 +1,99 @@
+#ifndef THUMBNAIL_H
+#define THUMBNAIL_H
+
+#include "game.h"
+#include "blitter.h"
+#include "camera.h"
+#include "scene.h"
+#include <SDL2/SDL.h>
+
+#define THUMBNAIL_WIDTH 96
+#define THUMBNAIL_HEIGHT 54
+#define THUMBNAIL_MIN_TILE_SIZE 4 // below this sprites are mush, so squares are drawn as flat colours instead
+#define THUMBNAIL_MAX_THREADS 8
+#define THUMBNAIL_SPRITE_COUNT SCENE_SPRITE_COUNT
+
+#define THUMBNAIL_PENDING 0
+#define THUMBNAIL_READY 1
+#define THUMBNAIL_FAILED 2
+#define THUMBNAIL_WORKING 3
+
+/*
+ * Renders puzzle previews without a window or a renderer, straight into a Framebuffer's pixels
+ * with the blitter's sprites, so any number of them can be drawn at once on worker threads.
+ *
+ * Previews are cached as ./thumbnails/<content hash>.png, named for the puzzle_index_hash_file of
+ * the puzzle they show. Any change to a puzzle's bytes gives it a new name, so a stale preview is
+ * never picked up however the file's times look, and copies of a puzzle share one preview.
+ */
+typedef struct ThumbnailSprites{
+
+    BlitSprite sprites[THUMBNAIL_SPRITE_COUNT];
+} ThumbnailSprites;
+
+typedef struct ThumbnailWorker{
+
+    struct ThumbnailBatch* batch;
+    SDL_Thread* thread;
+    ThumbnailSprites sprites; // sharing the batch's pixels, with scaled copies of its own
+    Framebuffer framebuffer;
+} ThumbnailWorker;
+
+/*
+ * Previews for a list of puzzles, drawn only for the part of the list that has been asked for.
+ * Workers claim pending puzzles in that window in list order, under the same lock the window is
+ * moved under, and publish each preview by setting its status once the pixels are written, then sleep until a new window is asked for. Textures are
+ * made on the thread that owns the renderer, whenever thumbnail_batch_texture is first asked for
+ * one that's ready, and previews falling out of the window are dropped, so a library of any size
+ * only ever holds a window's worth.
+ */
+typedef struct ThumbnailBatch{
+
+    char** puzzle_files;
+    int puzzle_count;
+    SDL_mutex* mutex; // held while a puzzle is claimed and while the window moves
+    int next_puzzle;
+    int window_end;
+    SDL_atomic_t finish; // exit once the window is done instead of waiting for another
+    SDL_atomic_t cancel;
+    SDL_sem* wake;
+    int window_first; // the renderer's thread's copy of the window
+    int window_last;
+    int held_first; // every preview not yet dropped is in here: the window, plus any still being drawn when it last moved
+    int held_last;
+    SDL_atomic_t* status; // THUMBNAIL_PENDING, WORKING, READY or FAILED per puzzle
+    Uint32** pixels; // THUMBNAIL_WIDTH by THUMBNAIL_HEIGHT ARGB, until made into a texture
+    SDL_Texture** textures;
+    SDL_atomic_t rendered_count;
+    SDL_atomic_t cached_count;
+
+    ThumbnailSprites sprites;
+    ThumbnailWorker* workers;
+    int worker_count;
+} ThumbnailBatch;
+
+// Loads the sprite images, the same ones the game draws with
+bool thumbnail_sprites_load(ThumbnailSprites* sprites);
+void thumbnail_sprites_free(ThumbnailSprites* sprites);
+// framebuffer_blit keeps scaled copies in a sprite, so each thread drawing at once needs copies of its own around the shared pixels
+void thumbnail_sprites_share(ThumbnailSprites* sprites, ThumbnailSprites* source);
+// Frees the copies' scaled pixels, leaving the shared ones alone
+void thumbnail_sprites_unshare(ThumbnailSprites* sprites);
+
+// A render_scene target that draws with the sprites into a framebuffer, which needs pixels but no texture
+void thumbnail_scene_target(SceneTarget* target, Framebuffer* framebuffer, ThumbnailSprites* sprites);
+// Draws the whole map fitted and centred in the framebuffer
+void thumbnail_render_state(Framebuffer* framebuffer, ThumbnailSprites* sprites, State* current_state);
+
+// Starts thread_count workers for the puzzles, 0 to pick from the CPU count. The file names are copied. If no worker starts, everything is freed again and it returns false.
+bool thumbnail_batch_start(ThumbnailBatch* batch, char** puzzle_files, int puzzle_count, int thread_count);
+// Has the workers draw puzzles first up to but not including last, dropping finished previews outside them
+void thumbnail_batch_request(ThumbnailBatch* batch, int first, int last);
+// The preview of a puzzle if it has finished, otherwise NULL
+SDL_Texture* thumbnail_batch_texture(ThumbnailBatch* batch, SDL_Renderer* renderer, int index);
+// Waits for every puzzle in the window to be done
+void thumbnail_batch_wait(ThumbnailBatch* batch);
+// Abandons whatever hasn't been started, waits for the rest and frees everything
+void thumbnail_batch_stop(ThumbnailBatch* batch);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef TOOLS_H
+#define TOOLS_H
+
+#include "game.h"
+
+/*
+ * Headless command line tools, run as ./game --<tool> [args].
+ * Returns the process exit code, or -1 if the arguments don't name a tool and the game should start.
+ */
+int run_tool(int argc, char** argv);
+
+int bench_dead_states(int argc, char** argv);
+int check_canonical(int argc, char** argv);
+int solve_puzzle(int argc, char** argv);
+int verify_replays(int argc, char** argv);
+int generate_puzzle_set(int argc, char** argv);
+int bench_blitter(int argc, char** argv);
+int bench_assets(int argc, char** argv);
+int render_thumbnails(int argc, char** argv);
+int export_replay(int argc, char** argv);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef UPSCALE_H
+#define UPSCALE_H
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+/*
+ * Draws each frame at the game's logical resolution into an offscreen target, then blows it up
+ * to the window by the largest whole factor that fits, centred, in a single nearest neighbour
+ * pass. Every sprite and string is drawn once at logical size however big the window is, so only
+ * the final pass grows with the output.
+ *
+ * Accelerated renderers stretch the target in one RenderCopy. The software renderer would stretch
+ * a pixel at a time, so there the frame is read back and widened by a SIMD kernel straight into a
+ * streaming texture the size of the output, which is then copied out unscaled.
+ */
+typedef struct Upscaler{
+
+    int logical_width;
+    int logical_height;
+    int scale;
+    int offset_x; // of the scaled frame in the window, the rest is black bars
+    int offset_y;
+    int output_width; // of the window, to notice resizes
+    int output_height;
+
+    bool software;
+    SDL_Texture* target;
+    SDL_Texture* output; // software only, logical size times scale
+    Uint32* frame; // software only, the target read back
+} Upscaler;
+
+bool upscaler_init(Upscaler* upscaler, SDL_Renderer* renderer, int logical_width, int logical_height);
+void upscaler_free(Upscaler* upscaler);
+// Points rendering at the offscreen target, call before drawing anything for the frame
+void upscaler_begin_frame(Upscaler* upscaler, SDL_Renderer* renderer);
+// Scales the frame onto the window, call just before SDL_RenderPresent
+void upscaler_end_frame(Upscaler* upscaler, SDL_Renderer* renderer);
+// Maps window coordinates to logical ones
+void upscaler_map_point(Upscaler* upscaler, int window_x, int window_y, int* x, int* y);
+
+// Writes each source pixel scale times over, for one row
+void upscale_row(Uint32* dest, Uint32* source, int width, int scale);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef VECENV_H
+#define VECENV_H
+
+#include "game.h"
+
+// Observation channels, each a map_height x map_width plane of 0/1 bytes
+#define VECENV_CHANNEL_PLAYER 0
+#define VECENV_CHANNEL_IDLE_DUCKLING 1
+#define VECENV_CHANNEL_FOLLOWING_DUCKLING 2
+#define VECENV_CHANNEL_WADDLER 3
+#define VECENV_CHANNEL_BREAD 4
+#define VECENV_CHANNEL_HELD_BREAD 5
+#define VECENV_CHANNEL_GOOSE 6
+#define VECENV_CHANNEL_COUNT 7
+
+// How many moves each environment can take back with PLAYER_MOVE_UNDO
+#define VECENV_HISTORY_DEPTH 64
+
+typedef struct VecEnv VecEnv;
+
+/*
+ * Creates env_count copies of the puzzle ./puzzles/filename. With thread_count > 1 every step
+ * splits the environments across that many worker threads. All memory is allocated here, so
+ * stepping and resetting never allocate.
+ */
+VecEnv* vecenv_create(char* filename, int env_count, int thread_count);
+void vecenv_destroy(VecEnv* vecenv);
+
+int vecenv_env_count(VecEnv* vecenv);
+int vecenv_map_width(VecEnv* vecenv);
+int vecenv_map_height(VecEnv* vecenv);
+// Size in bytes of the observation tensor, env_count * VECENV_CHANNEL_COUNT * map_height * map_width
+int vecenv_observation_size(VecEnv* vecenv);
+State* vecenv_get_state(VecEnv* vecenv, int env_index);
+
+// Resets every environment to the puzzle's start and writes their observations
+void vecenv_reset(VecEnv* vecenv, unsigned char* observations);
+
+/*
+ * Applies actions[k] to environment k and writes the resulting observations.
+ * rewards[k] is 1 on victory, -1 on failure and 0 otherwise, and dones[k] is set when the episode ended.
+ * Finished environments are reset immediately, so their observation is the start of the next episode.
+ * rewards and dones may be NULL.
+ */
+void vecenv_step(VecEnv* vecenv, int* actions, unsigned char* observations, float* rewards, bool* dones);
+
+#endif
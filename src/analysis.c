@@ -0,0 +1,266 @@
+#include "analysis.h"
+#include "solutiondb.h"
+
+typedef struct AnalysisSearch{
+
+    EditorAnalysis* analysis;
+    int generation;
+} AnalysisSearch;
+
+int analysis_worker_thread(void* data);
+
+void analysis_init(EditorAnalysis* analysis){
+
+    SDL_AtomicSet(&analysis->generation, 0);
+    SDL_AtomicSet(&analysis->quit, 0);
+    analysis->request_mailbox = NULL;
+    analysis->result_mailbox = NULL;
+
+    analysis->cache = (AnalysisCacheEntry*)calloc(ANALYSIS_CACHE_SIZE, sizeof(AnalysisCacheEntry));
+    analysis->layout_hash = 0;
+    analysis->requested_hash = 0;
+    analysis->changed_time = 0;
+    analysis->request_sent = true;
+    analysis->status = ANALYSIS_NONE;
+    analysis->move_count = -1;
+    analysis->nodes = 0;
+    for(int i = 0; i < MAX_GOOSE_COUNT; i++){
+
+        analysis->threat_distance[i] = -1;
+        analysis->threat_unstoppable[i] = false;
+    }
+
+    analysis->wake = SDL_CreateSemaphore(0);
+    analysis->worker = SDL_CreateThread(analysis_worker_thread, "analysis worker", analysis);
+}
+
+void analysis_destroy(EditorAnalysis* analysis){
+
+    SDL_AtomicSet(&analysis->quit, 1);
+    SDL_AtomicAdd(&analysis->generation, 1);
+    SDL_SemPost(analysis->wake);
+    SDL_WaitThread(analysis->worker, NULL);
+    SDL_DestroySemaphore(analysis->wake);
+
+    free(SDL_AtomicSetPtr(&analysis->request_mailbox, NULL));
+    free(SDL_AtomicSetPtr(&analysis->result_mailbox, NULL));
+    free(analysis->cache);
+    analysis->cache = NULL;
+}
+
+// How soon each goose reaches its bread along the path it would really take, and whether anything can stop it in time
+void analysis_find_threats(EditorAnalysis* analysis, State* snapshot){
+
+    int earliest_win = moves_to_win_lower_bound(snapshot);
+    for(int i = 0; i < MAX_GOOSE_COUNT; i++){
+
+        analysis->threat_distance[i] = -1;
+        analysis->threat_unstoppable[i] = false;
+
+        int target_distance;
+        int target = snapshot->goose_x[i] != -1 ? goose_target_bread(snapshot, i, &target_distance) : -1;
+        if(target == -1){
+
+            continue;
+        }
+
+        // Walled in by the other pieces, at least for now
+        int first_direction;
+        int threat_distance = goose_path_length(snapshot, i, snapshot->bread_x[target], snapshot->bread_y[target], NULL, &first_direction);
+        if(threat_distance == -1){
+
+            continue;
+        }
+
+        analysis->threat_distance[i] = threat_distance;
+        analysis->threat_unstoppable[i] = earliest_win >= threat_distance && goose_wins_race(snapshot, i);
+    }
+}
+
+void analysis_update(EditorAnalysis* analysis, State* edited_state, unsigned long current_time){
+
+    // Analyse the puzzle the way it would be saved
+    State snapshot = *edited_state;
+    snapshot.previous_state = NULL;
+    snapshot.required_bread = get_bread_count(&snapshot);
+
+    uint64_t layout_hash = hash_state(&snapshot);
+    if(layout_hash != analysis->layout_hash){
+
+        // Whatever is in flight is for an old layout now
+        SDL_AtomicAdd(&analysis->generation, 1);
+        analysis->layout_hash = layout_hash;
+        analysis->changed_time = current_time;
+        analysis->requested_hash = canonical_hash(&snapshot);
+        analysis->request_sent = true;
+        analysis->move_count = -1;
+        analysis->nodes = 0;
+        analysis_find_threats(analysis, &snapshot);
+
+        AnalysisCacheEntry* entry = &analysis->cache[analysis->requested_hash & (ANALYSIS_CACHE_SIZE - 1)];
+        if(snapshot.required_bread == 0){
+
+            analysis->status = ANALYSIS_NONE;
+
+        }else if(entry->hash == analysis->requested_hash){
+
+            analysis->status = entry->status;
+            analysis->move_count = entry->move_count;
+
+        }else{
+
+            analysis->status = ANALYSIS_PENDING;
+            analysis->request_sent = false;
+        }
+    }
+
+    AnalysisResult* result = (AnalysisResult*)SDL_AtomicSetPtr(&analysis->result_mailbox, NULL);
+    if(result != NULL){
+
+        if(result->status == ANALYSIS_SOLVABLE || result->status == ANALYSIS_UNSOLVABLE){
+
+            AnalysisCacheEntry* entry = &analysis->cache[result->hash & (ANALYSIS_CACHE_SIZE - 1)];
+            entry->hash = result->hash;
+            entry->status = result->status;
+            entry->move_count = result->move_count;
+        }
+        if(result->generation == SDL_AtomicGet(&analysis->generation)){
+
+            analysis->status = result->status;
+            analysis->move_count = result->move_count;
+            analysis->nodes = result->nodes;
+        }
+        free(result);
+    }
+
+    if(!analysis->request_sent && current_time - analysis->changed_time >= ANALYSIS_DEBOUNCE_MS){
+
+        AnalysisRequest* request = (AnalysisRequest*)malloc(sizeof(AnalysisRequest));
+        request->generation = SDL_AtomicGet(&analysis->generation);
+        request->state = snapshot;
+
+        free(SDL_AtomicSetPtr(&analysis->request_mailbox, request));
+        SDL_SemPost(analysis->wake);
+        analysis->request_sent = true;
+    }
+}
+
+bool analysis_search_cancelled(void* data){
+
+    AnalysisSearch* search = (AnalysisSearch*)data;
+
+    return SDL_AtomicGet(&search->analysis->quit) != 0 || SDL_AtomicGet(&search->analysis->generation) != search->generation;
+}
+
+void analysis_publish(EditorAnalysis* analysis, AnalysisRequest* request, int status, int move_count, long nodes){
+
+    AnalysisResult* result = (AnalysisResult*)malloc(sizeof(AnalysisResult));
+    result->generation = request->generation;
+    result->hash = canonical_hash(&request->state);
+    result->status = status;
+    result->move_count = move_count;
+    result->nodes = nodes;
+
+    free(SDL_AtomicSetPtr(&analysis->result_mailbox, result));
+}
+
+int analysis_worker_thread(void* data){
+
+    EditorAnalysis* analysis = (EditorAnalysis*)data;
+    Pathfinder pathfinder;
+    pathfinder_init(&pathfinder);
+
+    // The last solution found, which often still works after a small edit
+    int last_moves[SOLVER_MAX_DEPTH];
+    int last_move_count = 0;
+
+    while(true){
+
+        SDL_SemWait(analysis->wake);
+        if(SDL_AtomicGet(&analysis->quit) != 0){
+
+            break;
+        }
+
+        AnalysisRequest* request = (AnalysisRequest*)SDL_AtomicSetPtr(&analysis->request_mailbox, NULL);
+        if(request == NULL){
+
+            continue;
+        }
+
+        // Saved puzzles are often already in the solution database
+        SolutionRecord record;
+        if(solution_db_lookup(get_puzzle_hash(&request->state), &record)){
+
+            if(record.solvable){
+
+                memcpy(last_moves, record.moves, record.move_count * sizeof(int));
+                last_move_count = record.move_count;
+            }
+            analysis_publish(analysis, request, record.solvable ? ANALYSIS_SOLVABLE : ANALYSIS_UNSOLVABLE, record.solvable ? record.move_count : -1, 0);
+            free(request);
+            continue;
+        }
+
+        if(state_is_dead(&request->state)){
+
+            analysis_publish(analysis, request, ANALYSIS_UNSOLVABLE, -1, 0);
+            free(request);
+            continue;
+        }
+
+        int bound = -1;
+        State current_state = request->state;
+        for(int i = 0; i < last_move_count && current_state.victory == 0; i++){
+
+            State previous_state = current_state;
+            simulate_move(&current_state, &previous_state, last_moves[i], &pathfinder);
+            if(current_state.victory == 1){
+
+                bound = i + 1;
+            }
+        }
+        if(bound != -1){
+
+            analysis_publish(analysis, request, ANALYSIS_BOUNDED, bound, 0);
+        }
+
+        AnalysisSearch search = { .analysis = analysis, .generation = request->generation };
+        SolverOptions options;
+        solver_default_options(&options);
+        options.max_depth = bound != -1 ? bound : SOLVER_MAX_DEPTH;
+        options.max_nodes = ANALYSIS_MAX_NODES;
+        options.table_megabytes = 16;
+        options.cancelled = analysis_search_cancelled;
+        options.cancel_data = &search;
+
+        SolverResult solution;
+        solve_state(&request->state, &options, &solution);
+        if(analysis_search_cancelled(&search)){
+
+            free(request);
+            continue;
+        }
+
+        if(solution.solved){
+
+            memcpy(last_moves, solution.moves, solution.move_count * sizeof(int));
+            last_move_count = solution.move_count;
+            analysis_publish(analysis, request, ANALYSIS_SOLVABLE, solution.move_count, solution.nodes);
+
+        }else if(solution.exhausted && bound == -1){
+
+            analysis_publish(analysis, request, ANALYSIS_UNSOLVABLE, -1, solution.nodes);
+
+        }else{
+
+            // Too slow to settle, though a known bound still proves it solvable
+            analysis_publish(analysis, request, ANALYSIS_GAVE_UP, bound, solution.nodes);
+        }
+        free(request);
+    }
+
+    pathfinder_free(&pathfinder);
+
+    return 0;
+}
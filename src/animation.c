@@ -0,0 +1,175 @@
+#include "animation.h"
+#include <stdlib.h>
+
+void animation_init(Animation* animation, State* current_state){
+
+    animation->from = *current_state;
+    animation->to = *current_state;
+    animation->progress = ANIMATION_MOVE_TICKS;
+    animation->queue_start = 0;
+    animation->queue_count = 0;
+
+    animation->tick_length = SDL_GetPerformanceFrequency() / ANIMATION_TICK_RATE;
+    animation->accumulator = 0;
+}
+
+bool animation_idle(Animation* animation){
+
+    return animation->progress >= ANIMATION_MOVE_TICKS && animation->queue_count == 0;
+}
+
+void animation_push(Animation* animation, State* current_state){
+
+    // Nothing playing, so start on it straight away
+    if(animation_idle(animation)){
+
+        animation->from = animation->to;
+        animation->to = *current_state;
+        animation->progress = 0;
+        animation->accumulator = 0;
+        return;
+    }
+
+    if(animation->queue_count == ANIMATION_QUEUE_SIZE){
+
+        animation->queue_start = (animation->queue_start + 1) % ANIMATION_QUEUE_SIZE;
+        animation->queue_count--;
+    }
+    animation->queue[(animation->queue_start + animation->queue_count) % ANIMATION_QUEUE_SIZE] = *current_state;
+    animation->queue_count++;
+}
+
+void animation_step(Animation* animation){
+
+    // Every state still waiting adds a tick, so a backlog plays out faster
+    animation->progress += 1 + animation->queue_count;
+    if(animation->progress < ANIMATION_MOVE_TICKS){
+
+        return;
+    }
+
+    if(animation->queue_count == 0){
+
+        animation->progress = ANIMATION_MOVE_TICKS;
+        return;
+    }
+
+    animation->from = animation->to;
+    animation->to = animation->queue[animation->queue_start];
+    animation->queue_start = (animation->queue_start + 1) % ANIMATION_QUEUE_SIZE;
+    animation->queue_count--;
+    animation->progress = 0;
+}
+
+void animation_advance(Animation* animation, Uint64 elapsed){
+
+    animation->accumulator += elapsed;
+
+    // After a long stall there's no point stepping through more than a whole move
+    Uint64 longest = animation->tick_length * ANIMATION_MOVE_TICKS * (ANIMATION_QUEUE_SIZE + 1);
+    if(animation->accumulator > longest){
+
+        animation->accumulator = longest;
+    }
+
+    while(animation->accumulator >= animation->tick_length){
+
+        animation->accumulator -= animation->tick_length;
+        animation_step(animation);
+    }
+
+    if(animation_idle(animation)){
+
+        animation->accumulator = 0;
+    }
+}
+
+int animation_blend(Animation* animation){
+
+    if(animation->progress >= ANIMATION_MOVE_TICKS){
+
+        return ANIMATION_SCALE;
+    }
+
+    Uint64 elapsed = (animation->progress * animation->tick_length) + animation->accumulator;
+    Uint64 blend = (elapsed * ANIMATION_SCALE) / (ANIMATION_MOVE_TICKS * animation->tick_length);
+
+    return blend > ANIMATION_SCALE ? ANIMATION_SCALE : (int)blend;
+}
+
+void frame_clock_init(FrameClock* clock, int target_fps){
+
+    clock->frequency = SDL_GetPerformanceFrequency();
+    clock->frame_length = clock->frequency / target_fps;
+    clock->frame_start = SDL_GetPerformanceCounter();
+    clock->second_start = clock->frame_start;
+    clock->frames = 0;
+    clock->fps = 0;
+}
+
+Uint64 frame_clock_wait(FrameClock* clock){
+
+    clock->frames++;
+    Uint64 frame_end = clock->frame_start + clock->frame_length;
+    Uint64 now = SDL_GetPerformanceCounter();
+
+    // SDL_Delay can oversleep by a millisecond or so, so it stops about one short and then sleeps a millisecond at a time
+    while(now < frame_end){
+
+        Uint64 remaining_us = ((frame_end - now) * 1000000) / clock->frequency;
+        if(remaining_us <= FRAME_CLOCK_SPIN_US){
+
+            while(now < frame_end){
+
+                now = SDL_GetPerformanceCounter();
+            }
+            break;
+        }
+
+        SDL_Delay(remaining_us > 2000 ? (Uint32)(remaining_us / 1000) - 1 : 1);
+        now = SDL_GetPerformanceCounter();
+    }
+
+    if(now - clock->second_start >= clock->frequency){
+
+        clock->fps = clock->frames;
+        clock->frames = 0;
+        clock->second_start += clock->frequency;
+    }
+
+    Uint64 elapsed = now - clock->frame_start;
+    clock->frame_start = now;
+
+    return elapsed;
+}
+
+// Anything further than a square away, as after a seek, snaps straight there. Things appearing or vanishing, like eaten bread, do so halfway through.
+bool blend_position(Camera* camera, int from_x, int from_y, int to_x, int to_y, int blend, int* screen_x, int* screen_y){
+
+    if(to_x == -1){
+
+        if(from_x == -1 || blend >= ANIMATION_SCALE / 2){
+
+            return false;
+        }
+        camera_square_to_screen(camera, from_x, from_y, screen_x, screen_y);
+
+    }else if(from_x == -1 || abs(to_x - from_x) + abs(to_y - from_y) > 1){
+
+        if(from_x == -1 && blend < ANIMATION_SCALE / 2){
+
+            return false;
+        }
+        camera_square_to_screen(camera, to_x, to_y, screen_x, screen_y);
+
+    }else{
+
+        int start_x, start_y, end_x, end_y;
+        camera_square_to_screen(camera, from_x, from_y, &start_x, &start_y);
+        camera_square_to_screen(camera, to_x, to_y, &end_x, &end_y);
+        *screen_x = start_x + (((end_x - start_x) * blend) / ANIMATION_SCALE);
+        *screen_y = start_y + (((end_y - start_y) * blend) / ANIMATION_SCALE);
+    }
+
+    return camera_block_visible(camera, *screen_x, *screen_y);
+}
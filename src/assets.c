@@ -0,0 +1,515 @@
+#include "assets.h"
+#include <SDL2/SDL_image.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct AssetsFont{
+
+    int size;
+    TTF_Font* font;
+    int status;
+} AssetsFont;
+
+AssetsFont assets_fonts[ASSETS_MAX_FONTS];
+int assets_font_count = 0;
+
+// A request waiting for a worker, a font when image is NULL
+typedef struct AssetJob{
+
+    AssetImage* image;
+    int font_size;
+} AssetJob;
+
+/*
+ * Requests go in one ring and decoded images come out another, both guarded by mutex along with
+ * the font table. Every request takes a place until its image is uploaded or its font opened, which
+ * keeps both rings within ASSETS_MAX_JOBS.
+ */
+typedef struct AssetsPipeline{
+
+    SDL_mutex* mutex;
+    SDL_cond* font_done; // broadcast whenever a font has been opened or failed
+    SDL_sem* jobs_ready;
+    SDL_Thread* threads[ASSETS_PIPELINE_THREADS];
+    int thread_count;
+    bool quit;
+
+    AssetJob jobs[ASSETS_MAX_JOBS];
+    int job_first;
+    int job_count;
+    AssetImage* completed[ASSETS_MAX_JOBS];
+    int completed_first;
+    int completed_count;
+    int outstanding;
+} AssetsPipeline;
+
+AssetsPipeline assets_pipeline;
+
+// FreeType has to create and destroy faces one at a time, drawing text with a face that is already open is fine
+SDL_mutex* assets_font_mutex = NULL;
+
+bool assets_embedded_enabled = true;
+
+// Without the pipeline running there is only the one thread and nothing to lock
+void assets_lock(SDL_mutex* mutex){
+
+    if(mutex != NULL){
+
+        SDL_LockMutex(mutex);
+    }
+}
+
+void assets_unlock(SDL_mutex* mutex){
+
+    if(mutex != NULL){
+
+        SDL_UnlockMutex(mutex);
+    }
+}
+
+const EmbeddedAsset* assets_find(char* name){
+
+    if(!assets_embedded_enabled){
+
+        return NULL;
+    }
+
+    for(int i = 0; i < embedded_asset_count; i++){
+
+        if(strcmp(embedded_assets[i].name, name) == 0){
+
+            return &embedded_assets[i];
+        }
+    }
+
+    return NULL;
+}
+
+// Opens a file only if it exists, so looking for an override that isn't there doesn't leave an error behind
+SDL_RWops* assets_open_file(char* directory, char* name){
+
+    char path[256];
+    sprintf(path, "%s%s", directory, name);
+    FILE* file = fopen(path, "rb");
+    if(file == NULL){
+
+        return NULL;
+    }
+    fclose(file);
+
+    return SDL_RWFromFile(path, "rb");
+}
+
+SDL_Surface* assets_load_surface(char* name){
+
+    SDL_RWops* override = assets_open_file(ASSETS_OVERRIDE_PATH, name);
+    if(override != NULL){
+
+        SDL_Surface* surface = IMG_Load_RW(override, 1);
+        if(surface == NULL){
+
+            printf("Unable to load %s%s! SDL Error: %s\n", ASSETS_OVERRIDE_PATH, name, IMG_GetError());
+        }
+        return surface;
+    }
+
+    const EmbeddedAsset* asset = assets_find(name);
+    if(asset != NULL && asset->pixels != NULL){
+
+        SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom((void*)asset->pixels, asset->width, asset->height, 32, asset->width * sizeof(Uint32), SDL_PIXELFORMAT_ARGB8888);
+        if(surface == NULL){
+
+            printf("Unable to load %s! SDL Error: %s\n", name, SDL_GetError());
+        }
+        return surface;
+    }
+
+    SDL_RWops* file = assets_open_file(ASSETS_RES_PATH, name);
+    SDL_Surface* surface = file != NULL ? IMG_Load_RW(file, 1) : NULL;
+    if(surface == NULL){
+
+        printf("Unable to load %s! SDL Error: %s\n", name, IMG_GetError());
+    }
+
+    return surface;
+}
+
+AssetsFont* assets_find_font(int size){
+
+    for(int i = 0; i < assets_font_count; i++){
+
+        if(assets_fonts[i].size == size){
+
+            return &assets_fonts[i];
+        }
+    }
+
+    return NULL;
+}
+
+TTF_Font* assets_open_font(int size){
+
+    SDL_RWops* font_file = assets_open_file(ASSETS_OVERRIDE_PATH, ASSETS_FONT);
+    if(font_file == NULL){
+
+        const EmbeddedAsset* asset = assets_find(ASSETS_FONT);
+        font_file = asset != NULL ? SDL_RWFromConstMem(asset->bytes, asset->size) : assets_open_file(ASSETS_RES_PATH, ASSETS_FONT);
+    }
+
+    assets_lock(assets_font_mutex);
+    TTF_Font* font = font_file != NULL ? TTF_OpenFontRW(font_file, 1, size) : NULL;
+    assets_unlock(assets_font_mutex);
+    if(font == NULL){
+
+        printf("Unable to load %s at %i! %s\n", ASSETS_FONT, size, TTF_GetError());
+    }
+
+    return font;
+}
+
+TTF_Font* assets_font(int size){
+
+    assets_lock(assets_pipeline.mutex);
+    AssetsFont* entry = assets_find_font(size);
+    while(entry != NULL && entry->status == ASSET_PENDING){
+
+        SDL_CondWait(assets_pipeline.font_done, assets_pipeline.mutex);
+    }
+    assets_unlock(assets_pipeline.mutex);
+    if(entry != NULL){
+
+        return entry->font;
+    }
+
+    // Never requested, so it is opened here and now
+    TTF_Font* font = assets_open_font(size);
+    if(font == NULL){
+
+        return NULL;
+    }
+
+    assets_lock(assets_pipeline.mutex);
+    if(assets_font_count < ASSETS_MAX_FONTS){
+
+        assets_fonts[assets_font_count].size = size;
+        assets_fonts[assets_font_count].font = font;
+        assets_fonts[assets_font_count].status = ASSET_READY;
+        assets_font_count++;
+    }
+    assets_unlock(assets_pipeline.mutex);
+
+    return font;
+}
+
+TTF_Font* assets_font_ready(int size){
+
+    assets_lock(assets_pipeline.mutex);
+    AssetsFont* entry = assets_find_font(size);
+    TTF_Font* font = entry != NULL && entry->status == ASSET_READY ? entry->font : NULL;
+    assets_unlock(assets_pipeline.mutex);
+
+    return font;
+}
+
+void assets_free(){
+
+    for(int i = 0; i < assets_font_count; i++){
+
+        if(assets_fonts[i].font != NULL){
+
+            TTF_CloseFont(assets_fonts[i].font);
+        }
+    }
+    assets_font_count = 0;
+}
+
+void assets_decode_image(AssetImage* image){
+
+    SDL_Surface* surface = assets_load_surface(image->name);
+
+    // Textures are made from ARGB8888, converting here leaves the upload nothing to do but copy
+    if(surface != NULL && surface->format->format != SDL_PIXELFORMAT_ARGB8888){
+
+        SDL_Surface* converted_surface = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(surface);
+        surface = converted_surface;
+    }
+
+    memset(&image->decoded_sprite, 0, sizeof(BlitSprite));
+    if(surface != NULL && image->make_sprite){
+
+        blit_sprite_from_surface(&image->decoded_sprite, surface);
+    }
+    image->surface = surface;
+
+    assets_lock(assets_pipeline.mutex);
+    if(surface == NULL){
+
+        SDL_AtomicSet(&image->status, ASSET_FAILED);
+        assets_pipeline.outstanding--;
+
+    }else{
+
+        int slot = (assets_pipeline.completed_first + assets_pipeline.completed_count) % ASSETS_MAX_JOBS;
+        assets_pipeline.completed[slot] = image;
+        assets_pipeline.completed_count++;
+        SDL_AtomicSet(&image->status, ASSET_DECODED);
+    }
+    assets_unlock(assets_pipeline.mutex);
+}
+
+void assets_open_requested_font(int size){
+
+    TTF_Font* font = assets_open_font(size);
+
+    assets_lock(assets_pipeline.mutex);
+    AssetsFont* entry = assets_find_font(size);
+    entry->font = font;
+    entry->status = font != NULL ? ASSET_READY : ASSET_FAILED;
+    assets_pipeline.outstanding--;
+    SDL_CondBroadcast(assets_pipeline.font_done);
+    assets_unlock(assets_pipeline.mutex);
+}
+
+int assets_worker(void* data){
+
+    while(true){
+
+        SDL_SemWait(assets_pipeline.jobs_ready);
+
+        SDL_LockMutex(assets_pipeline.mutex);
+        if(assets_pipeline.quit || assets_pipeline.job_count == 0){
+
+            SDL_UnlockMutex(assets_pipeline.mutex);
+            break;
+        }
+        AssetJob job = assets_pipeline.jobs[assets_pipeline.job_first];
+        assets_pipeline.job_first = (assets_pipeline.job_first + 1) % ASSETS_MAX_JOBS;
+        assets_pipeline.job_count--;
+        SDL_UnlockMutex(assets_pipeline.mutex);
+
+        if(job.image != NULL){
+
+            assets_decode_image(job.image);
+
+        }else{
+
+            assets_open_requested_font(job.font_size);
+        }
+    }
+
+    return 0;
+}
+
+bool assets_pipeline_start(){
+
+    assets_pipeline.mutex = SDL_CreateMutex();
+    assets_pipeline.font_done = SDL_CreateCond();
+    assets_pipeline.jobs_ready = SDL_CreateSemaphore(0);
+    assets_font_mutex = SDL_CreateMutex();
+    assets_pipeline.thread_count = 0;
+    assets_pipeline.quit = false;
+    assets_pipeline.job_first = 0;
+    assets_pipeline.job_count = 0;
+    assets_pipeline.completed_first = 0;
+    assets_pipeline.completed_count = 0;
+    assets_pipeline.outstanding = 0;
+
+    for(int i = 0; i < ASSETS_PIPELINE_THREADS; i++){
+
+        SDL_Thread* thread = SDL_CreateThread(assets_worker, "assets", NULL);
+        if(thread == NULL){
+
+            printf("Unable to start asset worker! SDL Error: %s\n", SDL_GetError());
+            break;
+        }
+        assets_pipeline.threads[assets_pipeline.thread_count] = thread;
+        assets_pipeline.thread_count++;
+    }
+
+    if(assets_pipeline.thread_count == 0){
+
+        assets_pipeline_stop();
+        return false;
+    }
+
+    return true;
+}
+
+void assets_pipeline_stop(){
+
+    if(assets_pipeline.mutex == NULL){
+
+        return;
+    }
+
+    SDL_LockMutex(assets_pipeline.mutex);
+    assets_pipeline.quit = true;
+    SDL_UnlockMutex(assets_pipeline.mutex);
+    for(int i = 0; i < assets_pipeline.thread_count; i++){
+
+        SDL_SemPost(assets_pipeline.jobs_ready);
+    }
+    for(int i = 0; i < assets_pipeline.thread_count; i++){
+
+        SDL_WaitThread(assets_pipeline.threads[i], NULL);
+    }
+    assets_pipeline.thread_count = 0;
+
+    for(int i = 0; i < assets_pipeline.job_count; i++){
+
+        AssetJob* job = &assets_pipeline.jobs[(assets_pipeline.job_first + i) % ASSETS_MAX_JOBS];
+        if(job->image != NULL){
+
+            SDL_AtomicSet(&job->image->status, ASSET_FAILED);
+        }
+    }
+    for(int i = 0; i < assets_pipeline.completed_count; i++){
+
+        AssetImage* image = assets_pipeline.completed[(assets_pipeline.completed_first + i) % ASSETS_MAX_JOBS];
+        SDL_FreeSurface(image->surface);
+        image->surface = NULL;
+        blit_sprite_free(&image->decoded_sprite);
+        SDL_AtomicSet(&image->status, ASSET_FAILED);
+    }
+    for(int i = 0; i < assets_font_count; i++){
+
+        if(assets_fonts[i].status == ASSET_PENDING){
+
+            assets_fonts[i].status = ASSET_FAILED;
+        }
+    }
+    assets_pipeline.job_count = 0;
+    assets_pipeline.completed_count = 0;
+
+    SDL_DestroySemaphore(assets_pipeline.jobs_ready);
+    SDL_DestroyCond(assets_pipeline.font_done);
+    SDL_DestroyMutex(assets_pipeline.mutex);
+    SDL_DestroyMutex(assets_font_mutex);
+    assets_pipeline.mutex = NULL;
+    assets_pipeline.font_done = NULL;
+    assets_pipeline.jobs_ready = NULL;
+    assets_font_mutex = NULL;
+}
+
+// Adds a job if there's room, holding the pipeline's mutex
+bool assets_queue_job(AssetImage* image, int font_size){
+
+    if(assets_pipeline.outstanding == ASSETS_MAX_JOBS){
+
+        return false;
+    }
+
+    int slot = (assets_pipeline.job_first + assets_pipeline.job_count) % ASSETS_MAX_JOBS;
+    assets_pipeline.jobs[slot].image = image;
+    assets_pipeline.jobs[slot].font_size = font_size;
+    assets_pipeline.job_count++;
+    assets_pipeline.outstanding++;
+    SDL_SemPost(assets_pipeline.jobs_ready);
+
+    return true;
+}
+
+void assets_request_image(AssetImage* image, char* name, bool make_sprite){
+
+    image->texture = NULL;
+    image->width = 0;
+    image->height = 0;
+    memset(&image->sprite, 0, sizeof(BlitSprite));
+    memset(&image->decoded_sprite, 0, sizeof(BlitSprite));
+    image->name = name;
+    image->make_sprite = make_sprite;
+    image->surface = NULL;
+    SDL_AtomicSet(&image->status, ASSET_PENDING);
+
+    if(assets_pipeline.mutex == NULL){
+
+        // Nothing to hand it to, it is decoded now and uploaded with the next frame
+        assets_pipeline.outstanding++;
+        assets_decode_image(image);
+        return;
+    }
+
+    SDL_LockMutex(assets_pipeline.mutex);
+    bool queued = assets_queue_job(image, 0);
+    SDL_UnlockMutex(assets_pipeline.mutex);
+    if(!queued){
+
+        printf("Unable to queue %s, too many assets loading!\n", name);
+        SDL_AtomicSet(&image->status, ASSET_FAILED);
+    }
+}
+
+void assets_request_font(int size){
+
+    if(assets_pipeline.mutex == NULL){
+
+        return;
+    }
+
+    SDL_LockMutex(assets_pipeline.mutex);
+    if(assets_find_font(size) == NULL && assets_font_count < ASSETS_MAX_FONTS && assets_queue_job(NULL, size)){
+
+        assets_fonts[assets_font_count].size = size;
+        assets_fonts[assets_font_count].font = NULL;
+        assets_fonts[assets_font_count].status = ASSET_PENDING;
+        assets_font_count++;
+    }
+    SDL_UnlockMutex(assets_pipeline.mutex);
+}
+
+int assets_upload(SDL_Renderer* renderer){
+
+    int uploaded = 0;
+    while(uploaded < ASSETS_UPLOADS_PER_FRAME){
+
+        assets_lock(assets_pipeline.mutex);
+        AssetImage* image = NULL;
+        if(assets_pipeline.completed_count != 0){
+
+            image = assets_pipeline.completed[assets_pipeline.completed_first];
+            assets_pipeline.completed_first = (assets_pipeline.completed_first + 1) % ASSETS_MAX_JOBS;
+            assets_pipeline.completed_count--;
+            assets_pipeline.outstanding--;
+        }
+        assets_unlock(assets_pipeline.mutex);
+        if(image == NULL){
+
+            break;
+        }
+
+        image->texture = SDL_CreateTextureFromSurface(renderer, image->surface);
+        if(image->texture == NULL){
+
+            printf("Unable to create texture for %s! SDL Error: %s\n", image->name, SDL_GetError());
+        }
+        image->width = image->surface->w;
+        image->height = image->surface->h;
+        image->sprite = image->decoded_sprite;
+        SDL_FreeSurface(image->surface);
+        image->surface = NULL;
+        SDL_AtomicSet(&image->status, image->texture != NULL ? ASSET_READY : ASSET_FAILED);
+        uploaded++;
+    }
+
+    return uploaded;
+}
+
+int assets_outstanding(){
+
+    assets_lock(assets_pipeline.mutex);
+    int outstanding = assets_pipeline.outstanding;
+    assets_unlock(assets_pipeline.mutex);
+
+    return outstanding;
+}
+
+void assets_free_image(AssetImage* image){
+
+    if(image->texture != NULL){
+
+        SDL_DestroyTexture(image->texture);
+        image->texture = NULL;
+    }
+    blit_sprite_free(&image->sprite);
+}
@@ -0,0 +1,303 @@
+#include "blitter.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define BLITTER_X86
+    #include <immintrin.h>
+#endif
+
+// Scales a premultiplied channel pair, packed 0x00XX00YY, by inverse / 255 with rounding
+#define BLEND_SCALE_PAIR(pair, inverse) ((((pair) * (inverse)) + 0x00800080 + (((((pair) * (inverse)) + 0x00800080) >> 8) & 0x00FF00FF)) >> 8)
+
+void blend_row_scalar(Uint32* dest, Uint32* source, int count){
+
+    for(int i = 0; i < count; i++){
+
+        Uint32 pixel = source[i];
+        Uint32 alpha = pixel >> 24;
+        if(alpha == 255){
+
+            dest[i] = pixel;
+
+        }else if(alpha != 0){
+
+            Uint32 inverse = 255 - alpha;
+            Uint32 red_blue = BLEND_SCALE_PAIR(dest[i] & 0x00FF00FF, inverse) & 0x00FF00FF;
+            Uint32 alpha_green = (BLEND_SCALE_PAIR((dest[i] >> 8) & 0x00FF00FF, inverse) & 0x00FF00FF) << 8;
+            dest[i] = pixel + red_blue + alpha_green;
+        }
+    }
+}
+
+#ifdef BLITTER_X86
+
+/*
+ * Both SIMD kernels widen each pixel's channels to 16 bits, multiply the destination by 255 minus
+ * the source alpha, divide by 255 with the same rounding as the scalar code and add the source.
+ */
+__attribute__((target("sse2")))
+void blend_row_sse2(Uint32* dest, Uint32* source, int count){
+
+    __m128i zero = _mm_setzero_si128();
+    __m128i full = _mm_set1_epi16(255);
+    __m128i half = _mm_set1_epi16(128);
+
+    int i = 0;
+    for(; i + 4 <= count; i += 4){
+
+        __m128i source_pixels = _mm_loadu_si128((__m128i*)(source + i));
+        __m128i dest_pixels = _mm_loadu_si128((__m128i*)(dest + i));
+
+        __m128i source_low = _mm_unpacklo_epi8(source_pixels, zero);
+        __m128i source_high = _mm_unpackhi_epi8(source_pixels, zero);
+        __m128i inverse_low = _mm_sub_epi16(full, _mm_shufflehi_epi16(_mm_shufflelo_epi16(source_low, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)));
+        __m128i inverse_high = _mm_sub_epi16(full, _mm_shufflehi_epi16(_mm_shufflelo_epi16(source_high, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)));
+
+        __m128i low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dest_pixels, zero), inverse_low), half);
+        __m128i high = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dest_pixels, zero), inverse_high), half);
+        low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+        high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+
+        __m128i blended = _mm_packus_epi16(_mm_add_epi16(low, source_low), _mm_add_epi16(high, source_high));
+        _mm_storeu_si128((__m128i*)(dest + i), blended);
+    }
+
+    blend_row_scalar(dest + i, source + i, count - i);
+}
+
+// Same as the SSE2 kernel on eight pixels at once. The unpacks and pack work within each 128 bit half, so the order comes back out unchanged.
+__attribute__((target("avx2")))
+void blend_row_avx2(Uint32* dest, Uint32* source, int count){
+
+    __m256i zero = _mm256_setzero_si256();
+    __m256i full = _mm256_set1_epi16(255);
+    __m256i half = _mm256_set1_epi16(128);
+
+    int i = 0;
+    for(; i + 8 <= count; i += 8){
+
+        __m256i source_pixels = _mm256_loadu_si256((__m256i*)(source + i));
+        __m256i dest_pixels = _mm256_loadu_si256((__m256i*)(dest + i));
+
+        __m256i source_low = _mm256_unpacklo_epi8(source_pixels, zero);
+        __m256i source_high = _mm256_unpackhi_epi8(source_pixels, zero);
+        __m256i inverse_low = _mm256_sub_epi16(full, _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(source_low, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)));
+        __m256i inverse_high = _mm256_sub_epi16(full, _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(source_high, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)));
+
+        __m256i low = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(dest_pixels, zero), inverse_low), half);
+        __m256i high = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(dest_pixels, zero), inverse_high), half);
+        low = _mm256_srli_epi16(_mm256_add_epi16(low, _mm256_srli_epi16(low, 8)), 8);
+        high = _mm256_srli_epi16(_mm256_add_epi16(high, _mm256_srli_epi16(high, 8)), 8);
+
+        __m256i blended = _mm256_packus_epi16(_mm256_add_epi16(low, source_low), _mm256_add_epi16(high, source_high));
+        _mm256_storeu_si256((__m256i*)(dest + i), blended);
+    }
+
+    blend_row_sse2(dest + i, source + i, count - i);
+}
+
+#endif
+
+void (*blend_kernel)(Uint32* dest, Uint32* source, int count) = NULL;
+char* blend_kernel_name = "scalar";
+
+void blitter_pick_kernel(){
+
+    blend_kernel = blend_row_scalar;
+#ifdef BLITTER_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")){
+
+        blend_kernel = blend_row_avx2;
+        blend_kernel_name = "avx2";
+
+    }else if(__builtin_cpu_supports("sse2")){
+
+        blend_kernel = blend_row_sse2;
+        blend_kernel_name = "sse2";
+    }
+#endif
+}
+
+void blend_row(Uint32* dest, Uint32* source, int count){
+
+    if(blend_kernel == NULL){
+
+        blitter_pick_kernel();
+    }
+    blend_kernel(dest, source, count);
+}
+
+char* blitter_kernel_name(){
+
+    if(blend_kernel == NULL){
+
+        blitter_pick_kernel();
+    }
+
+    return blend_kernel_name;
+}
+
+bool blit_sprite_from_surface(BlitSprite* sprite, SDL_Surface* surface){
+
+    sprite->pixels = NULL;
+    sprite->scaled_size = 0;
+    sprite->scaled = NULL;
+    sprite->scaled_flipped = NULL;
+
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    if(converted == NULL){
+
+        printf("Unable to convert sprite! SDL Error: %s\n", SDL_GetError());
+        return false;
+    }
+
+    sprite->width = converted->w;
+    sprite->height = converted->h;
+    sprite->pixels = (Uint32*)malloc(sprite->width * sprite->height * sizeof(Uint32));
+    sprite->opaque = true;
+
+    SDL_LockSurface(converted);
+    for(int y = 0; y < sprite->height; y++){
+
+        Uint32* row = (Uint32*)((Uint8*)converted->pixels + (y * converted->pitch));
+        for(int x = 0; x < sprite->width; x++){
+
+            // Premultiplied once here, so blending never has to multiply the source
+            Uint32 pixel = row[x];
+            Uint32 alpha = pixel >> 24;
+            Uint32 red_blue = BLEND_SCALE_PAIR(pixel & 0x00FF00FF, alpha) & 0x00FF00FF;
+            Uint32 green = (BLEND_SCALE_PAIR((pixel >> 8) & 0x000000FF, alpha) & 0x000000FF) << 8;
+            sprite->pixels[(y * sprite->width) + x] = (alpha << 24) | red_blue | green;
+            if(alpha != 255){
+
+                sprite->opaque = false;
+            }
+        }
+    }
+    SDL_UnlockSurface(converted);
+    SDL_FreeSurface(converted);
+
+    return true;
+}
+
+void blit_sprite_free(BlitSprite* sprite){
+
+    free(sprite->pixels);
+    free(sprite->scaled);
+    free(sprite->scaled_flipped);
+    sprite->pixels = NULL;
+    sprite->scaled = NULL;
+    sprite->scaled_flipped = NULL;
+    sprite->scaled_size = 0;
+}
+
+// Nearest neighbour copies at the new size, which is all pixel art needs
+void blit_sprite_rescale(BlitSprite* sprite, int size){
+
+    sprite->scaled = (Uint32*)realloc(sprite->scaled, size * size * sizeof(Uint32));
+    sprite->scaled_flipped = (Uint32*)realloc(sprite->scaled_flipped, size * size * sizeof(Uint32));
+    sprite->scaled_size = size;
+
+    for(int y = 0; y < size; y++){
+
+        Uint32* source_row = sprite->pixels + (((y * sprite->height) / size) * sprite->width);
+        for(int x = 0; x < size; x++){
+
+            Uint32 pixel = source_row[(x * sprite->width) / size];
+            sprite->scaled[(y * size) + x] = pixel;
+            sprite->scaled_flipped[(y * size) + (size - 1 - x)] = pixel;
+        }
+    }
+}
+
+bool framebuffer_init(Framebuffer* framebuffer, SDL_Renderer* renderer, int width, int height){
+
+    framebuffer->width = width;
+    framebuffer->height = height;
+    framebuffer->pixels = (Uint32*)calloc(width * height, sizeof(Uint32));
+    framebuffer->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+    if(framebuffer->texture == NULL){
+
+        printf("Unable to create framebuffer texture! SDL Error: %s\n", SDL_GetError());
+        free(framebuffer->pixels);
+        framebuffer->pixels = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+void framebuffer_free(Framebuffer* framebuffer){
+
+    if(framebuffer->texture != NULL){
+
+        SDL_DestroyTexture(framebuffer->texture);
+    }
+    free(framebuffer->pixels);
+    framebuffer->texture = NULL;
+    framebuffer->pixels = NULL;
+}
+
+void framebuffer_fill_rect(Framebuffer* framebuffer, int x, int y, int width, int height, Uint32 color){
+
+    int left = x < 0 ? 0 : x;
+    int top = y < 0 ? 0 : y;
+    int right = x + width > framebuffer->width ? framebuffer->width : x + width;
+    int bottom = y + height > framebuffer->height ? framebuffer->height : y + height;
+
+    for(int row = top; row < bottom; row++){
+
+        Uint32* dest = framebuffer->pixels + (row * framebuffer->width);
+        for(int column = left; column < right; column++){
+
+            dest[column] = color;
+        }
+    }
+}
+
+void framebuffer_clear(Framebuffer* framebuffer, Uint32 color){
+
+    framebuffer_fill_rect(framebuffer, 0, 0, framebuffer->width, framebuffer->height, color);
+}
+
+void framebuffer_blit(Framebuffer* framebuffer, BlitSprite* sprite, int x, int y, int size, bool flipped){
+
+    if(sprite->pixels == NULL || size <= 0){
+
+        return;
+    }
+    if(sprite->scaled_size != size){
+
+        blit_sprite_rescale(sprite, size);
+    }
+    Uint32* pixels = flipped ? sprite->scaled_flipped : sprite->scaled;
+
+    int left = x < 0 ? 0 : x;
+    int top = y < 0 ? 0 : y;
+    int right = x + size > framebuffer->width ? framebuffer->width : x + size;
+    int bottom = y + size > framebuffer->height ? framebuffer->height : y + size;
+    if(left >= right || top >= bottom){
+
+        return;
+    }
+
+    for(int row = top; row < bottom; row++){
+
+        Uint32* source = pixels + ((row - y) * size) + (left - x);
+        Uint32* dest = framebuffer->pixels + (row * framebuffer->width) + left;
+        if(sprite->opaque){
+
+            memcpy(dest, source, (right - left) * sizeof(Uint32));
+
+        }else{
+
+            blend_row(dest, source, right - left);
+        }
+    }
+}
+
+void framebuffer_present(Framebuffer* framebuffer, SDL_Renderer* renderer){
+
+    SDL_UpdateTexture(framebuffer->texture, NULL, framebuffer->pixels, framebuffer->width * sizeof(Uint32));
+    SDL_RenderCopy(renderer, framebuffer->texture, NULL, NULL);
+}
@@ -0,0 +1,151 @@
+#include "camera.h"
+
+int camera_tile_sizes[CAMERA_ZOOM_LEVELS] = { 8, 12, 16, 24, 32, 48, 64 };
+
+// Rounds towards negative infinity, so squares left of or above the map still come out negative
+int floor_divide(int numerator, int denominator){
+
+    if(numerator < 0){
+
+        return -((-numerator + denominator - 1) / denominator);
+    }
+
+    return numerator / denominator;
+}
+
+void camera_init(Camera* camera, int view_width, int view_height){
+
+    camera->x = 0;
+    camera->y = 0;
+    camera->zoom = CAMERA_DEFAULT_ZOOM;
+    camera->tile_size = camera_tile_sizes[camera->zoom];
+    camera->view_width = view_width;
+    camera->view_height = view_height;
+}
+
+void camera_clamp(Camera* camera, State* current_state){
+
+    int max_x = (current_state->map_width * camera->tile_size) - camera->view_width;
+    int max_y = (current_state->map_height * camera->tile_size) - camera->view_height;
+    if(camera->x > max_x){
+
+        camera->x = max_x;
+    }
+    if(camera->y > max_y){
+
+        camera->y = max_y;
+    }
+    if(camera->x < 0){
+
+        camera->x = 0;
+    }
+    if(camera->y < 0){
+
+        camera->y = 0;
+    }
+}
+
+void camera_pan(Camera* camera, State* current_state, int delta_x, int delta_y){
+
+    camera->x += delta_x;
+    camera->y += delta_y;
+    camera_clamp(camera, current_state);
+}
+
+void camera_zoom(Camera* camera, State* current_state, int steps, int screen_x, int screen_y){
+
+    int zoom = camera->zoom + steps;
+    if(zoom < 0){
+
+        zoom = 0;
+    }
+    if(zoom >= CAMERA_ZOOM_LEVELS){
+
+        zoom = CAMERA_ZOOM_LEVELS - 1;
+    }
+
+    int old_tile_size = camera->tile_size;
+    camera->zoom = zoom;
+    camera->tile_size = camera_tile_sizes[zoom];
+
+    // Rescale the world point under the anchor, then put the anchor back over it
+    camera->x = floor_divide((camera->x + screen_x) * camera->tile_size, old_tile_size) - screen_x;
+    camera->y = floor_divide((camera->y + screen_y) * camera->tile_size, old_tile_size) - screen_y;
+    camera_clamp(camera, current_state);
+}
+
+void camera_follow(Camera* camera, State* current_state, int square_x, int square_y, int margin){
+
+    int lowest_x = ((square_x + 1 + margin) * camera->tile_size) - camera->view_width;
+    int lowest_y = ((square_y + 1 + margin) * camera->tile_size) - camera->view_height;
+    int highest_x = (square_x - margin) * camera->tile_size;
+    int highest_y = (square_y - margin) * camera->tile_size;
+
+    if(camera->x > highest_x){
+
+        camera->x = highest_x;
+    }
+    if(camera->x < lowest_x){
+
+        camera->x = lowest_x;
+    }
+    if(camera->y > highest_y){
+
+        camera->y = highest_y;
+    }
+    if(camera->y < lowest_y){
+
+        camera->y = lowest_y;
+    }
+    camera_clamp(camera, current_state);
+}
+
+void camera_screen_to_square(Camera* camera, int screen_x, int screen_y, int* square_x, int* square_y){
+
+    *square_x = floor_divide(camera->x + screen_x, camera->tile_size);
+    *square_y = floor_divide(camera->y + screen_y, camera->tile_size);
+}
+
+void camera_square_to_screen(Camera* camera, int square_x, int square_y, int* screen_x, int* screen_y){
+
+    *screen_x = (square_x * camera->tile_size) - camera->x;
+    *screen_y = (square_y * camera->tile_size) - camera->y;
+}
+
+bool camera_square_visible(Camera* camera, int square_x, int square_y){
+
+    int screen_x, screen_y;
+    camera_square_to_screen(camera, square_x, square_y, &screen_x, &screen_y);
+
+    return camera_block_visible(camera, screen_x, screen_y);
+}
+
+bool camera_block_visible(Camera* camera, int screen_x, int screen_y){
+
+    return screen_x + camera->tile_size > 0 && screen_x < camera->view_width && screen_y + camera->tile_size > 0 && screen_y < camera->view_height;
+}
+
+void camera_visible_squares(Camera* camera, State* current_state, int* left, int* top, int* right, int* bottom){
+
+    camera_screen_to_square(camera, 0, 0, left, top);
+    camera_screen_to_square(camera, camera->view_width - 1, camera->view_height - 1, right, bottom);
+    *right += 1;
+    *bottom += 1;
+
+    if(*left < 0){
+
+        *left = 0;
+    }
+    if(*top < 0){
+
+        *top = 0;
+    }
+    if(*right > current_state->map_width){
+
+        *right = current_state->map_width;
+    }
+    if(*bottom > current_state->map_height){
+
+        *bottom = current_state->map_height;
+    }
+}
@@ -0,0 +1,349 @@
+#include "export.h"
+#include "replay.h"
+#include "animation.h"
+#include <SDL2/SDL_image.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+    #include <direct.h>
+    #include <io.h>
+    #include <fcntl.h>
+#endif
+
+typedef struct ExportJob{
+
+    ExportOptions* options;
+    State* states; // what's on screen after each move, undos and restarts included
+    Camera* cameras; // where the game's camera is once it has followed each state
+    int state_count;
+    int frame_count;
+
+    bool raw;
+    Uint32** slots; // a batch of finished frames, as RGBA bytes, waiting to be written in order
+    int slot_count;
+
+    SDL_atomic_t next_frame;
+    int batch_end;
+    SDL_atomic_t failed;
+    SDL_sem* start;
+    SDL_sem* done;
+    bool quit;
+} ExportJob;
+
+typedef struct ExportWorker{
+
+    ExportJob* job;
+    SDL_Thread* thread;
+    ThumbnailSprites sprites;
+    Framebuffer framebuffer;
+} ExportWorker;
+
+void export_default_options(ExportOptions* options){
+
+    options->puzzle_filename = NULL;
+    options->moves = NULL;
+    options->move_count = 0;
+    options->output = NULL;
+    options->frames_per_move = (ANIMATION_MOVE_TICKS * EXPORT_FRAME_RATE) / ANIMATION_TICK_RATE;
+    options->hold_frames = EXPORT_FRAME_RATE / 2;
+    options->zoom = CAMERA_DEFAULT_ZOOM;
+    options->thread_count = 0;
+}
+
+// The same rules as replay_run, except every undo and restart also gets a state of its own to animate to
+bool export_play_moves(ExportJob* job, State* initial_state){
+
+    ExportOptions* options = job->options;
+    int* timeline = (int*)malloc((options->move_count + 1) * sizeof(int));
+    int timeline_length = 1;
+    timeline[0] = 0;
+    job->states[0] = *initial_state;
+    job->states[0].previous_state = NULL;
+
+    bool valid = true;
+    for(int i = 0; i < options->move_count && valid; i++){
+
+        int player_move = options->moves[i];
+        State* current_state = &job->states[timeline[timeline_length - 1]];
+        State* next_state = &job->states[i + 1];
+        if(player_move == REPLAY_RESTART){
+
+            timeline_length = 1;
+            *next_state = job->states[0];
+
+        }else if(player_move == PLAYER_MOVE_UNDO){
+
+            if(timeline_length > 1){
+
+                timeline_length--;
+            }
+            *next_state = job->states[timeline[timeline_length - 1]];
+
+        }else if(current_state->victory != 0 || player_move < PLAYER_MOVE_UP || player_move > PLAYER_MOVE_WAIT){
+
+            fprintf(stderr, "Move %i (%c) is impossible!\n", i + 1, get_move_char(player_move));
+            valid = false;
+
+        }else{
+
+            *next_state = *current_state;
+            next_state->previous_state = NULL;
+            simulate_move(next_state, current_state, player_move, NULL);
+            timeline[timeline_length] = i + 1;
+            timeline_length++;
+        }
+    }
+    free(timeline);
+
+    return valid;
+}
+
+// Which two states a frame falls between and how far along it is
+void export_frame_states(ExportJob* job, int frame, int* from, int* to, int* blend){
+
+    int frames_per_move = job->options->frames_per_move;
+    int move_frame = frame - job->options->hold_frames;
+    *blend = ANIMATION_SCALE;
+    if(move_frame < 0){
+
+        *from = 0;
+        *to = 0;
+
+    }else if(move_frame >= (job->state_count - 1) * frames_per_move){
+
+        *from = job->state_count - 1;
+        *to = job->state_count - 1;
+
+    }else{
+
+        // The last frame of each move lands exactly on the new state
+        *to = (move_frame / frames_per_move) + 1;
+        *from = *to - 1;
+        *blend = (((move_frame % frames_per_move) + 1) * ANIMATION_SCALE) / frames_per_move;
+    }
+}
+
+void export_render_frame(ExportWorker* worker, int frame){
+
+    ExportJob* job = worker->job;
+    int from, to, blend;
+    export_frame_states(job, frame, &from, &to, &blend);
+    SceneTarget target;
+    thumbnail_scene_target(&target, &worker->framebuffer, &worker->sprites);
+    render_scene(&target, &job->states[from], &job->states[to], blend, &job->cameras[to]);
+
+    if(job->raw){
+
+        // ARGB words to RGBA bytes, whatever the machine's byte order
+        Uint8* out = (Uint8*)job->slots[frame % job->slot_count];
+        for(int i = 0; i < EXPORT_WIDTH * EXPORT_HEIGHT; i++){
+
+            Uint32 pixel = worker->framebuffer.pixels[i];
+            out[(i * 4) + 0] = (pixel >> 16) & 0xFF;
+            out[(i * 4) + 1] = (pixel >> 8) & 0xFF;
+            out[(i * 4) + 2] = pixel & 0xFF;
+            out[(i * 4) + 3] = pixel >> 24;
+        }
+        return;
+    }
+
+    char path[300];
+    sprintf(path, "%s/frame_%05i.png", job->options->output, frame);
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(worker->framebuffer.pixels, EXPORT_WIDTH, EXPORT_HEIGHT, 32, EXPORT_WIDTH * sizeof(Uint32), SDL_PIXELFORMAT_ARGB8888);
+    if(surface == NULL || IMG_SavePNG(surface, path) != 0){
+
+        fprintf(stderr, "Unable to save %s! SDL Error: %s\n", path, IMG_GetError());
+        SDL_AtomicSet(&job->failed, 1);
+    }
+    SDL_FreeSurface(surface);
+}
+
+int export_thread(void* data){
+
+    ExportWorker* worker = (ExportWorker*)data;
+    ExportJob* job = worker->job;
+
+    while(true){
+
+        SDL_SemWait(job->start);
+        if(job->quit){
+
+            break;
+        }
+
+        int frame;
+        while((frame = SDL_AtomicAdd(&job->next_frame, 1)) < job->batch_end){
+
+            export_render_frame(worker, frame);
+        }
+        SDL_SemPost(job->done);
+    }
+
+    return 0;
+}
+
+bool export_video(ExportOptions* options, ExportResult* result){
+
+    Uint64 start_time = SDL_GetPerformanceCounter();
+    result->frame_count = 0;
+    result->seconds = 0;
+    result->thread_count = 0;
+
+    State* initial_state = get_from_file(options->puzzle_filename);
+    if(initial_state == NULL){
+
+        return false;
+    }
+    if(options->frames_per_move < 1){
+
+        options->frames_per_move = 1;
+    }
+    if(options->hold_frames < 0){
+
+        options->hold_frames = 0;
+    }
+
+    ExportJob job;
+    job.options = options;
+    job.state_count = options->move_count + 1;
+    job.states = (State*)malloc(job.state_count * sizeof(State));
+    bool valid = export_play_moves(&job, initial_state);
+    free(initial_state);
+    if(!valid){
+
+        free(job.states);
+        return false;
+    }
+
+    // Following each state in turn, as game_loop does, is the only part that depends on the frames before
+    job.cameras = (Camera*)malloc(job.state_count * sizeof(Camera));
+    Camera camera;
+    camera_init(&camera, EXPORT_WIDTH, EXPORT_HEIGHT);
+    camera_zoom(&camera, &job.states[0], options->zoom - CAMERA_DEFAULT_ZOOM, 0, 0);
+    for(int i = 0; i < job.state_count; i++){
+
+        camera_follow(&camera, &job.states[i], job.states[i].player_x, job.states[i].player_y, 3);
+        job.cameras[i] = camera;
+    }
+    job.frame_count = (options->hold_frames * 2) + ((job.state_count - 1) * options->frames_per_move);
+
+    job.raw = strcmp(options->output, "-") == 0;
+    if(job.raw){
+
+        #ifdef _WIN32
+            _setmode(_fileno(stdout), _O_BINARY);
+        #endif
+
+    }else{
+
+        #ifdef _WIN32
+            _mkdir(options->output);
+        #else
+            mkdir(options->output, 0755);
+        #endif
+    }
+
+    int thread_count = options->thread_count;
+    if(thread_count < 1){
+
+        thread_count = SDL_GetCPUCount();
+    }
+
+    ThumbnailSprites sprites;
+    thumbnail_sprites_load(&sprites);
+
+    job.slot_count = thread_count * EXPORT_BATCH_FRAMES;
+    job.slots = (Uint32**)calloc(job.slot_count, sizeof(Uint32*));
+    if(job.raw){
+
+        for(int i = 0; i < job.slot_count; i++){
+
+            job.slots[i] = (Uint32*)malloc(EXPORT_WIDTH * EXPORT_HEIGHT * sizeof(Uint32));
+        }
+    }
+    SDL_AtomicSet(&job.failed, 0);
+    job.start = SDL_CreateSemaphore(0);
+    job.done = SDL_CreateSemaphore(0);
+    job.quit = false;
+
+    ExportWorker* workers = (ExportWorker*)malloc(thread_count * sizeof(ExportWorker));
+    int started_count = 0;
+    for(int i = 0; i < thread_count; i++){
+
+        workers[i].job = &job;
+        thumbnail_sprites_share(&workers[i].sprites, &sprites);
+        workers[i].framebuffer.width = EXPORT_WIDTH;
+        workers[i].framebuffer.height = EXPORT_HEIGHT;
+        workers[i].framebuffer.pixels = (Uint32*)malloc(EXPORT_WIDTH * EXPORT_HEIGHT * sizeof(Uint32));
+        workers[i].framebuffer.texture = NULL;
+        workers[i].thread = SDL_CreateThread(export_thread, "export", &workers[i]);
+        if(workers[i].thread != NULL){
+
+            started_count++;
+        }
+    }
+    if(started_count == 0){
+
+        fprintf(stderr, "Unable to start export threads! SDL Error: %s\n", SDL_GetError());
+        SDL_AtomicSet(&job.failed, 1);
+    }
+
+    for(int batch_start = 0; batch_start < job.frame_count && SDL_AtomicGet(&job.failed) == 0; batch_start += job.slot_count){
+
+        job.batch_end = batch_start + job.slot_count < job.frame_count ? batch_start + job.slot_count : job.frame_count;
+        SDL_AtomicSet(&job.next_frame, batch_start);
+        for(int i = 0; i < started_count; i++){
+
+            SDL_SemPost(job.start);
+        }
+        for(int i = 0; i < started_count; i++){
+
+            SDL_SemWait(job.done);
+        }
+
+        for(int frame = batch_start; frame < job.batch_end && job.raw; frame++){
+
+            if(fwrite(job.slots[frame % job.slot_count], EXPORT_WIDTH * EXPORT_HEIGHT * 4, 1, stdout) != 1){
+
+                fprintf(stderr, "Unable to write frame %i!\n", frame);
+                SDL_AtomicSet(&job.failed, 1);
+                break;
+            }
+        }
+    }
+    if(job.raw){
+
+        fflush(stdout);
+    }
+
+    job.quit = true;
+    for(int i = 0; i < started_count; i++){
+
+        SDL_SemPost(job.start);
+    }
+    for(int i = 0; i < thread_count; i++){
+
+        if(workers[i].thread != NULL){
+
+            SDL_WaitThread(workers[i].thread, NULL);
+        }
+        thumbnail_sprites_unshare(&workers[i].sprites);
+        framebuffer_free(&workers[i].framebuffer);
+    }
+    free(workers);
+    thumbnail_sprites_free(&sprites);
+    for(int i = 0; i < job.slot_count; i++){
+
+        free(job.slots[i]);
+    }
+    free(job.slots);
+    SDL_DestroySemaphore(job.start);
+    SDL_DestroySemaphore(job.done);
+    free(job.cameras);
+    free(job.states);
+
+    result->frame_count = job.frame_count;
+    result->thread_count = started_count;
+    result->seconds = (SDL_GetPerformanceCounter() - start_time) / (double)SDL_GetPerformanceFrequency();
+
+    return SDL_AtomicGet(&job.failed) == 0;
+}
@@ -1,4 +1,5 @@
 #include "game.h"
+#include <dirent.h>
 
 State* get_empty_state(){
 
@@ -54,6 +55,11 @@ void handle_move(State* current_state, int player_move){
     *previous_state = *current_state;
     current_state->previous_state = previous_state;
 
+    simulate_move(current_state, previous_state, player_move, NULL);
+}
+
+void simulate_move(State* current_state, State* previous_state, int player_move, Pathfinder* pathfinder){
+
     int direction_array[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
 
     // Perform player action if called for
@@ -318,7 +324,7 @@ void handle_move(State* current_state, int player_move){
 
         if(current_state->goose_x[i] != -1){
 
-            goose_pathfind(current_state, i);
+            goose_pathfind_with(current_state, i, pathfinder);
             
             // Once goose has moved, check if they got any bread
             for(int j = 0; j < MAX_BREAD_COUNT; j++){
@@ -388,6 +394,15 @@ bool square_in_bounds(State* current_state, int square_x, int square_y){
     return square_x >= 0 && square_x < current_state->map_width && square_y >= 0 && square_y < current_state->map_height;
 }
 
+/*
+ * Whether a duckling slot is in use. Only -1, -1 is empty: a waddler a collision pushes off the map is left at
+ * x -1 with its row, still holding whatever it carried, and the next turn turns it around and back onto the board.
+ */
+bool duckling_exists(State* current_state, int duckling_index){
+
+    return current_state->duckling_x[duckling_index] != -1 || current_state->duckling_y[duckling_index] != -1;
+}
+
 int get_ducklist_length(State* current_state){
 
     int length = 0;
@@ -402,23 +417,327 @@ int get_ducklist_length(State* current_state){
     return length;
 }
 
-void goose_pathfind(State* current_state, int goose_index){
+/*
+ * Writes the moves that lead to distinct successors of current_state into out (at most MAX_GENERATED_MOVES)
+ * and returns how many there are. Blocked moves and waddles that can't happen only let the world advance,
+ * so they all collapse into a single PLAYER_MOVE_WAIT flagged with MOVE_WORLD_ONLY. That wait is left out
+ * when nothing in the world would move either, since it would then be a no-op like the moves pruned here.
+ * A bot that wants an explicit idle action can still pass PLAYER_MOVE_WAIT to handle_move, it just won't
+ * be offered one that leads back to the same state. The player's facing is not considered part of the state.
+ */
+int generate_moves(State* current_state, int* out){
 
-    typedef struct {
+    int move_count = 0;
+    if(current_state->victory != 0){
 
-        int direction;
-        int path_length;
-        int x;
-        int y;
-        int score;
-    } Node;
+        return 0;
+    }
 
-    int direction_vector[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+    int direction_array[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
 
-    // First let's find the goal
-    int nearest_bread = -1;
-    int nearest_bread_distance = -1;
+    for(int direction = 0; direction < 4; direction++){
+
+        int dest_x = current_state->player_x + direction_array[direction][0];
+        int dest_y = current_state->player_y + direction_array[direction][1];
+
+        // Same rule as handle_move, an occupied square is only enterable if an unlisted duckling is on it, even one pushed off the map
+        bool move_allowed = !square_occupied(current_state, dest_x, dest_y) && square_in_bounds(current_state, dest_x, dest_y);
+        for(int i = 0; i < MAX_DUCK_COUNT && !move_allowed; i++){
+
+            if(current_state->duckling_x[i] == dest_x && current_state->duckling_y[i] == dest_y && current_state->duckling_follows[i] == i){
+
+                move_allowed = true;
+            }
+        }
+
+        if(move_allowed){
+
+            out[move_count] = PLAYER_MOVE_UP + direction;
+            move_count++;
+        }
+    }
+
+    if(current_state->player_last_duckling != -1){
+
+        for(int direction = 0; direction < 4; direction++){
+
+            int dest_x = current_state->player_x + direction_array[direction][0];
+            int dest_y = current_state->player_y + direction_array[direction][1];
+            if(!square_occupied(current_state, dest_x, dest_y)){
+
+                out[move_count] = PLAYER_WADDLE_UP + direction;
+                move_count++;
+            }
+        }
+    }
+
+    // Waiting changes something as long as a duckling is waddling or off the map to be turned back, or a goose has bread to chase
+    bool world_advances = false;
+    for(int i = 0; i < MAX_DUCK_COUNT && !world_advances; i++){
+
+        if(duckling_exists(current_state, i) && current_state->duckling_follows[i] == i){
+
+            bool off_map = !square_in_bounds(current_state, current_state->duckling_x[i], current_state->duckling_y[i]) && current_state->duckling_direction[i] != -1;
+            world_advances = current_state->duckling_waddles[i] || off_map;
+        }
+    }
+    if(!world_advances && get_goose_count(current_state) != 0 && get_bread_count(current_state) != 0){
+
+        world_advances = true;
+    }
+
+    if(world_advances){
+
+        out[move_count] = PLAYER_MOVE_WAIT | MOVE_WORLD_ONLY;
+        move_count++;
+    }
+
+    return move_count;
+}
+
+/*
+ * Rewrites current_state into a canonical representative of the states that play out identically,
+ * so that states which only differ in cosmetic fields compare and hash equal.
+ *
+ * Ducklings keep their slots: the collision pass resolves a pileup in slot order, and compares a
+ * waddler's direction with its own slot when turning it around, so no two slots are interchangeable.
+ * Only empty slots are cleared, and facing is reset where it is cosmetic (player, geese and
+ * ducklings in the line). An idle duckling keeps its direction since a waddler bumping into it sends
+ * it off that way.
+ * Live bread is packed to the front in its original order because geese break distance ties by
+ * bread slot, and geese keep their slots because they move in slot order.
+ *
+ * For any move, the canonical forms of the successors of a state and of its canonical form are
+ * equal, so searches can merge states by canonical_hash without losing a line.
+ * ./game --check-canonical plays random games both ways and reports any move where the two disagree.
+ */
+void canonicalize_state(State* current_state){
+
+    State original = *current_state;
+
+    for(int i = 0; i < MAX_DUCK_COUNT; i++){
+
+        // A waddler pushed off the map by a collision is left at x -1 and comes back next turn, only -1, -1 is empty
+        if(current_state->duckling_x[i] == -1 && current_state->duckling_y[i] == -1){
+
+            current_state->duckling_follows[i] = i;
+            current_state->duckling_direction[i] = 1;
+            current_state->duckling_waddles[i] = false;
+            current_state->duckling_holds_bread[i] = false;
+
+        }else if(current_state->duckling_follows[i] != i){
+
+            current_state->duckling_direction[i] = 1;
+        }
+    }
+
+    // Pack live bread to the front, keeping its order
+    int bread_length = 0;
+    for(int i = 0; i < MAX_BREAD_COUNT; i++){
+
+        if(original.bread_x[i] != -1){
+
+            current_state->bread_x[bread_length] = original.bread_x[i];
+            current_state->bread_y[bread_length] = original.bread_y[i];
+            bread_length++;
+        }
+    }
+
+    // Eaten bread keeps its row, which one of those off the map waddlers can still pick up, so those rows follow sorted
+    for(int i = 0; i < MAX_BREAD_COUNT; i++){
+
+        if(original.bread_x[i] == -1){
+
+            int row = original.bread_y[i];
+            int j = bread_length;
+            while(j > 0 && current_state->bread_x[j - 1] == -1 && current_state->bread_y[j - 1] > row){
+
+                current_state->bread_y[j] = current_state->bread_y[j - 1];
+                j--;
+            }
+            current_state->bread_x[bread_length] = -1;
+            current_state->bread_y[j] = row;
+            bread_length++;
+        }
+    }
+
+    for(int i = 0; i < MAX_GOOSE_COUNT; i++){
+
+        current_state->goose_direction[i] = 1;
+        if(current_state->goose_x[i] == -1){
+
+            current_state->goose_y[i] = -1;
+        }
+    }
+
+    current_state->player_direction = 1;
+    current_state->previous_state = NULL;
+}
+
+uint64_t hash_mix(uint64_t hash, int value){
+
+    // FNV-1a over the four bytes of the value
+    unsigned int bytes = (unsigned int)value;
+    for(int i = 0; i < 4; i++){
+
+        hash ^= (bytes >> (i * 8)) & 0xFF;
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+// Hashes every field that play depends on, so equal states always hash equal
+uint64_t hash_state(State* current_state){
+
+    uint64_t hash = 14695981039346656037ULL;
+
+    hash = hash_mix(hash, current_state->victory);
+    hash = hash_mix(hash, current_state->required_bread);
+    hash = hash_mix(hash, current_state->map_width);
+    hash = hash_mix(hash, current_state->map_height);
+    hash = hash_mix(hash, current_state->player_x);
+    hash = hash_mix(hash, current_state->player_y);
+    hash = hash_mix(hash, current_state->player_direction);
+    hash = hash_mix(hash, current_state->player_last_duckling);
+    hash = hash_mix(hash, current_state->player_bread_count);
+
+    for(int i = 0; i < MAX_DUCK_COUNT; i++){
+
+        hash = hash_mix(hash, current_state->duckling_x[i]);
+        hash = hash_mix(hash, current_state->duckling_y[i]);
+        hash = hash_mix(hash, current_state->duckling_follows[i]);
+        hash = hash_mix(hash, current_state->duckling_direction[i]);
+        hash = hash_mix(hash, current_state->duckling_waddles[i] | (current_state->duckling_holds_bread[i] << 1));
+    }
+
+    for(int i = 0; i < MAX_BREAD_COUNT; i++){
+
+        hash = hash_mix(hash, current_state->bread_x[i]);
+        hash = hash_mix(hash, current_state->bread_y[i]);
+    }
+
+    for(int i = 0; i < MAX_GOOSE_COUNT; i++){
+
+        hash = hash_mix(hash, current_state->goose_x[i]);
+        hash = hash_mix(hash, current_state->goose_y[i]);
+        hash = hash_mix(hash, current_state->goose_direction[i]);
+    }
+
+    return hash;
+}
+
+uint64_t canonical_hash(State* current_state){
+
+    State canonical_state = *current_state;
+    canonicalize_state(&canonical_state);
+
+    return hash_state(&canonical_state);
+}
+
+// Identifies a puzzle by what is in it rather than by its file, so a renamed or reordered puzzle still matches
+uint64_t get_puzzle_hash(State* initial_state){
+
+    return canonical_hash(initial_state);
+}
+
+// Field by field comparison, ignoring the undo history
+bool states_equal(State* a, State* b){
+
+    return a->victory == b->victory && a->required_bread == b->required_bread &&
+           a->map_width == b->map_width && a->map_height == b->map_height &&
+           a->player_x == b->player_x && a->player_y == b->player_y && a->player_direction == b->player_direction &&
+           a->player_last_duckling == b->player_last_duckling && a->player_bread_count == b->player_bread_count &&
+           memcmp(a->duckling_x, b->duckling_x, sizeof(a->duckling_x)) == 0 &&
+           memcmp(a->duckling_y, b->duckling_y, sizeof(a->duckling_y)) == 0 &&
+           memcmp(a->duckling_follows, b->duckling_follows, sizeof(a->duckling_follows)) == 0 &&
+           memcmp(a->duckling_direction, b->duckling_direction, sizeof(a->duckling_direction)) == 0 &&
+           memcmp(a->duckling_waddles, b->duckling_waddles, sizeof(a->duckling_waddles)) == 0 &&
+           memcmp(a->duckling_holds_bread, b->duckling_holds_bread, sizeof(a->duckling_holds_bread)) == 0 &&
+           memcmp(a->bread_x, b->bread_x, sizeof(a->bread_x)) == 0 &&
+           memcmp(a->bread_y, b->bread_y, sizeof(a->bread_y)) == 0 &&
+           memcmp(a->goose_x, b->goose_x, sizeof(a->goose_x)) == 0 &&
+           memcmp(a->goose_y, b->goose_y, sizeof(a->goose_y)) == 0 &&
+           memcmp(a->goose_direction, b->goose_direction, sizeof(a->goose_direction)) == 0;
+}
+
+// Manhattan distance from a square to the nearest square of the rectangle spanned by two corners
+int distance_to_box(int x, int y, int corner_x1, int corner_y1, int corner_x2, int corner_y2){
 
+    int min_x = corner_x1 < corner_x2 ? corner_x1 : corner_x2;
+    int max_x = corner_x1 < corner_x2 ? corner_x2 : corner_x1;
+    int min_y = corner_y1 < corner_y2 ? corner_y1 : corner_y2;
+    int max_y = corner_y1 < corner_y2 ? corner_y2 : corner_y1;
+
+    int x_dist = x < min_x ? min_x - x : (x > max_x ? x - max_x : 0);
+    int y_dist = y < min_y ? min_y - y : (y > max_y ? y - max_y : 0);
+
+    return x_dist + y_dist;
+}
+
+/*
+ * Admissible estimate of the moves still needed to win. Every missing bread has to be collected by the player
+ * walking onto it or onto a duckling carrying it, at most two per move, and the first one can't happen before
+ * the player meets loose bread (one square a turn) or a duckling (closing at up to three squares a turn).
+ */
+int moves_to_win_lower_bound(State* current_state){
+
+    if(current_state->victory == 1){
+
+        return 0;
+    }
+
+    // Enough bread already, so the next move wins unless a goose gets some first
+    int missing_bread = current_state->required_bread - current_state->player_bread_count;
+    if(missing_bread <= 0){
+
+        return 1;
+    }
+
+    int player_x = current_state->player_x;
+    int player_y = current_state->player_y;
+    int earliest_win = -1;
+    for(int i = 0; i < MAX_BREAD_COUNT; i++){
+
+        if(current_state->bread_x[i] != -1){
+
+            int bread_dist = abs(player_x - current_state->bread_x[i]) + abs(player_y - current_state->bread_y[i]);
+            if(earliest_win == -1 || bread_dist < earliest_win){
+
+                earliest_win = bread_dist;
+            }
+        }
+    }
+    for(int i = 0; i < MAX_DUCK_COUNT; i++){
+
+        if(duckling_exists(current_state, i)){
+
+            int duckling_dist = abs(player_x - current_state->duckling_x[i]) + abs(player_y - current_state->duckling_y[i]);
+            int meeting_turn = (duckling_dist + 2) / 3;
+            if(earliest_win == -1 || meeting_turn < earliest_win){
+
+                earliest_win = meeting_turn;
+            }
+        }
+    }
+    if(earliest_win < 1){
+
+        earliest_win = 1;
+    }
+
+    if((missing_bread + 1) / 2 > earliest_win){
+
+        earliest_win = (missing_bread + 1) / 2;
+    }
+
+    return earliest_win;
+}
+
+// Same target choice as goose_pathfind: the nearest bread, ties going to the lowest slot. Returns -1 if there is no bread.
+int goose_target_bread(State* current_state, int goose_index, int* distance){
+
+    int target = -1;
+    *distance = -1;
     for(int i = 0; i < MAX_BREAD_COUNT; i++){
 
         if(current_state->bread_x[i] == -1){
@@ -427,35 +746,207 @@ void goose_pathfind(State* current_state, int goose_index){
         }
 
         int bread_dist = abs(current_state->goose_x[goose_index] - current_state->bread_x[i]) + abs(current_state->goose_y[goose_index] - current_state->bread_y[i]);
-        if(nearest_bread == -1){
+        if(target == -1 || bread_dist < *distance){
 
-            nearest_bread = i;
-            nearest_bread_distance = bread_dist;
+            target = i;
+            *distance = bread_dist;
+        }
+    }
+
+    return target;
+}
+
+// True if nothing can get in the goose's way before it reaches its target bread, see state_is_dead
+bool goose_wins_race(State* current_state, int goose_index){
+
+    int target_dist;
+    int target = goose_target_bread(current_state, goose_index, &target_dist);
+    if(target == -1){
+
+        return false;
+    }
+
+    int goose_x = current_state->goose_x[goose_index];
+    int goose_y = current_state->goose_y[goose_index];
+    int bread_x = current_state->bread_x[target];
+    int bread_y = current_state->bread_y[target];
+    bool has_ducklings = get_duckling_count(current_state) != 0;
+
+    // The player has to stay out of the box for all target_dist turns, and anything released from them moves two a turn
+    int player_dist = distance_to_box(current_state->player_x, current_state->player_y, goose_x, goose_y, bread_x, bread_y);
+    bool race_lost = player_dist > target_dist && (!has_ducklings || player_dist > 2 * target_dist);
+
+    for(int i = 0; i < MAX_DUCK_COUNT && race_lost; i++){
+
+        if(duckling_exists(current_state, i) && distance_to_box(current_state->duckling_x[i], current_state->duckling_y[i], goose_x, goose_y, bread_x, bread_y) <= 2 * target_dist){
+
+            race_lost = false;
+        }
+    }
+
+    for(int i = 0; i < MAX_GOOSE_COUNT && race_lost; i++){
+
+        if(i != goose_index && current_state->goose_x[i] != -1 && distance_to_box(current_state->goose_x[i], current_state->goose_y[i], goose_x, goose_y, bread_x, bread_y) <= target_dist){
+
+            race_lost = false;
+        }
+    }
+
+    return race_lost;
+}
+
+/*
+ * Conservative check for states that can no longer be won. Returning true means every continuation loses;
+ * returning false means nothing either way.
+ *
+ * A goose that has a clear run at its target bread eats it in exactly that many turns, because its A* path
+ * stays inside the box between it and the bread and the target can't change while it closes in. Nothing
+ * the player controls moves more than two squares a turn (the player one, a kicked duckling two), so if
+ * none of it can get into the box in time and the player can't collect the remaining bread sooner, the
+ * goose wins the race. A goose next to bread is settled exactly by trying every move.
+ */
+bool state_is_dead(State* current_state){
+
+    if(current_state->victory != 0){
+
+        return current_state->victory == -1;
+    }
+
+    // Not enough bread left in the world
+    int available_bread = current_state->player_bread_count + get_bread_count(current_state);
+    for(int i = 0; i < MAX_DUCK_COUNT; i++){
+
+        if(duckling_exists(current_state, i) && current_state->duckling_holds_bread[i]){
+
+            available_bread++;
+        }
+    }
+    if(available_bread < current_state->required_bread){
+
+        return true;
+    }
+
+    int earliest_win = moves_to_win_lower_bound(current_state);
+
+    bool goose_next_to_bread = false;
+    for(int goose = 0; goose < MAX_GOOSE_COUNT; goose++){
+
+        int target_dist;
+        if(current_state->goose_x[goose] == -1 || goose_target_bread(current_state, goose, &target_dist) == -1){
+
+            continue;
+        }
+        if(target_dist == 1){
+
+            goose_next_to_bread = true;
+        }
+        if(earliest_win >= target_dist && goose_wins_race(current_state, goose)){
+
+            return true;
+        }
+    }
+
+    // A goose is one step from bread, so see whether any move at all avoids losing this turn
+    if(goose_next_to_bread){
 
-        }else if(bread_dist < nearest_bread_distance){
+        int moves[MAX_GENERATED_MOVES];
+        int move_count = generate_moves(current_state, moves);
+        if(move_count == 0){
 
-            nearest_bread = i;
-            nearest_bread_distance = bread_dist;
+            return false;
         }
+
+        for(int i = 0; i < move_count; i++){
+
+            State next_state = *current_state;
+            State previous_state = *current_state;
+            simulate_move(&next_state, &previous_state, MOVE_CODE(moves[i]), NULL);
+            if(next_state.victory != -1){
+
+                return false;
+            }
+        }
+
+        return true;
     }
 
+    return false;
+}
+
+void pathfinder_init(Pathfinder* pathfinder){
+
+    pathfinder->frontier_capacity = 16;
+    pathfinder->frontier = (PathNode*)malloc(pathfinder->frontier_capacity * sizeof(PathNode));
+    pathfinder->explored_capacity = 16;
+    pathfinder->explored = (PathNode*)malloc(pathfinder->explored_capacity * sizeof(PathNode));
+}
+
+void pathfinder_free(Pathfinder* pathfinder){
+
+    free(pathfinder->frontier);
+    free(pathfinder->explored);
+    pathfinder->frontier = NULL;
+    pathfinder->explored = NULL;
+}
+
+void goose_pathfind(State* current_state, int goose_index){
+
+    goose_pathfind_with(current_state, goose_index, NULL);
+}
+
+void goose_pathfind_with(State* current_state, int goose_index, Pathfinder* pathfinder){
+
+    int direction_vector[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+
+    // First let's find the goal
+    int nearest_bread_distance;
+    int nearest_bread = goose_target_bread(current_state, goose_index, &nearest_bread_distance);
     if(nearest_bread == -1){
 
         // Don't chase after non-existance bread
         return;
     }
 
-    int goal_x = current_state->bread_x[nearest_bread];
-    int goal_y = current_state->bread_y[nearest_bread];
+    int direction;
+    if(goose_path_length(current_state, goose_index, current_state->bread_x[nearest_bread], current_state->bread_y[nearest_bread], pathfinder, &direction) == -1){
+
+        printf("Pathfinding failed!\n");
+        return;
+    }
 
-    int frontier_capacity = 16;
+    // Move goose one step along that path
+    if(direction != -1){
+
+        current_state->goose_x[goose_index] += direction_vector[direction][0];
+        current_state->goose_y[goose_index] += direction_vector[direction][1];
+        current_state->goose_direction[goose_index] = direction;
+    }
+}
+
+int goose_path_length(State* current_state, int goose_index, int goal_x, int goal_y, Pathfinder* pathfinder, int* first_direction){
+
+    typedef PathNode Node;
+
+    int direction_vector[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+    int path_length = -1;
+    *first_direction = -1;
+
+    // Without a caller-owned pathfinder the node buffers only live for this one search
+    Pathfinder local_pathfinder;
+    if(pathfinder == NULL){
+
+        pathfinder_init(&local_pathfinder);
+        pathfinder = &local_pathfinder;
+    }
+
+    int frontier_capacity = pathfinder->frontier_capacity;
     int frontier_size = 0;
-    Node* frontier = (Node*)malloc(frontier_capacity * sizeof(Node));
-    int explored_capacity = 16;
+    Node* frontier = pathfinder->frontier;
+    int explored_capacity = pathfinder->explored_capacity;
     int explored_size = 0;
-    Node* explored = (Node*)malloc(explored_capacity * sizeof(Node));
+    Node* explored = pathfinder->explored;
 
-    frontier[0] = (Node){ .direction = -1, .path_length = 0, .x = current_state->goose_x[goose_index], .y = current_state->goose_y[goose_index], .score = nearest_bread_distance };
+    frontier[0] = (Node){ .direction = -1, .path_length = 0, .x = current_state->goose_x[goose_index], .y = current_state->goose_y[goose_index], .score = abs(current_state->goose_x[goose_index] - goal_x) + abs(current_state->goose_y[goose_index] - goal_y) };
     frontier_size++;
 
     while(true){
@@ -463,7 +954,6 @@ void goose_pathfind(State* current_state, int goose_index){
         // Check that the frontier isn't empty
         if(frontier_size == 0){
 
-            printf("Pathfinding failed!\n");
             break;
         }
 
@@ -488,10 +978,9 @@ void goose_pathfind(State* current_state, int goose_index){
         // Check if it's the solution
         if(smallest.x == goal_x && smallest.y == goal_y){
 
-            // If it is, move goose one step along that path then exit
-            current_state->goose_x[goose_index] += direction_vector[smallest.direction][0];
-            current_state->goose_y[goose_index] += direction_vector[smallest.direction][1];
-            current_state->goose_direction[goose_index] = smallest.direction;
+            // If it is, that's the first step and length of the path
+            path_length = smallest.path_length;
+            *first_direction = smallest.direction;
             break;
         }
 
@@ -574,8 +1063,18 @@ void goose_pathfind(State* current_state, int goose_index){
         }
     }
 
-    free(frontier);
-    free(explored);
+    // Hand the (possibly grown) buffers back so they can be reused by the next search
+    pathfinder->frontier = frontier;
+    pathfinder->frontier_capacity = frontier_capacity;
+    pathfinder->explored = explored;
+    pathfinder->explored_capacity = explored_capacity;
+
+    if(pathfinder == &local_pathfinder){
+
+        pathfinder_free(&local_pathfinder);
+    }
+
+    return path_length;
 }
 
 void editor_erase_at(State* current_state, int square_x, int square_y){
@@ -608,11 +1107,16 @@ void editor_erase_at(State* current_state, int square_x, int square_y){
     }
 }
 
-void editor_save_puzzle(State* current_state, char* filename){
+bool editor_save_puzzle(State* current_state, char* filename){
 
     char filepath[256];
-    sprintf(filepath, "./puzzles/%s", filename);
-    FILE* file = fopen(filepath, "w");
+    int path_length = snprintf(filepath, sizeof(filepath), "./puzzles/%s", filename);
+    FILE* file = path_length >= 0 && path_length < (int)sizeof(filepath) ? fopen(filepath, "w") : NULL;
+    if(file == NULL){
+
+        printf("Unable to save puzzle %s!\n", filepath);
+        return false;
+    }
 
     fprintf(file, "save_version 1\n");
     fprintf(file, "map_width %i\n", current_state->map_width);
@@ -641,16 +1145,27 @@ void editor_save_puzzle(State* current_state, char* filename){
         }
     }
 
-    fclose(file);
+    if(fclose(file) != 0){
+
+        printf("Unable to save puzzle %s!\n", filepath);
+        return false;
+    }
+
+    return true;
 }
 
 State* get_from_file(char* filename){
 
-    State* loaded_state = get_empty_state();
-
     char filepath[256];
-    sprintf(filepath, "./puzzles/%s", filename);
-    FILE* file = fopen(filepath, "r");
+    int path_length = snprintf(filepath, sizeof(filepath), "./puzzles/%s", filename);
+    FILE* file = path_length >= 0 && path_length < (int)sizeof(filepath) ? fopen(filepath, "r") : NULL;
+    if(file == NULL){
+
+        printf("Unable to open puzzle %s!\n", filepath);
+        return NULL;
+    }
+
+    State* loaded_state = get_empty_state();
 
     char buffer[255];
     while(fgets(buffer, 255, file) != NULL){
@@ -750,7 +1265,7 @@ int get_duckling_count(State* current_state){
     int duckling_count = 0;
     for(int i = 0; i < MAX_DUCK_COUNT; i++){
 
-        if(current_state->duckling_x[i] != -1){
+        if(duckling_exists(current_state, i)){
 
             duckling_count++;
         }
@@ -786,3 +1301,92 @@ int get_goose_count(State* current_state){
 
     return goose_count;
 }
+
+// One letter per move for printing solutions and replays: moves in capitals, waddles in lower case
+char get_move_char(int player_move){
+
+    char move_chars[11] = { '.', 'U', 'R', 'D', 'L', 'Z', 'u', 'r', 'd', 'l', 'W' };
+    if(player_move < 0 || player_move > PLAYER_MOVE_WAIT){
+
+        return '?';
+    }
+
+    return move_chars[player_move];
+}
+
+int get_move_from_char(char move_char){
+
+    for(int i = PLAYER_MOVE_UP; i <= PLAYER_MOVE_WAIT; i++){
+
+        if(get_move_char(i) == move_char){
+
+            return i;
+        }
+    }
+
+    return NOTHING;
+}
+
+// A name with exactly one dot, which starts ".duck" at the end
+bool is_puzzle_filename(char* filename){
+
+    int name_length = strlen(filename);
+    char* dot_pointer = (char*)memchr(filename, '.', name_length);
+
+    return dot_pointer != NULL && dot_pointer - filename == name_length - 5 && strcmp(dot_pointer, ".duck") == 0;
+}
+
+char** generate_puzzle_list(int* puzzle_count){
+
+    *puzzle_count = 0;
+    DIR* dir = opendir("./puzzles/");
+    if(dir == NULL){
+
+        printf("Unable to open puzzles folder!");
+        return NULL;
+    }
+
+    // One pass, growing as it goes, so a file added while listing can't overrun the array
+    int capacity = 64;
+    char** puzzles = (char**)malloc(capacity * sizeof(char*));
+    struct dirent* ent;
+    while((ent = readdir(dir)) != NULL){
+
+        // A longer name couldn't be opened, so it isn't offered
+        if(!is_puzzle_filename(ent->d_name) || strlen(ent->d_name) > MAX_PUZZLE_FILENAME_LENGTH){
+
+            continue;
+        }
+
+        if(*puzzle_count == capacity){
+
+            capacity *= 2;
+            puzzles = (char**)realloc(puzzles, capacity * sizeof(char*));
+        }
+        puzzles[*puzzle_count] = (char*)malloc(strlen(ent->d_name) + 1);
+        strcpy(puzzles[*puzzle_count], ent->d_name);
+        (*puzzle_count)++;
+    }
+    closedir(dir);
+
+    if(*puzzle_count == 0){
+
+        free(puzzles);
+        return NULL;
+    }
+
+    return puzzles;
+}
+
+void free_puzzle_list(char** puzzles, int puzzle_count){
+
+    if(puzzles == NULL){
+
+        return;
+    }
+    for(int i = 0; i < puzzle_count; i++){
+
+        free(puzzles[i]);
+    }
+    free(puzzles);
+}
\ No newline at end of file
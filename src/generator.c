@@ -0,0 +1,322 @@
+#include "generator.h"
+#include "solutiondb.h"
+#include <SDL2/SDL.h>
+#ifdef _WIN32
+    #include <direct.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+typedef struct GeneratorJob{
+
+    GeneratorOptions* options;
+    State* empty_state;
+
+    SDL_atomic_t accepted_count;
+    SDL_atomic_t failed; // set once a puzzle couldn't be saved
+
+    SDL_mutex* mutex;
+    // Both guarded by the mutex, a few puzzles' budget is already past what an int holds
+    int64_t candidate_count;
+    int64_t max_candidates;
+    uint64_t* accepted_hashes;
+} GeneratorJob;
+
+typedef struct GeneratorWorker{
+
+    GeneratorJob* job;
+    unsigned int rng;
+    int claimed_candidates; // left of the batch this worker last took from the budget
+    GeneratorResult counts; // per thread tallies, summed once everyone is done
+} GeneratorWorker;
+
+void generator_default_options(GeneratorOptions* options){
+
+    options->puzzle_count = 100;
+    options->map_width = 12;
+    options->map_height = 8;
+    options->max_ducklings = 3;
+    options->max_bread = 4;
+    options->max_geese = 2;
+    options->min_moves = 10;
+    options->max_moves = 40;
+    options->max_nodes = 200000;
+    options->thread_count = SDL_GetCPUCount();
+    options->seed = 1;
+    options->name_prefix = "gen";
+}
+
+unsigned int generator_random(GeneratorWorker* worker){
+
+    // xorshift32, each worker has its own so no state is shared
+    worker->rng ^= worker->rng << 13;
+    worker->rng ^= worker->rng >> 17;
+    worker->rng ^= worker->rng << 5;
+
+    return worker->rng;
+}
+
+// Picks a random free square, marking it taken
+void generator_pick_square(GeneratorWorker* worker, bool* taken, int* x, int* y){
+
+    GeneratorOptions* options = worker->job->options;
+    int square;
+    do{
+
+        square = generator_random(worker) % (options->map_width * options->map_height);
+
+    }while(taken[square]);
+
+    taken[square] = true;
+    *x = square % options->map_width;
+    *y = square / options->map_width;
+}
+
+void generator_sample(GeneratorWorker* worker, bool* taken, State* candidate){
+
+    GeneratorOptions* options = worker->job->options;
+    *candidate = *worker->job->empty_state;
+    candidate->map_width = options->map_width;
+    candidate->map_height = options->map_height;
+    memset(taken, 0, options->map_width * options->map_height * sizeof(bool));
+
+    int duckling_count = generator_random(worker) % (options->max_ducklings + 1);
+    int bread_count = 1 + (generator_random(worker) % options->max_bread);
+    int goose_count = generator_random(worker) % (options->max_geese + 1);
+
+    generator_pick_square(worker, taken, &candidate->player_x, &candidate->player_y);
+    for(int i = 0; i < duckling_count; i++){
+
+        generator_pick_square(worker, taken, &candidate->duckling_x[i], &candidate->duckling_y[i]);
+    }
+    for(int i = 0; i < bread_count; i++){
+
+        generator_pick_square(worker, taken, &candidate->bread_x[i], &candidate->bread_y[i]);
+    }
+    for(int i = 0; i < goose_count; i++){
+
+        generator_pick_square(worker, taken, &candidate->goose_x[i], &candidate->goose_y[i]);
+    }
+
+    // Same as editor_save_puzzle, every bread is needed
+    candidate->required_bread = bread_count;
+}
+
+bool generator_done(void* data){
+
+    GeneratorJob* job = (GeneratorJob*)data;
+
+    return SDL_AtomicGet(&job->accepted_count) >= job->options->puzzle_count || SDL_AtomicGet(&job->failed) != 0;
+}
+
+// Returns false once the job's candidate budget is spent
+bool generator_claim_candidate(GeneratorWorker* worker){
+
+    GeneratorJob* job = worker->job;
+    if(worker->claimed_candidates == 0){
+
+        SDL_LockMutex(job->mutex);
+        int64_t remaining = job->max_candidates - job->candidate_count;
+        worker->claimed_candidates = remaining < GENERATOR_CANDIDATE_BATCH ? (int)remaining : GENERATOR_CANDIDATE_BATCH;
+        job->candidate_count += worker->claimed_candidates;
+        SDL_UnlockMutex(job->mutex);
+
+        if(worker->claimed_candidates == 0){
+
+            return false;
+        }
+    }
+
+    worker->claimed_candidates--;
+    return true;
+}
+
+// Returns false if the hash was already accepted, otherwise records it
+bool generator_claim_hash(GeneratorJob* job, uint64_t hash){
+
+    bool claimed = true;
+    SDL_LockMutex(job->mutex);
+    for(int i = 0; i < job->options->puzzle_count && job->accepted_hashes[i] != 0; i++){
+
+        if(job->accepted_hashes[i] == hash){
+
+            claimed = false;
+            break;
+        }
+    }
+    if(claimed){
+
+        for(int i = 0; i < job->options->puzzle_count; i++){
+
+            if(job->accepted_hashes[i] == 0){
+
+                job->accepted_hashes[i] = hash;
+                break;
+            }
+        }
+    }
+    SDL_UnlockMutex(job->mutex);
+
+    return claimed;
+}
+
+int generator_thread(void* data){
+
+    GeneratorWorker* worker = (GeneratorWorker*)data;
+    GeneratorJob* job = worker->job;
+    GeneratorOptions* options = job->options;
+    bool* taken = (bool*)malloc(options->map_width * options->map_height * sizeof(bool));
+
+    SolverOptions solver_options;
+    solver_default_options(&solver_options);
+    solver_options.max_depth = options->max_moves;
+    solver_options.max_nodes = options->max_nodes;
+    solver_options.table_megabytes = 4;
+    solver_options.cancelled = generator_done;
+    solver_options.cancel_data = job;
+
+    while(!generator_done(job) && generator_claim_candidate(worker)){
+
+        State candidate;
+        generator_sample(worker, taken, &candidate);
+        worker->counts.candidate_count++;
+
+        // Cheap rejections first, most random layouts are hopeless from the start
+        if(state_is_dead(&candidate)){
+
+            worker->counts.trivial_count++;
+            continue;
+        }
+        if(moves_to_win_lower_bound(&candidate) > options->max_moves){
+
+            worker->counts.unsolved_count++;
+            continue;
+        }
+
+        SolverResult solution;
+        solve_state(&candidate, &solver_options, &solution);
+        if(!solution.solved){
+
+            worker->counts.unsolved_count++;
+            continue;
+        }
+        if(solution.move_count < options->min_moves){
+
+            worker->counts.trivial_count++;
+            continue;
+        }
+
+        uint64_t hash = get_puzzle_hash(&candidate);
+        if(!generator_claim_hash(job, hash)){
+
+            worker->counts.duplicate_count++;
+            continue;
+        }
+
+        // Another thread may have filled the last spot while this one was searching
+        if(SDL_AtomicAdd(&job->accepted_count, 1) >= options->puzzle_count){
+
+            break;
+        }
+
+        char filename[128];
+        sprintf(filename, "%s_%i_%08x.duck", options->name_prefix, solution.move_count, (unsigned int)(hash & 0xFFFFFFFF));
+        if(!editor_save_puzzle(&candidate, filename)){
+
+            SDL_AtomicSet(&job->failed, 1);
+            break;
+        }
+        solution_db_store(hash, &solution);
+
+        worker->counts.accepted_count++;
+        worker->counts.move_histogram[solution.move_count]++;
+    }
+
+    free(taken);
+
+    return 0;
+}
+
+void generate_puzzles(GeneratorOptions* options, GeneratorResult* result){
+
+    Uint64 start_time = SDL_GetPerformanceCounter();
+    memset(result, 0, sizeof(GeneratorResult));
+
+    // Clamped on a copy, as solve_state does, so the caller's options come back as they were given
+    GeneratorOptions clamped_options = *options;
+    if(clamped_options.max_moves > SOLVER_MAX_DEPTH){
+
+        clamped_options.max_moves = SOLVER_MAX_DEPTH;
+    }
+    if(clamped_options.thread_count < 1){
+
+        clamped_options.thread_count = 1;
+    }
+    options = &clamped_options;
+    result->thread_count = options->thread_count;
+
+    int square_count = options->map_width * options->map_height;
+    if(options->puzzle_count < 1 || options->max_bread < 1 || square_count < 1 + options->max_ducklings + options->max_bread + options->max_geese){
+
+        printf("These options can't make any puzzles!\n");
+        return;
+    }
+
+    #ifdef _WIN32
+        _mkdir("./puzzles");
+    #else
+        mkdir("./puzzles", 0755);
+    #endif
+
+    GeneratorJob job;
+    job.options = options;
+    job.empty_state = get_empty_state();
+    SDL_AtomicSet(&job.accepted_count, 0);
+    SDL_AtomicSet(&job.failed, 0);
+    job.candidate_count = 0;
+    job.max_candidates = (int64_t)options->puzzle_count * GENERATOR_MAX_CANDIDATES_PER_PUZZLE;
+    job.mutex = SDL_CreateMutex();
+    job.accepted_hashes = (uint64_t*)calloc(options->puzzle_count, sizeof(uint64_t));
+
+    GeneratorWorker* workers = (GeneratorWorker*)calloc(options->thread_count, sizeof(GeneratorWorker));
+    SDL_Thread** threads = (SDL_Thread**)malloc(options->thread_count * sizeof(SDL_Thread*));
+    for(int i = 0; i < options->thread_count; i++){
+
+        workers[i].job = &job;
+        workers[i].rng = (options->seed * 2654435761u) ^ (i * 40503u + 1);
+        if(workers[i].rng == 0){
+
+            workers[i].rng = 1;
+        }
+    }
+    for(int i = 1; i < options->thread_count; i++){
+
+        threads[i] = SDL_CreateThread(generator_thread, "generator", &workers[i]);
+    }
+    generator_thread(&workers[0]);
+    for(int i = 1; i < options->thread_count; i++){
+
+        SDL_WaitThread(threads[i], NULL);
+    }
+
+    for(int i = 0; i < options->thread_count; i++){
+
+        result->accepted_count += workers[i].counts.accepted_count;
+        result->candidate_count += workers[i].counts.candidate_count;
+        result->trivial_count += workers[i].counts.trivial_count;
+        result->unsolved_count += workers[i].counts.unsolved_count;
+        result->duplicate_count += workers[i].counts.duplicate_count;
+        for(int j = 0; j <= SOLVER_MAX_DEPTH; j++){
+
+            result->move_histogram[j] += workers[i].counts.move_histogram[j];
+        }
+    }
+
+    free(threads);
+    free(workers);
+    free(job.accepted_hashes);
+    SDL_DestroyMutex(job.mutex);
+    free(job.empty_state);
+
+    result->seconds = (SDL_GetPerformanceCounter() - start_time) / (double)SDL_GetPerformanceFrequency();
+}
@@ -0,0 +1,255 @@
+#include "hint.h"
+#include "solutiondb.h"
+
+typedef struct HintSearch{
+
+    HintEngine* engine;
+    int generation;
+} HintSearch;
+
+int hint_worker_thread(void* data);
+HintCacheEntry* hint_cache_slot(HintEngine* engine, uint64_t hash);
+
+void hint_engine_init(HintEngine* engine, State* initial_state){
+
+    SDL_AtomicSet(&engine->generation, 0);
+    SDL_AtomicSet(&engine->quit, 0);
+    engine->request_mailbox = NULL;
+    engine->result_mailbox = NULL;
+
+    engine->cache = (HintCacheEntry*)calloc(HINT_CACHE_SIZE, sizeof(HintCacheEntry));
+    engine->status = HINT_NONE;
+    engine->move = NOTHING;
+    engine->moves_left = 0;
+    engine->requested_hash = 0;
+    engine->puzzle_hash = get_puzzle_hash(initial_state);
+
+    SolutionRecord record;
+    if(solution_db_lookup(engine->puzzle_hash, &record)){
+
+        Pathfinder pathfinder;
+        pathfinder_init(&pathfinder);
+
+        State current_state = *initial_state;
+        current_state.previous_state = NULL;
+        int path_length = record.solvable ? record.move_count : 1;
+        for(int i = 0; i < path_length; i++){
+
+            HintCacheEntry* entry = hint_cache_slot(engine, canonical_hash(&current_state));
+            entry->hash = canonical_hash(&current_state);
+            entry->move = record.solvable ? record.moves[i] : NOTHING;
+            entry->moves_left = record.solvable ? path_length - i : -1;
+
+            if(record.solvable){
+
+                State previous_state = current_state;
+                simulate_move(&current_state, &previous_state, record.moves[i], &pathfinder);
+            }
+        }
+
+        pathfinder_free(&pathfinder);
+    }
+
+    engine->wake = SDL_CreateSemaphore(0);
+    engine->worker = SDL_CreateThread(hint_worker_thread, "hint worker", engine);
+}
+
+void hint_engine_destroy(HintEngine* engine){
+
+    SDL_AtomicSet(&engine->quit, 1);
+    SDL_AtomicAdd(&engine->generation, 1);
+    SDL_SemPost(engine->wake);
+    SDL_WaitThread(engine->worker, NULL);
+    SDL_DestroySemaphore(engine->wake);
+
+    free(SDL_AtomicSetPtr(&engine->request_mailbox, NULL));
+    free(SDL_AtomicSetPtr(&engine->result_mailbox, NULL));
+    free(engine->cache);
+    engine->cache = NULL;
+}
+
+HintCacheEntry* hint_cache_slot(HintEngine* engine, uint64_t hash){
+
+    return &engine->cache[hash & (HINT_CACHE_SIZE - 1)];
+}
+
+// Sets the engine's hint from the cache, returns false on a miss
+bool hint_from_cache(HintEngine* engine, uint64_t hash){
+
+    HintCacheEntry* entry = hint_cache_slot(engine, hash);
+    if(entry->hash != hash){
+
+        return false;
+    }
+
+    engine->status = entry->move == NOTHING ? HINT_UNSOLVABLE : HINT_FOUND;
+    engine->move = entry->move;
+    engine->moves_left = entry->moves_left;
+
+    return true;
+}
+
+int hint_request(HintEngine* engine, State* current_state){
+
+    if(current_state->victory != 0){
+
+        hint_cancel(engine);
+        return engine->status;
+    }
+
+    uint64_t hash = canonical_hash(current_state);
+    if(engine->status == HINT_SEARCHING && engine->requested_hash == hash){
+
+        return engine->status;
+    }
+
+    hint_cancel(engine);
+    engine->requested_hash = hash;
+    if(hint_from_cache(engine, hash)){
+
+        return engine->status;
+    }
+
+    HintRequest* request = (HintRequest*)malloc(sizeof(HintRequest));
+    request->generation = SDL_AtomicAdd(&engine->generation, 1) + 1;
+    request->state = *current_state;
+    request->state.previous_state = NULL;
+
+    // Whatever request the worker hadn't picked up yet is stale now
+    free(SDL_AtomicSetPtr(&engine->request_mailbox, request));
+    SDL_SemPost(engine->wake);
+
+    engine->status = HINT_SEARCHING;
+    engine->move = NOTHING;
+
+    return engine->status;
+}
+
+void hint_cancel(HintEngine* engine){
+
+    if(engine->status == HINT_SEARCHING){
+
+        SDL_AtomicAdd(&engine->generation, 1);
+    }
+
+    engine->status = HINT_NONE;
+    engine->move = NOTHING;
+    engine->requested_hash = 0;
+}
+
+void hint_poll(HintEngine* engine){
+
+    HintResult* result = (HintResult*)SDL_AtomicSetPtr(&engine->result_mailbox, NULL);
+    if(result == NULL){
+
+        return;
+    }
+
+    // Even a result nobody is waiting for anymore is still right, so it always goes in the cache
+    for(int i = 0; i < result->path_length; i++){
+
+        HintCacheEntry* entry = hint_cache_slot(engine, result->path_hashes[i]);
+        entry->hash = result->path_hashes[i];
+        entry->move = result->path_moves[i];
+        entry->moves_left = result->status == HINT_FOUND ? result->path_length - i : -1;
+    }
+
+    if(engine->status == HINT_SEARCHING && result->generation == SDL_AtomicGet(&engine->generation)){
+
+        if(!hint_from_cache(engine, engine->requested_hash)){
+
+            engine->status = result->status;
+        }
+    }
+
+    free(result);
+}
+
+bool hint_search_cancelled(void* data){
+
+    HintSearch* search = (HintSearch*)data;
+
+    return SDL_AtomicGet(&search->engine->quit) != 0 || SDL_AtomicGet(&search->engine->generation) != search->generation;
+}
+
+int hint_worker_thread(void* data){
+
+    HintEngine* engine = (HintEngine*)data;
+    Pathfinder pathfinder;
+    pathfinder_init(&pathfinder);
+
+    while(true){
+
+        SDL_SemWait(engine->wake);
+        if(SDL_AtomicGet(&engine->quit) != 0){
+
+            break;
+        }
+
+        HintRequest* request = (HintRequest*)SDL_AtomicSetPtr(&engine->request_mailbox, NULL);
+        if(request == NULL){
+
+            continue;
+        }
+
+        HintSearch search = { .engine = engine, .generation = request->generation };
+        SolverOptions options;
+        solver_default_options(&options);
+        options.max_depth = SOLVER_MAX_DEPTH;
+        options.max_nodes = HINT_MAX_NODES;
+        options.table_megabytes = 16;
+        options.cancelled = hint_search_cancelled;
+        options.cancel_data = &search;
+
+        SolverResult solution;
+        solve_state(&request->state, &options, &solution);
+        if(hint_search_cancelled(&search)){
+
+            free(request);
+            continue;
+        }
+
+        if(get_puzzle_hash(&request->state) == engine->puzzle_hash){
+
+            solution_db_store(engine->puzzle_hash, &solution);
+        }
+
+        HintResult* result = (HintResult*)malloc(sizeof(HintResult));
+        result->generation = request->generation;
+        result->path_length = 0;
+
+        if(solution.solved){
+
+            // Record the move to make from every state along the way, the solution is optimal from each of them too
+            result->status = HINT_FOUND;
+            State current_state = request->state;
+            for(int i = 0; i < solution.move_count; i++){
+
+                result->path_hashes[i] = canonical_hash(&current_state);
+                result->path_moves[i] = solution.moves[i];
+
+                State previous_state = current_state;
+                simulate_move(&current_state, &previous_state, solution.moves[i], &pathfinder);
+            }
+            result->path_length = solution.move_count;
+
+        }else if(solution.exhausted){
+
+            result->status = HINT_UNSOLVABLE;
+            result->path_hashes[0] = canonical_hash(&request->state);
+            result->path_moves[0] = NOTHING;
+            result->path_length = 1;
+
+        }else{
+
+            result->status = HINT_GAVE_UP;
+        }
+        free(request);
+
+        free(SDL_AtomicSetPtr(&engine->result_mailbox, result));
+    }
+
+    pathfinder_free(&pathfinder);
+
+    return 0;
+}
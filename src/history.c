@@ -0,0 +1,184 @@
+#include "history.h"
+
+void history_add_keyframe(History* history);
+void history_thin_keyframes(History* history);
+
+void history_init(History* history, State* initial_state, int keyframe_interval, long memory_budget){
+
+    history->keyframe_interval = keyframe_interval < 1 ? 1 : keyframe_interval;
+    history->memory_budget = memory_budget;
+
+    history->keyframe_capacity = 16;
+    history->keyframe_count = 0;
+    history->keyframes = (HistoryKeyframe*)malloc(history->keyframe_capacity * sizeof(HistoryKeyframe));
+
+    history->move_capacity = 256;
+    history->move_count = 0;
+    history->packed_moves = (unsigned char*)calloc(history->move_capacity / 2, 1);
+
+    history->current = *initial_state;
+    history->current.previous_state = NULL;
+    history->position = 0;
+
+    pathfinder_init(&history->pathfinder);
+
+    history_add_keyframe(history);
+}
+
+void history_free(History* history){
+
+    free(history->keyframes);
+    free(history->packed_moves);
+    pathfinder_free(&history->pathfinder);
+    history->keyframes = NULL;
+    history->packed_moves = NULL;
+    history->keyframe_count = 0;
+    history->move_count = 0;
+}
+
+State* history_current(History* history){
+
+    return &history->current;
+}
+
+int history_get_move(History* history, int index){
+
+    unsigned char packed = history->packed_moves[index / 2];
+    if(index % 2 == 0){
+
+        return packed & 0x0F;
+    }
+
+    return packed >> 4;
+}
+
+long history_memory_usage(History* history){
+
+    return (long)history->keyframe_count * sizeof(HistoryKeyframe) + history->move_capacity / 2;
+}
+
+void history_add_keyframe(History* history){
+
+    if(history->keyframe_count == history->keyframe_capacity){
+
+        history->keyframe_capacity *= 2;
+        history->keyframes = (HistoryKeyframe*)realloc(history->keyframes, history->keyframe_capacity * sizeof(HistoryKeyframe));
+    }
+
+    history->keyframes[history->keyframe_count].move_index = history->position;
+    history->keyframes[history->keyframe_count].state = history->current;
+    history->keyframe_count++;
+
+    history_thin_keyframes(history);
+}
+
+// Drops every other keyframe from the older part of the timeline until the budget is met or nothing is left to drop
+void history_thin_keyframes(History* history){
+
+    while(history->memory_budget > 0 && history_memory_usage(history) > history->memory_budget){
+
+        int thinnable_end = history->keyframe_count - HISTORY_RECENT_KEYFRAMES;
+        if(thinnable_end <= 2){
+
+            return;
+        }
+
+        int write_index = 1;
+        for(int read_index = 1; read_index < history->keyframe_count; read_index++){
+
+            if(read_index < thinnable_end && read_index % 2 == 1){
+
+                continue;
+            }
+            history->keyframes[write_index] = history->keyframes[read_index];
+            write_index++;
+        }
+        history->keyframe_count = write_index;
+    }
+}
+
+void history_truncate(History* history){
+
+    history->move_count = history->position;
+    while(history->keyframe_count > 1 && history->keyframes[history->keyframe_count - 1].move_index > history->position){
+
+        history->keyframe_count--;
+    }
+}
+
+void history_push(History* history, int player_move){
+
+    history_truncate(history);
+
+    if(history->move_count == history->move_capacity){
+
+        history->move_capacity *= 2;
+        history->packed_moves = (unsigned char*)realloc(history->packed_moves, history->move_capacity / 2);
+    }
+
+    int byte_index = history->move_count / 2;
+    if(history->move_count % 2 == 0){
+
+        history->packed_moves[byte_index] = player_move & 0x0F;
+
+    }else{
+
+        history->packed_moves[byte_index] = (history->packed_moves[byte_index] & 0x0F) | ((player_move & 0x0F) << 4);
+    }
+    history->move_count++;
+
+    State previous_state = history->current;
+    simulate_move(&history->current, &previous_state, player_move, &history->pathfinder);
+    history->position++;
+
+    if(history->position % history->keyframe_interval == 0){
+
+        history_add_keyframe(history);
+    }
+}
+
+void history_seek(History* history, int move_index){
+
+    if(move_index < 0){
+
+        move_index = 0;
+    }
+    if(move_index > history->move_count){
+
+        move_index = history->move_count;
+    }
+    if(move_index == history->position){
+
+        return;
+    }
+
+    // Find the last keyframe at or before the target
+    int low = 0;
+    int high = history->keyframe_count - 1;
+    while(low < high){
+
+        int middle = (low + high + 1) / 2;
+        if(history->keyframes[middle].move_index <= move_index){
+
+            low = middle;
+
+        }else{
+
+            high = middle - 1;
+        }
+    }
+
+    // Stepping forward from where we already are can be cheaper than going back to the keyframe
+    if(history->position > move_index || history->position < history->keyframes[low].move_index){
+
+        history->current = history->keyframes[low].state;
+        history->position = history->keyframes[low].move_index;
+    }
+
+    while(history->position < move_index){
+
+        State previous_state = history->current;
+        simulate_move(&history->current, &previous_state, history_get_move(history, history->position), &history->pathfinder);
+        history->position++;
+    }
+}
@@ -0,0 +1,474 @@
+#include "journal.h"
+
+#define GRID_CODE(entity, slot) ((entity) * 32 + (slot))
+#define GRID_ENTITY(code) ((code) / 32)
+#define GRID_SLOT(code) ((code) % 32)
+
+void journal_init(EditorJournal* journal, State* current_state){
+
+    journal->command_capacity = 256;
+    journal->command_count = 0;
+    journal->commands = (EditCommand*)malloc(journal->command_capacity * sizeof(EditCommand));
+
+    journal->batch_capacity = 64;
+    journal->batch_count = 0;
+    journal->batch_position = 0;
+    journal->batch_starts = (int*)malloc(journal->batch_capacity * sizeof(int));
+    journal->batch_open = false;
+
+    journal->actor_grid = NULL;
+    journal->bread_grid = NULL;
+    journal_rebuild_grid(journal, current_state);
+}
+
+void journal_free(EditorJournal* journal){
+
+    free(journal->commands);
+    free(journal->batch_starts);
+    free(journal->actor_grid);
+    free(journal->bread_grid);
+    journal->commands = NULL;
+    journal->batch_starts = NULL;
+    journal->actor_grid = NULL;
+    journal->bread_grid = NULL;
+}
+
+// Points x and y at an entity slot's position, or at NULL and returns false for anything that isn't an entity or the map
+bool entity_position(State* current_state, int entity, int slot, int** x, int** y){
+
+    if(entity == EDIT_ENTITY_PLAYER){
+
+        *x = &current_state->player_x;
+        *y = &current_state->player_y;
+
+    }else if(entity == EDIT_ENTITY_DUCKLING){
+
+        *x = &current_state->duckling_x[slot];
+        *y = &current_state->duckling_y[slot];
+
+    }else if(entity == EDIT_ENTITY_BREAD){
+
+        *x = &current_state->bread_x[slot];
+        *y = &current_state->bread_y[slot];
+
+    }else if(entity == EDIT_ENTITY_GOOSE){
+
+        *x = &current_state->goose_x[slot];
+        *y = &current_state->goose_y[slot];
+
+    }else if(entity == EDIT_ENTITY_MAP){
+
+        *x = &current_state->map_width;
+        *y = &current_state->map_height;
+
+    }else{
+
+        *x = NULL;
+        *y = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+int entity_slot_count(int entity){
+
+    if(entity == EDIT_ENTITY_PLAYER){
+
+        return 1;
+
+    }else if(entity == EDIT_ENTITY_DUCKLING){
+
+        return MAX_DUCK_COUNT;
+
+    }else if(entity == EDIT_ENTITY_BREAD){
+
+        return MAX_BREAD_COUNT;
+    }
+
+    return MAX_GOOSE_COUNT;
+}
+
+void journal_rebuild_grid(EditorJournal* journal, State* current_state){
+
+    journal->grid_width = current_state->map_width;
+    journal->grid_height = current_state->map_height;
+    int cell_count = journal->grid_width * journal->grid_height;
+    journal->actor_grid = (short*)realloc(journal->actor_grid, (cell_count + 1) * sizeof(short));
+    journal->bread_grid = (short*)realloc(journal->bread_grid, (cell_count + 1) * sizeof(short));
+    for(int i = 0; i < cell_count; i++){
+
+        journal->actor_grid[i] = -1;
+        journal->bread_grid[i] = -1;
+    }
+
+    // Written lowest priority first so that where things overlap, the grid holds what editor_erase_at would find first
+    int entity_order[4] = { EDIT_ENTITY_GOOSE, EDIT_ENTITY_DUCKLING, EDIT_ENTITY_PLAYER, EDIT_ENTITY_BREAD };
+    for(int i = 0; i < 4; i++){
+
+        int entity = entity_order[i];
+        for(int slot = entity_slot_count(entity) - 1; slot >= 0; slot--){
+
+            int* x;
+            int* y;
+            entity_position(current_state, entity, slot, &x, &y);
+            if(*x == -1 || !square_in_bounds(current_state, *x, *y)){
+
+                continue;
+            }
+
+            short* grid = entity == EDIT_ENTITY_BREAD ? journal->bread_grid : journal->actor_grid;
+            grid[(*y * journal->grid_width) + *x] = GRID_CODE(entity, slot);
+        }
+    }
+}
+
+bool journal_in_bounds(EditorJournal* journal, int square_x, int square_y){
+
+    return square_x >= 0 && square_x < journal->grid_width && square_y >= 0 && square_y < journal->grid_height;
+}
+
+// Works out a single square again after something left or entered it
+void journal_refresh_cell(EditorJournal* journal, State* current_state, int square_x, int square_y){
+
+    if(!journal_in_bounds(journal, square_x, square_y)){
+
+        return;
+    }
+
+    int cell = (square_y * journal->grid_width) + square_x;
+    journal->actor_grid[cell] = -1;
+    journal->bread_grid[cell] = -1;
+
+    int entity_order[4] = { EDIT_ENTITY_GOOSE, EDIT_ENTITY_DUCKLING, EDIT_ENTITY_PLAYER, EDIT_ENTITY_BREAD };
+    for(int i = 0; i < 4; i++){
+
+        int entity = entity_order[i];
+        for(int slot = entity_slot_count(entity) - 1; slot >= 0; slot--){
+
+            int* x;
+            int* y;
+            entity_position(current_state, entity, slot, &x, &y);
+            if(*x == square_x && *y == square_y){
+
+                short* grid = entity == EDIT_ENTITY_BREAD ? journal->bread_grid : journal->actor_grid;
+                grid[cell] = GRID_CODE(entity, slot);
+            }
+        }
+    }
+}
+
+void journal_apply(EditorJournal* journal, State* current_state, EditCommand* command, bool backwards){
+
+    int* x;
+    int* y;
+    if(!entity_position(current_state, command->entity, command->slot, &x, &y)){
+
+        return;
+    }
+
+    *x = backwards ? command->from_x : command->to_x;
+    *y = backwards ? command->from_y : command->to_y;
+
+    if(command->entity == EDIT_ENTITY_MAP){
+
+        journal_rebuild_grid(journal, current_state);
+        return;
+    }
+
+    journal_refresh_cell(journal, current_state, command->from_x, command->from_y);
+    journal_refresh_cell(journal, current_state, command->to_x, command->to_y);
+}
+
+void journal_begin_batch(EditorJournal* journal){
+
+    if(journal->batch_open){
+
+        return;
+    }
+
+    // A new edit makes everything that was undone unreachable
+    if(journal->batch_position < journal->batch_count){
+
+        journal->command_count = journal->batch_starts[journal->batch_position];
+        journal->batch_count = journal->batch_position;
+    }
+
+    if(journal->batch_count == journal->batch_capacity){
+
+        journal->batch_capacity *= 2;
+        journal->batch_starts = (int*)realloc(journal->batch_starts, journal->batch_capacity * sizeof(int));
+    }
+    journal->batch_starts[journal->batch_count] = journal->command_count;
+    journal->batch_open = true;
+}
+
+void journal_end_batch(EditorJournal* journal){
+
+    if(!journal->batch_open){
+
+        return;
+    }
+    journal->batch_open = false;
+
+    // Batches where nothing actually changed aren't worth an undo step
+    if(journal->command_count == journal->batch_starts[journal->batch_count]){
+
+        return;
+    }
+    journal->batch_count++;
+    journal->batch_position = journal->batch_count;
+}
+
+int journal_batch_end(EditorJournal* journal, int batch){
+
+    return batch + 1 < journal->batch_count ? journal->batch_starts[batch + 1] : journal->command_count;
+}
+
+bool journal_undo(EditorJournal* journal, State* current_state){
+
+    journal_end_batch(journal);
+    if(journal->batch_position == 0){
+
+        return false;
+    }
+
+    journal->batch_position--;
+    int batch = journal->batch_position;
+    for(int i = journal_batch_end(journal, batch) - 1; i >= journal->batch_starts[batch]; i--){
+
+        journal_apply(journal, current_state, &journal->commands[i], true);
+    }
+
+    return true;
+}
+
+bool journal_redo(EditorJournal* journal, State* current_state){
+
+    journal_end_batch(journal);
+    if(journal->batch_position == journal->batch_count){
+
+        return false;
+    }
+
+    int batch = journal->batch_position;
+    for(int i = journal->batch_starts[batch]; i < journal_batch_end(journal, batch); i++){
+
+        journal_apply(journal, current_state, &journal->commands[i], false);
+    }
+    journal->batch_position++;
+
+    return true;
+}
+
+bool journal_occupied(EditorJournal* journal, int square_x, int square_y){
+
+    if(!journal_in_bounds(journal, square_x, square_y)){
+
+        return false;
+    }
+
+    return journal->actor_grid[(square_y * journal->grid_width) + square_x] != -1;
+}
+
+void journal_record(EditorJournal* journal, State* current_state, EditCommand command){
+
+    if(journal->command_count == journal->command_capacity){
+
+        journal->command_capacity *= 2;
+        journal->commands = (EditCommand*)realloc(journal->commands, journal->command_capacity * sizeof(EditCommand));
+    }
+    journal->commands[journal->command_count] = command;
+    journal->command_count++;
+
+    journal_apply(journal, current_state, &command, false);
+}
+
+bool journal_paint(EditorJournal* journal, State* current_state, int entity, int square_x, int square_y){
+
+    // Only pieces can be painted, the map is resized through journal_resize
+    if(entity < EDIT_ENTITY_NONE || entity > EDIT_ENTITY_GOOSE || !journal_in_bounds(journal, square_x, square_y)){
+
+        return false;
+    }
+
+    int cell = (square_y * journal->grid_width) + square_x;
+    EditCommand command = { .entity = entity, .slot = 0, .from_x = -1, .from_y = -1, .to_x = square_x, .to_y = square_y };
+
+    if(entity == EDIT_ENTITY_NONE){
+
+        // Same order as editor_erase_at: ducklings, then bread, then geese, and never the player
+        int actor = journal->actor_grid[cell];
+        int code = -1;
+        if(actor != -1 && GRID_ENTITY(actor) == EDIT_ENTITY_DUCKLING){
+
+            code = actor;
+
+        }else if(journal->bread_grid[cell] != -1){
+
+            code = journal->bread_grid[cell];
+
+        }else if(actor != -1 && GRID_ENTITY(actor) == EDIT_ENTITY_GOOSE){
+
+            code = actor;
+        }
+        if(code == -1){
+
+            return false;
+        }
+
+        command = (EditCommand){ .entity = GRID_ENTITY(code), .slot = GRID_SLOT(code), .from_x = square_x, .from_y = square_y, .to_x = -1, .to_y = -1 };
+
+    }else{
+
+        if(journal->actor_grid[cell] != -1 || (entity == EDIT_ENTITY_BREAD && journal->bread_grid[cell] != -1)){
+
+            return false;
+        }
+
+        if(entity == EDIT_ENTITY_PLAYER){
+
+            command.from_x = current_state->player_x;
+            command.from_y = current_state->player_y;
+
+        }else{
+
+            // Take the first free slot, as the placement loops always have
+            command.slot = -1;
+            for(int i = 0; i < entity_slot_count(entity); i++){
+
+                int* x;
+                int* y;
+                entity_position(current_state, entity, i, &x, &y);
+                if(*x == -1){
+
+                    command.slot = i;
+                    break;
+                }
+            }
+            if(command.slot == -1){
+
+                return false;
+            }
+        }
+    }
+
+    bool own_batch = !journal->batch_open;
+    if(own_batch){
+
+        journal_begin_batch(journal);
+    }
+    journal_record(journal, current_state, command);
+    if(own_batch){
+
+        journal_end_batch(journal);
+    }
+
+    return true;
+}
+
+int rounded_divide(int numerator, int denominator){
+
+    if(numerator < 0){
+
+        return -(((-2 * numerator) + denominator) / (2 * denominator));
+    }
+
+    return ((2 * numerator) + denominator) / (2 * denominator);
+}
+
+void journal_paint_line(EditorJournal* journal, State* current_state, int entity, int from_x, int from_y, int to_x, int to_y){
+
+    int delta_x = abs(to_x - from_x);
+    int delta_y = abs(to_y - from_y);
+    int step_count = delta_x > delta_y ? delta_x : delta_y;
+    for(int step = 1; step <= step_count; step++){
+
+        // Rounded to the nearest square, so consecutive squares always touch
+        int x = from_x + rounded_divide((to_x - from_x) * step, step_count);
+        int y = from_y + rounded_divide((to_y - from_y) * step, step_count);
+        journal_paint(journal, current_state, entity, x, y);
+    }
+}
+
+void journal_paint_rect(EditorJournal* journal, State* current_state, int entity, int x1, int y1, int x2, int y2){
+
+    int left = x1 < x2 ? x1 : x2;
+    int right = x1 < x2 ? x2 : x1;
+    int top = y1 < y2 ? y1 : y2;
+    int bottom = y1 < y2 ? y2 : y1;
+
+    bool own_batch = !journal->batch_open;
+    if(own_batch){
+
+        journal_begin_batch(journal);
+    }
+    for(int y = top; y <= bottom; y++){
+
+        for(int x = left; x <= right; x++){
+
+            journal_paint(journal, current_state, entity, x, y);
+        }
+    }
+    if(own_batch){
+
+        journal_end_batch(journal);
+    }
+}
+
+bool journal_resize(EditorJournal* journal, State* current_state, int map_width, int map_height){
+
+    map_width = map_width < 1 ? 1 : (map_width > MAX_MAP_SIZE ? MAX_MAP_SIZE : map_width);
+    map_height = map_height < 1 ? 1 : (map_height > MAX_MAP_SIZE ? MAX_MAP_SIZE : map_height);
+    if(map_width == current_state->map_width && map_height == current_state->map_height){
+
+        return false;
+    }
+
+    bool own_batch = !journal->batch_open;
+    if(own_batch){
+
+        journal_begin_batch(journal);
+    }
+
+    int player_x = current_state->player_x < map_width ? current_state->player_x : map_width - 1;
+    int player_y = current_state->player_y < map_height ? current_state->player_y : map_height - 1;
+    bool player_moves = player_x != current_state->player_x || player_y != current_state->player_y;
+
+    // Erase what falls off the map, and whatever the player is about to be pulled onto
+    int entity_order[3] = { EDIT_ENTITY_DUCKLING, EDIT_ENTITY_BREAD, EDIT_ENTITY_GOOSE };
+    for(int i = 0; i < 3; i++){
+
+        int entity = entity_order[i];
+        for(int slot = 0; slot < entity_slot_count(entity); slot++){
+
+            int* x;
+            int* y;
+            entity_position(current_state, entity, slot, &x, &y);
+            if(*x == -1){
+
+                continue;
+            }
+
+            bool outside = *x >= map_width || *y >= map_height;
+            bool under_player = player_moves && entity != EDIT_ENTITY_BREAD && *x == player_x && *y == player_y;
+            if(outside || under_player){
+
+                journal_record(journal, current_state, (EditCommand){ .entity = entity, .slot = slot, .from_x = *x, .from_y = *y, .to_x = -1, .to_y = -1 });
+            }
+        }
+    }
+
+    if(player_moves){
+
+        journal_record(journal, current_state, (EditCommand){ .entity = EDIT_ENTITY_PLAYER, .slot = 0, .from_x = current_state->player_x, .from_y = current_state->player_y, .to_x = player_x, .to_y = player_y });
+    }
+    journal_record(journal, current_state, (EditCommand){ .entity = EDIT_ENTITY_MAP, .slot = 0, .from_x = current_state->map_width, .from_y = current_state->map_height, .to_x = map_width, .to_y = map_height });
+
+    if(own_batch){
+
+        journal_end_batch(journal);
+    }
+
+    return true;
+}
@@ -2,12 +2,31 @@
     #define SDL_MAIN_HANDLED
 #endif
 #include "game.h"
+#include "tools.h"
+#include "replay.h"
+#include "history.h"
+#include "session.h"
+#include "hint.h"
+#include "solutiondb.h"
+#include "analysis.h"
+#include "journal.h"
+#include "camera.h"
+#include "minimap.h"
+#include "simulation.h"
+#include "animation.h"
+#include "blitter.h"
+#include "upscale.h"
+#include "thumbnail.h"
+#include "scene.h"
+#include "puzzlelist.h"
+#include "puzzleindex.h"
+#include "assets.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 #include <stdio.h>
 #include <stdbool.h>
-#include <dirent.h>
+#include <limits.h>
 
 #define GAMESTATE_EXIT 0
 #define GAMESTATE_MENU 1
@@ -15,13 +34,12 @@
 #define GAMESTATE_EDIT 3
 #define SCREEN_WIDTH 640
 #define SCREEN_HEIGHT 360
+#define TIMELINE_HEIGHT 8
+#define MENU_VISIBLE_ROWS 15 // puzzle rows between the top of the screen and the search line
+#define MENU_THUMBNAIL_SPREAD 4 // previews drawn ahead either side of the selection
 
-typedef struct Texture{
-
-    SDL_Texture* texture;
-    int width;
-    int height;
-} Texture;
+// Streamed in by the asset pipeline, texture and sprite stay NULL until the image has been uploaded
+typedef AssetImage Texture;
 Texture texture_duck_right;
 Texture texture_duck_up;
 Texture texture_duck_down;
@@ -34,18 +52,82 @@ Texture texture_goose_down;
 Texture texture_grass;
 Texture texture_bread;
 
+// Started with --blitter, the map is composited on the CPU rather than with a RenderCopy per sprite
+bool use_blitter = false;
+Framebuffer framebuffer;
+
+// Started with --scale, frames are drawn at SCREEN_WIDTH by SCREEN_HEIGHT and blown up by a whole factor to fill the window
+bool use_upscaler = false;
+Upscaler upscaler;
+
+/*
+ * Started with --startup-probe by --bench-assets, the SDL_GetPerformanceCounter reading it took just
+ * before starting this process. The counter is the system's monotonic clock, so the two processes'
+ * readings can be subtracted.
+ */
+Uint64 startup_probe_start = 0;
+bool startup_probe_presented = false;
+
 int menu_loop(SDL_Renderer* renderer, char* filename);
 int game_loop(SDL_Renderer* renderer, char* filename);
 int edit_loop(SDL_Renderer* renderer, char* filename);
 
-char** generate_puzzle_list(int* puzzle_count);
-Texture load_texture(SDL_Renderer* renderer, char* path);
-void render_state(SDL_Renderer* renderer, State* current_state);
+void render_state(SDL_Renderer* renderer, State* current_state, Camera* camera);
+void render_state_blended(SDL_Renderer* renderer, State* from, State* to, int blend, Camera* camera);
 void render_text(SDL_Renderer* renderer, TTF_Font* font, char* text, SDL_Color color, int x, int y);
-void render_image(SDL_Renderer* renderer, Texture* texture, int x, int y);
-void render_flipped(SDL_Renderer* renderer, Texture* texture, int x, int y);
+void render_timeline(SDL_Renderer* renderer, int position, int move_count);
+void get_hint_text(HintEngine* hint, char* text);
+void render_analysis(SDL_Renderer* renderer, TTF_Font* font, EditorAnalysis* analysis, State* current_state, Camera* camera);
+void editor_mouse_square(Camera* camera, State* current_state, int* square_x, int* square_y);
+void editor_end_stroke(EditorJournal* journal, bool* painting, bool* selecting_rect);
+void get_mouse_position(int* x, int* y);
+void render_thumbnail(SDL_Renderer* renderer, TTF_Font* font, ThumbnailBatch* thumbnails, int index);
+void render_puzzle_list(SDL_Renderer* renderer, TTF_Font* font_med, TTF_Font* font_small, PuzzleList* list, int y, int visible_rows, int selected);
+void render_puzzle_details(SDL_Renderer* renderer, TTF_Font* font, PuzzleList* list, int index);
+SDL_Texture* render_text_texture(SDL_Renderer* renderer, TTF_Font* font, char* text, SDL_Color color, int* width, int* height);
+void begin_frame(SDL_Renderer* renderer);
+void present_frame(SDL_Renderer* renderer);
+void startup_probe_frame();
+
+int main(int argc, char** argv){
+
+    // 0 with --scale alone, which fills the desktop instead of sizing the window
+    int window_scale = 0;
+    // Anything else, wherever it is, is left for run_tool
+    for(int i = 1; i < argc; i++){
+
+        if(strcmp(argv[i], "--blitter") == 0){
+
+            use_blitter = true;
+
+        }else if(strcmp(argv[i], "--scale") == 0){
+
+            use_upscaler = true;
+            if(i + 1 < argc && atoi(argv[i + 1]) > 0){
+
+                window_scale = atoi(argv[i + 1]);
+                i++;
+            }
+
+        }else if(strcmp(argv[i], "--res") == 0){
+
+            assets_embedded_enabled = false;
+
+        }else if(strcmp(argv[i], "--startup-probe") == 0 && i + 1 < argc){
 
-int main(){
+            startup_probe_start = strtoull(argv[i + 1], NULL, 10);
+            i++;
+        }
+    }
+
+    solution_db_open(SOLUTION_DB_PATH);
+
+    int tool_result = run_tool(argc, argv);
+    if(tool_result != -1){
+
+        solution_db_close();
+        return tool_result;
+    }
 
     SDL_Window* window = NULL;
     SDL_Renderer* renderer = NULL;
@@ -60,7 +142,18 @@ int main(){
 
     }else{
 
-        window = SDL_CreateWindow("Duckline", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+        if(use_upscaler && window_scale == 0){
+
+            window = SDL_CreateWindow("Duckline", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN | SDL_WINDOW_FULLSCREEN_DESKTOP);
+
+        }else if(use_upscaler){
+
+            window = SDL_CreateWindow("Duckline", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH * window_scale, SCREEN_HEIGHT * window_scale, SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
+
+        }else{
+
+            window = SDL_CreateWindow("Duckline", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+        }
         renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
 
         int img_flags = IMG_INIT_PNG;
@@ -94,20 +187,38 @@ int main(){
         return 0;
     }
 
-    texture_duck_right = load_texture(renderer, "./res/momduck_leftright.png");
-    texture_duck_up = load_texture(renderer, "./res/momduck_up.png");
-    texture_duck_down = load_texture(renderer, "./res/momduck_down.png");
-    texture_duckling_right = load_texture(renderer, "./res/babyduck_leftright.png");
-    texture_duckling_up = load_texture(renderer, "./res/babyduck_up.png");
-    texture_duckling_down = load_texture(renderer, "./res/babyduck_down.png");
-    texture_goose_right = load_texture(renderer, "./res/goose_leftright.png");
-    texture_goose_up = load_texture(renderer, "./res/goose_up.png");
-    texture_goose_down = load_texture(renderer, "./res/goose_down.png");
-    texture_grass = load_texture(renderer, "./res/grass_tile.png");
-    texture_bread = load_texture(renderer, "./res/bread.png");
+    if(use_blitter && !framebuffer_init(&framebuffer, renderer, SCREEN_WIDTH, SCREEN_HEIGHT)){
+
+        use_blitter = false;
+    }
+    if(use_upscaler && !upscaler_init(&upscaler, renderer, SCREEN_WIDTH, SCREEN_HEIGHT)){
+
+        upscaler_free(&upscaler);
+        use_upscaler = false;
+    }
+
+    // The menu's fonts first, then the sprites, all on worker threads so the menu comes up straight away
+    assets_pipeline_start();
+    assets_request_font(10);
+    assets_request_font(18);
+    assets_request_font(36);
+    assets_request_image(&texture_duck_right, "momduck_leftright.png", use_blitter);
+    assets_request_image(&texture_duck_up, "momduck_up.png", use_blitter);
+    assets_request_image(&texture_duck_down, "momduck_down.png", use_blitter);
+    assets_request_image(&texture_duckling_right, "babyduck_leftright.png", use_blitter);
+    assets_request_image(&texture_duckling_up, "babyduck_up.png", use_blitter);
+    assets_request_image(&texture_duckling_down, "babyduck_down.png", use_blitter);
+    assets_request_image(&texture_goose_right, "goose_leftright.png", use_blitter);
+    assets_request_image(&texture_goose_up, "goose_up.png", use_blitter);
+    assets_request_image(&texture_goose_down, "goose_down.png", use_blitter);
+    assets_request_image(&texture_grass, "grass_tile.png", use_blitter);
+    assets_request_image(&texture_bread, "bread.png", use_blitter);
+
+    // Only the game keeps the index, tools list the folder as they find it. It opens on its own thread, the menu reads the folder until it's ready.
+    puzzle_index_open(PUZZLE_INDEX_PATH);
 
     int gamestate = GAMESTATE_MENU;
-    char* filename = (char*)malloc(255 * sizeof(char));
+    char* filename = (char*)malloc((MAX_PUZZLE_FILENAME_LENGTH + 1) * sizeof(char));
     while(gamestate != GAMESTATE_EXIT){
 
         if(gamestate == GAMESTATE_MENU){
@@ -125,14 +236,38 @@ int main(){
     }
     free(filename);
 
+    // Let any pending session writes finish
+    session_shutdown();
+    puzzle_index_close();
+    solution_db_close();
+
+    if(use_blitter){
+
+        framebuffer_free(&framebuffer);
+    }
+    if(use_upscaler){
+
+        upscaler_free(&upscaler);
+    }
+
     // Quit SDL
-    SDL_DestroyTexture(texture_duck_right.texture);
-    SDL_DestroyTexture(texture_duck_up.texture);
-    SDL_DestroyTexture(texture_duck_down.texture);
+    assets_pipeline_stop();
+    assets_free_image(&texture_duck_right);
+    assets_free_image(&texture_duck_up);
+    assets_free_image(&texture_duck_down);
+    assets_free_image(&texture_duckling_right);
+    assets_free_image(&texture_duckling_up);
+    assets_free_image(&texture_duckling_down);
+    assets_free_image(&texture_goose_right);
+    assets_free_image(&texture_goose_up);
+    assets_free_image(&texture_goose_down);
+    assets_free_image(&texture_grass);
+    assets_free_image(&texture_bread);
 
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
 
+    assets_free();
     TTF_Quit();
     IMG_Quit();
     SDL_Quit();
@@ -142,21 +277,6 @@ int main(){
 
 int menu_loop(SDL_Renderer* renderer, char* filename){
 
-    TTF_Font* font_small = TTF_OpenFont("./res/notosans.ttf", 10);
-    TTF_Font* font_med = TTF_OpenFont("./res/notosans.ttf", 18);
-
-    if(font_small == NULL){
-
-        printf("Unable to load font_small! %s\n", TTF_GetError());
-        return GAMESTATE_EXIT;
-    }
-
-    if(font_med == NULL){
-
-        printf("Unable to load font_med! %s\n", TTF_GetError());
-        return GAMESTATE_EXIT;
-    }
-
     // Start game loop
     const unsigned long SECOND = 1000;
     const unsigned long TARGET_FPS = 60;
@@ -179,13 +299,18 @@ int menu_loop(SDL_Renderer* renderer, char* filename){
     int menu_state = 0;
     int menu_index = 0;
 
-    char** puzzle_files = NULL;
-    int puzzle_count = 0;
+    // Sorted and searchable, with only the rows on screen drawn or read from disk
+    PuzzleList puzzles;
+    bool puzzles_loaded = false;
 
     char new_puzzle_name[50];
     new_puzzle_name[0] = '\0';
     int cursor_index = 0;
 
+    // Previews of the listed puzzles, drawn on worker threads and shown as each one arrives
+    ThumbnailBatch thumbnails;
+    bool thumbnails_started = false;
+
     while(running){
 
         // Poll events
@@ -200,18 +325,23 @@ int menu_loop(SDL_Renderer* renderer, char* filename){
             }else if(e.type == SDL_KEYDOWN){
 
                 int key = e.key.keysym.sym;
-                if(key == SDLK_UP){
+                int menu_wrap_point = 1;
+                if(menu_state == 1){
 
-                    menu_index--;
-                    int menu_wrap_point = 1;
-                    if(menu_state == 1){
+                    menu_wrap_point = puzzles.match_count - 1;
 
-                        menu_wrap_point = puzzle_count - 1;
+                }else if(menu_state == 2){
 
-                    }else if(menu_state == 2){
+                    menu_wrap_point = puzzles.match_count;
+                }
+                if(menu_wrap_point < 0){
 
-                        menu_wrap_point = puzzle_count;
-                    }
+                    menu_wrap_point = 0;
+                }
+
+                if(key == SDLK_UP){
+
+                    menu_index--;
                     if(menu_index < 0){
 
                         menu_index = menu_wrap_point;
@@ -220,19 +350,37 @@ int menu_loop(SDL_Renderer* renderer, char* filename){
                 }else if(key == SDLK_DOWN){
 
                     menu_index++;
-                    int menu_wrap_point = 1;
-                    if(menu_state == 1){
+                    if(menu_index > menu_wrap_point){
 
-                        menu_wrap_point = puzzle_count - 1;
+                        menu_index = 0;
+                    }
 
-                    }else if(menu_state == 2){
+                }else if((key == SDLK_PAGEUP || key == SDLK_PAGEDOWN || key == SDLK_HOME || key == SDLK_END) && (menu_state == 1 || menu_state == 2)){
+
+                    if(key == SDLK_PAGEUP){
+
+                        menu_index -= MENU_VISIBLE_ROWS;
+
+                    }else if(key == SDLK_PAGEDOWN){
+
+                        menu_index += MENU_VISIBLE_ROWS;
 
-                        menu_wrap_point = puzzle_count;
+                    }else if(key == SDLK_HOME){
+
+                        menu_index = 0;
+
+                    }else{
+
+                        menu_index = menu_wrap_point;
                     }
-                    if(menu_index > menu_wrap_point){
+                    if(menu_index < 0){
 
                         menu_index = 0;
                     }
+                    if(menu_index > menu_wrap_point){
+
+                        menu_index = menu_wrap_point;
+                    }
 
                 }else if(key == SDLK_RETURN){
 
@@ -246,14 +394,28 @@ int menu_loop(SDL_Renderer* renderer, char* filename){
 
                             menu_state = 2;
                         }
-                        puzzle_files = generate_puzzle_list(&puzzle_count);
+                        if(puzzles_loaded){
+
+                            puzzle_list_free(&puzzles);
+                        }
+                        puzzle_list_load(&puzzles);
+                        puzzles_loaded = true;
                         menu_index = 0;
 
+                        if(thumbnails_started){
+
+                            thumbnail_batch_stop(&thumbnails);
+                        }
+                        thumbnails_started = thumbnail_batch_start(&thumbnails, puzzles.files, puzzles.count, 0);
+
                     }else if(menu_state == 1){
 
-                        strcpy(filename, puzzle_files[menu_index]);
-                        return_state = GAMESTATE_GAME;
-                        running = false;
+                        if(puzzles.match_count != 0){
+
+                            snprintf(filename, MAX_PUZZLE_FILENAME_LENGTH + 1, "%s", puzzles.files[puzzles.match_first + menu_index]);
+                            return_state = GAMESTATE_GAME;
+                            running = false;
+                        }
 
                     }else if(menu_state == 2){
 
@@ -263,7 +425,7 @@ int menu_loop(SDL_Renderer* renderer, char* filename){
 
                         }else{
 
-                            strcpy(filename, puzzle_files[menu_index - 1]);
+                            snprintf(filename, MAX_PUZZLE_FILENAME_LENGTH + 1, "%s", puzzles.files[puzzles.match_first + menu_index - 1]);
                             return_state = GAMESTATE_EDIT;
                             running = false;
                         }
@@ -272,7 +434,7 @@ int menu_loop(SDL_Renderer* renderer, char* filename){
 
                         if(cursor_index != 0){
 
-                            sprintf(filename, "%s.duck", new_puzzle_name);
+                            snprintf(filename, MAX_PUZZLE_FILENAME_LENGTH + 1, "%s.duck", new_puzzle_name);
                             menu_state = 4;
                             return_state = GAMESTATE_EDIT;
                             running = false;
@@ -289,6 +451,14 @@ int menu_loop(SDL_Renderer* renderer, char* filename){
                             new_puzzle_name[cursor_index + 1] = '\0';
                             cursor_index++;
                         }
+
+                    }else if((menu_state == 1 || menu_state == 2) && puzzles.search_length < PUZZLE_LIST_SEARCH_LENGTH){
+
+                        puzzles.search[puzzles.search_length] = key;
+                        puzzles.search_length++;
+                        puzzles.search[puzzles.search_length] = '\0';
+                        puzzle_list_search(&puzzles);
+                        menu_index = 0;
                     }
 
                 }else if(key == SDLK_BACKSPACE){
@@ -301,6 +471,13 @@ int menu_loop(SDL_Renderer* renderer, char* filename){
 
                             cursor_index = 0;
                         }
+
+                    }else if((menu_state == 1 || menu_state == 2) && puzzles.search_length > 0){
+
+                        puzzles.search_length--;
+                        puzzles.search[puzzles.search_length] = '\0';
+                        puzzle_list_search(&puzzles);
+                        menu_index = 0;
                     }
 
                 }else if(key == SDLK_TAB){
@@ -311,7 +488,34 @@ int menu_loop(SDL_Renderer* renderer, char* filename){
             }
         }
 
-        // Render
+        // A puzzle saved, added or removed while the list is up shows straight away, with the search kept
+        if(puzzle_index_poll() && puzzles_loaded){
+
+            char search[PUZZLE_LIST_SEARCH_LENGTH + 1];
+            strcpy(search, puzzles.search);
+            puzzle_list_free(&puzzles);
+            puzzle_list_load(&puzzles);
+            strcpy(puzzles.search, search);
+            puzzles.search_length = strlen(search);
+            puzzle_list_search(&puzzles);
+
+            int menu_last = menu_state == 2 ? puzzles.match_count : puzzles.match_count - 1;
+            if(menu_index > menu_last){
+
+                menu_index = menu_last < 0 ? 0 : menu_last;
+            }
+
+            if(thumbnails_started){
+
+                thumbnail_batch_stop(&thumbnails);
+            }
+            thumbnails_started = thumbnail_batch_start(&thumbnails, puzzles.files, puzzles.count, 0);
+        }
+
+        // Render, text waits for its font while the boxes work from the first frame
+        TTF_Font* font_small = assets_font_ready(10);
+        TTF_Font* font_med = assets_font_ready(18);
+        begin_frame(renderer);
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
 
@@ -335,29 +539,19 @@ int menu_loop(SDL_Renderer* renderer, char* filename){
 
         }else if(menu_state == 1){
 
-            if(puzzle_count == 0){
+            if(puzzles.count == 0){
 
                 render_text(renderer, font_med, "No puzzles found!", (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 20, 20);
 
             }else{
 
-                if(puzzle_files == NULL){
-
-                    printf("Error! Cannot render null file array!\n");
-                    return 0;
-                }
-                for(int i = 0; i < puzzle_count; i++){
-
-                    char puzzle_string[70];
-                    if(menu_index == i){
-
-                        sprintf(puzzle_string, "> %s", puzzle_files[i]);
-
-                    }else{
+                render_puzzle_list(renderer, font_med, font_small, &puzzles, 20, MENU_VISIBLE_ROWS, menu_index);
+                if(thumbnails_started && puzzles.match_count != 0){
 
-                        strncpy(puzzle_string, puzzle_files[i], 64);
-                    }
-                    render_text(renderer, font_med, puzzle_string, (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 20, 20 + (20 * i));
+                    int index = puzzles.match_first + menu_index;
+                    thumbnail_batch_request(&thumbnails, index - MENU_THUMBNAIL_SPREAD, index + MENU_THUMBNAIL_SPREAD + 1);
+                    render_puzzle_details(renderer, font_small, &puzzles, index);
+                    render_thumbnail(renderer, font_small, &thumbnails, index);
                 }
             }
 
@@ -373,20 +567,15 @@ int menu_loop(SDL_Renderer* renderer, char* filename){
                 create_puzzle_text = "New Puzzle";
             }
             render_text(renderer, font_med, create_puzzle_text, (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 20, 20);
-            if(puzzle_count != 0 && puzzle_files != NULL){
-
-                for(int i = 0; i < puzzle_count; i++){
+            if(puzzles.count != 0){
 
-                    char puzzle_string[70];
-                    if(menu_index == i + 1){
+                render_puzzle_list(renderer, font_med, font_small, &puzzles, 40, MENU_VISIBLE_ROWS - 1, menu_index - 1);
+                if(thumbnails_started && menu_index > 0){
 
-                        sprintf(puzzle_string, "> %s", puzzle_files[i]);
-
-                    }else{
-
-                        strncpy(puzzle_string, puzzle_files[i], 64);
-                    }
-                    render_text(renderer, font_med, puzzle_string, (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 20, 40 + (20 * i));
+                    int index = puzzles.match_first + menu_index - 1;
+                    thumbnail_batch_request(&thumbnails, index - MENU_THUMBNAIL_SPREAD, index + MENU_THUMBNAIL_SPREAD + 1);
+                    render_puzzle_details(renderer, font_small, &puzzles, index);
+                    render_thumbnail(renderer, font_small, &thumbnails, index);
                 }
             }
 
@@ -401,7 +590,7 @@ int menu_loop(SDL_Renderer* renderer, char* filename){
         sprintf(fps_text, "FPS: %i", fps);
         render_text(renderer, font_small, fps_text, (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 0, 0);
 
-        SDL_RenderPresent(renderer);
+        present_frame(renderer);
         frames++;
 
         current_time = SDL_GetTicks();
@@ -422,123 +611,22 @@ int menu_loop(SDL_Renderer* renderer, char* filename){
         frame_before_time = SDL_GetTicks();
     }
 
-    // Close fonts
-    TTF_CloseFont(font_small);
-    TTF_CloseFont(font_med);
-
-    return return_state;
-}
-
-char** generate_puzzle_list(int* puzzle_count){
-
-    char** puzzles = NULL;
-    *puzzle_count = 0;
-    int puzzle_index = 0;
-
-    DIR* dir = opendir("./puzzles/");
-    struct dirent* ent;
-    if(dir != NULL){
-
-        while((ent = readdir(dir)) != NULL){
-
-            char* dot_pointer = (char*)memchr(ent->d_name, '.', strlen(ent->d_name));
-            if(dot_pointer != NULL){
-
-                int dot_index = dot_pointer - ent->d_name;
-                if(dot_index == strlen(ent->d_name) - 5){
-
-                    char extension[5];
-                    memcpy(extension, &(ent->d_name[dot_index + 1]), 4);
-                    extension[4] = '\0';
-                    if(strcmp(extension, "duck") == 0){
-
-                        (*puzzle_count)++;
-                    }
-                }
-            }
-        }
-        closedir(dir);
-
-    }else{
-
-        printf("Unable to open puzzles folder!");
-        return NULL;
-    }
-
-    if(puzzle_count == 0){
-
-        return NULL;
-    }
-    puzzles = (char**)malloc((*puzzle_count) * sizeof(char*));
-
-    dir = opendir("./puzzles/");
-    if(dir != NULL){
-
-        while((ent = readdir(dir)) != NULL){
-
-            char* dot_pointer = (char*)memchr(ent->d_name, '.', strlen(ent->d_name));
-            if(dot_pointer != NULL){
-
-                int dot_index = dot_pointer - ent->d_name;
-                if(dot_index == strlen(ent->d_name) - 5){
-
-                    char extension[5];
-                    memcpy(extension, &(ent->d_name[dot_index + 1]), 4);
-                    extension[4] = '\0';
-                    if(strcmp(extension, "duck") == 0){
-
-                        puzzles[puzzle_index] = (char*)malloc(64 * sizeof(char));
-                        strncpy(puzzles[puzzle_index], ent->d_name, 64);
-                        puzzle_index++;
-                    }
-                }
-            }
-        }
-        closedir(dir);
-
-    }else{
-
-        printf("Unable to open puzzles folder!");
-        free(puzzles);
-        puzzles = NULL;
-        return NULL;
-    }
-
-    return puzzles;
-}
-
-Texture load_texture(SDL_Renderer* renderer, char* path){
-
-    Texture new_texture;
-    new_texture.texture = NULL;
-
-    SDL_Surface* loaded_surface = IMG_Load(path);
-    if(loaded_surface == NULL){
+    if(thumbnails_started){
 
-        printf("Unable to load image! SDL Error: %s\n", IMG_GetError());
-        return new_texture;
+        thumbnail_batch_stop(&thumbnails);
     }
+    if(puzzles_loaded){
 
-    new_texture.texture = SDL_CreateTextureFromSurface(renderer, loaded_surface);
-
-    if(new_texture.texture == NULL){
-
-        printf("Unable to create teture! SDL Error: %s\n", IMG_GetError());
-        return new_texture;
+        puzzle_list_free(&puzzles);
     }
 
-    new_texture.width = loaded_surface->w;
-    new_texture.height = loaded_surface->h;
-
-    SDL_FreeSurface(loaded_surface);
-
-    return new_texture;
+    return return_state;
 }
 
 int game_loop(SDL_Renderer* renderer, char* filename){
 
-    TTF_Font* font_small = TTF_OpenFont("./res/notosans.ttf", 10);
-    TTF_Font* font_large = TTF_OpenFont("./res/notosans.ttf", 36);
+    TTF_Font* font_small = assets_font(10);
+    TTF_Font* font_large = assets_font(36);
 
     if(font_small == NULL){
 
@@ -553,23 +641,63 @@ int game_loop(SDL_Renderer* renderer, char* filename){
     }
 
     // Start game loop
-    const unsigned long SECOND = 1000;
-    const unsigned long TARGET_FPS = 60;
-    const unsigned long FRAME_TIME = (unsigned long)(SECOND / (double)TARGET_FPS);
-    unsigned long second_before_time = SDL_GetTicks();
-    unsigned long frame_before_time = second_before_time;
-    unsigned long current_time;
-    // double delta_time = 0;
-    int frames = 0;
-    int fps = 0;
+    const int TARGET_FPS = 60;
+    FrameClock clock;
     bool running = true;
     int return_state;
 
-    State* current_state = get_from_file(filename);
+    State* loaded_state = get_from_file(filename);
+    if(loaded_state == NULL){
+
+        return GAMESTATE_MENU;
+    }
+    uint64_t puzzle_hash = get_puzzle_hash(loaded_state);
+
+    // Pick up where the last session on this puzzle left off
+    History history;
+    if(!session_load(&history, loaded_state, filename)){
+
+        history_init(&history, loaded_state, HISTORY_DEFAULT_KEYFRAME_INTERVAL, HISTORY_DEFAULT_MEMORY_BUDGET);
+    }
+
+    // The replay covers the resumed moves too so that it still plays from the puzzle's start
+    Replay replay;
+    replay_begin(&replay, loaded_state);
+    int resumed_move_count = history.position;
+    for(int i = 0; i < resumed_move_count; i++){
+
+        replay_record(&replay, history_get_move(&history, i));
+    }
+
+    HintEngine hint;
+    hint_engine_init(&hint, loaded_state);
+
+    free(loaded_state);
+
+    // Moves run on the simulation's worker from here on, the loop only ever reads its snapshots
+    Simulation simulation;
+    simulation_start(&simulation, &history, &replay);
+    SimulationSnapshot* snapshot = simulation_snapshot(&simulation);
+    State* current_state = &snapshot->state;
     bool awaiting_follow_input = false;
+    bool scrubbing = false;
 
+    Camera camera;
+    camera_init(&camera, SCREEN_WIDTH, SCREEN_HEIGHT);
+    Minimap minimap;
+    minimap_init(&minimap);
+    bool show_minimap = true;
+
+    // Moves slide from one square to the next rather than snapping
+    Animation animation;
+    animation_init(&animation, current_state);
+    int animated_serial = snapshot->serial;
+
+    frame_clock_init(&clock, TARGET_FPS);
     while(running){
 
+        snapshot = simulation_snapshot(&simulation);
+        current_state = &snapshot->state;
         int player_move = NOTHING;
 
         // Poll events
@@ -646,14 +774,15 @@ int game_loop(SDL_Renderer* renderer, char* filename){
 
                     player_move = PLAYER_MOVE_WAIT;
 
+                }else if(key == SDLK_h){
+
+                    hint_request(&hint, current_state);
+
                 }else if(key == SDLK_RETURN){
 
                     if(current_state->victory == -1){
 
-                        while(current_state->previous_state != NULL){
-
-                            current_state = undo_move(current_state);
-                        }
+                        simulation_send(&simulation, SIMULATION_RESTART, 0);
 
                     }else{
 
@@ -665,10 +794,70 @@ int game_loop(SDL_Renderer* renderer, char* filename){
 
                     return_state = GAMESTATE_MENU;
                     running = false;
+
+                }else if(key == SDLK_LEFTBRACKET){
+
+                    simulation_send(&simulation, SIMULATION_STEP, -1);
+
+                }else if(key == SDLK_RIGHTBRACKET){
+
+                    simulation_send(&simulation, SIMULATION_STEP, 1);
+
+                }else if(key == SDLK_HOME){
+
+                    simulation_send(&simulation, SIMULATION_SEEK, 0);
+
+                }else if(key == SDLK_END){
+
+                    // Clamped to the end of the timeline, however long it has become by then
+                    simulation_send(&simulation, SIMULATION_SEEK, INT_MAX);
+
+                }else if(key == SDLK_EQUALS || key == SDLK_KP_PLUS){
+
+                    camera_zoom(&camera, current_state, 1, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
+
+                }else if(key == SDLK_MINUS || key == SDLK_KP_MINUS){
+
+                    camera_zoom(&camera, current_state, -1, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
+
+                }else if(key == SDLK_m){
+
+                    show_minimap = !show_minimap;
                 }
+
+            }else if(e.type == SDL_MOUSEWHEEL){
+
+                int x, y;
+                get_mouse_position(&x, &y);
+                camera_zoom(&camera, current_state, e.wheel.y, x, y);
+
+            }else if(e.type == SDL_MOUSEBUTTONDOWN || (e.type == SDL_MOUSEMOTION && scrubbing)){
+
+                int x, y;
+                get_mouse_position(&x, &y);
+                if(e.type == SDL_MOUSEBUTTONDOWN){
+
+                    scrubbing = y >= SCREEN_HEIGHT - TIMELINE_HEIGHT;
+                }
+                if(scrubbing){
+
+                    simulation_send(&simulation, SIMULATION_SEEK, (x * snapshot->move_count + (SCREEN_WIDTH / 2)) / SCREEN_WIDTH);
+                }
+
+            }else if(e.type == SDL_MOUSEBUTTONUP){
+
+                scrubbing = false;
             }
         }
 
+        // The puzzle was changed on disk, so it starts again as it is now. Its saved session no longer matches and is left alone.
+        PuzzleIndexEntry entry;
+        if(puzzle_index_poll() && puzzle_index_find(filename, &entry) && entry.valid && entry.puzzle_hash != puzzle_hash){
+
+            return_state = GAMESTATE_GAME;
+            running = false;
+        }
+
         if(current_state->victory == 0){
 
             if(player_move != NOTHING){
@@ -676,31 +865,62 @@ int game_loop(SDL_Renderer* renderer, char* filename){
                 awaiting_follow_input = false;
             }
 
-            // Update
-            if(player_move == PLAYER_MOVE_UNDO){
+            // Update, the worker plays the move and publishes the result when it's done
+            if(player_move != NOTHING){
+
+                simulation_send(&simulation, SIMULATION_MOVE, player_move);
+            }
+        }
+
+        // Draw whatever the worker has finished most recently
+        snapshot = simulation_snapshot(&simulation);
+        current_state = &snapshot->state;
+        if(snapshot->serial != animated_serial){
 
-                current_state = undo_move(current_state);
+            animation_push(&animation, current_state);
+            animated_serial = snapshot->serial;
+        }
 
-            }else if(player_move != NOTHING){
+        // A hint only stands for the state it was asked about
+        hint_poll(&hint);
+        if(hint.status != HINT_NONE && (current_state->victory != 0 || canonical_hash(current_state) != hint.requested_hash)){
 
-                handle_move(current_state, player_move);
-            }
+            hint_cancel(&hint);
         }
 
+        // Keep the player a few squares clear of the edge of the view
+        camera_follow(&camera, current_state, animation.to.player_x, animation.to.player_y, 3);
+
         // Render
+        begin_frame(renderer);
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
 
-        render_state(renderer, current_state);
+        render_state_blended(renderer, &animation.from, &animation.to, animation_blend(&animation), &camera);
+
+        minimap_update(&minimap, renderer, current_state);
+        if(show_minimap){
+
+            minimap_render(&minimap, renderer, &camera);
+        }
 
         char fps_text[10];
-        sprintf(fps_text, "FPS: %i", fps);
+        sprintf(fps_text, "FPS: %i", clock.fps);
         render_text(renderer, font_small, fps_text, (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 0, 0);
 
         char bread_text[20];
         sprintf(bread_text, "Bread: %i / %i", current_state->player_bread_count, current_state->required_bread);
         render_text(renderer, font_small, bread_text, (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 0, 10);
 
+        if(hint.status != HINT_NONE){
+
+            char hint_text[64];
+            get_hint_text(&hint, hint_text);
+            render_text(renderer, font_small, hint_text, (SDL_Color){ .r = 255, .g = 255, .b = 0, .a = 255 }, 0, 20);
+        }
+
+        render_timeline(renderer, snapshot->position, snapshot->move_count);
+
         if(current_state->victory == 1){
 
             char victory_text[10] = "Success!";
@@ -712,132 +932,121 @@ int game_loop(SDL_Renderer* renderer, char* filename){
             render_text(renderer, font_large, failure_text, (SDL_Color){ .r = 255, .g = 0, .b = 0, .a = 255 }, -1, -1);
         }
 
-        SDL_RenderPresent(renderer);
-        frames++;
+        present_frame(renderer);
 
-        current_time = SDL_GetTicks();
+        animation_advance(&animation, frame_clock_wait(&clock));
+    }
 
-        if(current_time - second_before_time >= SECOND){
+    // Any moves still queued are played before the worker stops
+    simulation_stop(&simulation);
+    current_state = history_current(&history);
 
-            fps = frames;
-            frames = 0;
-            second_before_time += SECOND;
-        }
+    // Keep a replay of the session
+    replay.victory = current_state->victory;
+    if(replay.move_count > resumed_move_count){
 
-        // delta_time = (current_time - frame_before_time) / (double)FRAME_TIME;
+        replay_save_session(&replay, filename);
+    }
+    replay_free(&replay);
 
-        if(current_time - frame_before_time < FRAME_TIME){
+    // A won or lost puzzle starts fresh next time, as does one left without a move, anything else is resumed
+    if(current_state->victory != 0 || history.move_count == 0){
 
-            unsigned long delay_time = FRAME_TIME - (current_time - frame_before_time);
-            SDL_Delay(delay_time);
-        }
+        session_discard_async(filename);
 
-        frame_before_time = SDL_GetTicks();
+    }else{
+
+        session_save_async(&history, filename);
     }
 
     // Cleanup memory
-    while(current_state->previous_state != NULL){
-
-        current_state = undo_move(current_state);
-    }
-    free(current_state);
+    minimap_destroy(&minimap);
+    hint_engine_destroy(&hint);
+    history_free(&history);
     current_state = NULL;
 
-    // Close fonts
-    TTF_CloseFont(font_small);
-    TTF_CloseFont(font_large);
-
     return return_state;
 }
 
-void render_state(SDL_Renderer* renderer, State* current_state){
-
-    for(int i = 0; i < current_state->map_width; i++){
-
-        for(int j = 0; j < current_state->map_height; j++){
-
-            render_image(renderer, &texture_grass, i * TILE_WIDTH, j * TILE_HEIGHT);
-        }
-    }
-
-    // Render player
-    if(current_state->player_direction == 0){
-
-        render_image(renderer, &texture_duck_up, current_state->player_x * TILE_WIDTH, current_state->player_y * TILE_HEIGHT);
-
-    }else if(current_state->player_direction == 1){
-
-        render_image(renderer, &texture_duck_right, current_state->player_x * TILE_WIDTH, current_state->player_y * TILE_HEIGHT);
-
-    }else if(current_state->player_direction == 2){
-
-        render_image(renderer, &texture_duck_down, current_state->player_x * TILE_WIDTH, current_state->player_y * TILE_HEIGHT);
-
-    }else if(current_state->player_direction == 3){
-
-        render_flipped(renderer, &texture_duck_right, current_state->player_x * TILE_WIDTH, current_state->player_y * TILE_HEIGHT);
-    }
+void get_hint_text(HintEngine* hint, char* text){
 
-    for(int i = 0; i < MAX_DUCK_COUNT; i++){
+    char* move_names[11] = { "Nothing", "Up", "Right", "Down", "Left", "Undo", "Waddle up", "Waddle right", "Waddle down", "Waddle left", "Wait" };
 
-        if(current_state->duckling_x[i] != -1){
+    if(hint->status == HINT_SEARCHING){
 
-            if(current_state->duckling_direction[i] == 0){
+        sprintf(text, "Hint: thinking...");
 
-                render_image(renderer, &texture_duckling_up, current_state->duckling_x[i] * TILE_WIDTH, current_state->duckling_y[i] * TILE_HEIGHT);
+    }else if(hint->status == HINT_FOUND){
 
-            }else if(current_state->duckling_direction[i] == 1){
+        sprintf(text, "Hint: %s (%i moves left)", move_names[hint->move], hint->moves_left);
 
-                render_image(renderer, &texture_duckling_right, current_state->duckling_x[i] * TILE_WIDTH, current_state->duckling_y[i] * TILE_HEIGHT);
+    }else if(hint->status == HINT_UNSOLVABLE){
 
-            }else if(current_state->duckling_direction[i] == 2){
+        sprintf(text, "Hint: no way to win from here, try undoing");
 
-                render_image(renderer, &texture_duckling_down, current_state->duckling_x[i] * TILE_WIDTH, current_state->duckling_y[i] * TILE_HEIGHT);
-                
-            }else if(current_state->duckling_direction[i] == 3){
+    }else{
 
-                render_flipped(renderer, &texture_duckling_right, current_state->duckling_x[i] * TILE_WIDTH, current_state->duckling_y[i] * TILE_HEIGHT);
-            }
-        }
+        sprintf(text, "Hint: too hard to work out from here");
     }
+}
 
-    for(int i = 0; i < MAX_BREAD_COUNT; i++){
+void render_timeline(SDL_Renderer* renderer, int position, int move_count){
 
-        if(current_state->bread_x[i] != -1){
+    if(move_count == 0){
 
-            render_image(renderer, &texture_bread, current_state->bread_x[i] * TILE_WIDTH, current_state->bread_y[i] * TILE_HEIGHT);
-        }
+        return;
     }
 
-    SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255);
-    for(int i = 0; i < MAX_GOOSE_COUNT; i++){
+    SDL_Rect track_rect = (SDL_Rect){ .x = 0, .y = SCREEN_HEIGHT - TIMELINE_HEIGHT, .w = SCREEN_WIDTH, .h = TIMELINE_HEIGHT };
+    SDL_SetRenderDrawColor(renderer, 60, 60, 60, 255);
+    SDL_RenderFillRect(renderer, &track_rect);
 
-        if(current_state->goose_x[i] != -1){
+    SDL_Rect played_rect = track_rect;
+    played_rect.w = (position * SCREEN_WIDTH) / move_count;
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderFillRect(renderer, &played_rect);
+}
 
-            SDL_Rect goose_rect = (SDL_Rect){ .x = current_state->goose_x[i] * TILE_WIDTH, .y = current_state->goose_y[i] * TILE_HEIGHT, .w = TILE_WIDTH, .h = TILE_HEIGHT };
-            SDL_RenderFillRect(renderer, &goose_rect);
-            if(current_state->goose_direction[i] == 0){
+void render_state(SDL_Renderer* renderer, State* current_state, Camera* camera){
 
-                render_image(renderer, &texture_goose_up, current_state->goose_x[i] * TILE_WIDTH, current_state->goose_y[i] * TILE_HEIGHT);
+    render_state_blended(renderer, current_state, current_state, ANIMATION_SCALE, camera);
+}
 
-            }else if(current_state->goose_direction[i] == 1){
+// Draws everything partway between two states, through the framebuffer with --blitter
+void render_state_blended(SDL_Renderer* renderer, State* from, State* to, int blend, Camera* camera){
 
-                render_image(renderer, &texture_goose_right, current_state->goose_x[i] * TILE_WIDTH, current_state->goose_y[i] * TILE_HEIGHT);
+    // In the order of the SCENE_* sprite slots
+    Texture* images[SCENE_SPRITE_COUNT] = {
+        &texture_duck_up, &texture_duck_right, &texture_duck_down,
+        &texture_duckling_up, &texture_duckling_right, &texture_duckling_down,
+        &texture_goose_up, &texture_goose_right, &texture_goose_down,
+        &texture_grass, &texture_bread
+    };
 
-            }else if(current_state->goose_direction[i] == 2){
+    SceneTarget target;
+    target.renderer = renderer;
+    target.framebuffer = use_blitter ? &framebuffer : NULL;
+    for(int i = 0; i < SCENE_SPRITE_COUNT; i++){
 
-                render_image(renderer, &texture_goose_down, current_state->goose_x[i] * TILE_WIDTH, current_state->goose_y[i] * TILE_HEIGHT);
+        target.images[i] = images[i];
+        target.sprites[i] = &images[i]->sprite;
+    }
+    render_scene(&target, from, to, blend, camera);
 
-            }else if(current_state->goose_direction[i] == 3){
+    // One upload for the whole map, everything drawn after this goes on top as before
+    if(use_blitter){
 
-                render_flipped(renderer, &texture_goose_right, current_state->goose_x[i] * TILE_WIDTH, current_state->goose_y[i] * TILE_HEIGHT);
-            }
-        }
+        framebuffer_present(&framebuffer, renderer);
     }
 }
 
 void render_text(SDL_Renderer* renderer, TTF_Font* font, char* text, SDL_Color color, int x, int y){
 
+    if(font == NULL){
+
+        return;
+    }
+
     SDL_Surface* text_surface = TTF_RenderText_Solid(font, text, color);
 
     if(text_surface == NULL){
@@ -874,23 +1083,9 @@ void render_text(SDL_Renderer* renderer, TTF_Font* font, char* text, SDL_Color c
     SDL_DestroyTexture(text_texture);
 }
 
-void render_image(SDL_Renderer* renderer, Texture* texture, int x, int y){
-
-    SDL_Rect source_rect = (SDL_Rect){ .x = 0, .y = 0, .w = texture->width, .h = texture->height };
-    SDL_Rect dest_rect = (SDL_Rect){ .x = x, .y = y, .w = source_rect.w, .h = source_rect.h };
-    SDL_RenderCopy(renderer, texture->texture, &source_rect, &dest_rect);
-}
-
-void render_flipped(SDL_Renderer* renderer, Texture* texture, int x, int y){
-
-    SDL_Rect source_rect = (SDL_Rect){ .x = 0, .y = 0, .w = texture->width, .h = texture->height };
-    SDL_Rect dest_rect = (SDL_Rect){ .x = x, .y = y, .w = source_rect.w, .h = source_rect.h };
-    SDL_RenderCopyEx(renderer, texture->texture, &source_rect, &dest_rect, 0, NULL, SDL_FLIP_HORIZONTAL);
-}
-
 int edit_loop(SDL_Renderer* renderer, char* filename){
 
-    TTF_Font* font_small = TTF_OpenFont("./res/notosans.ttf", 10);
+    TTF_Font* font_small = assets_font(10);
 
     if(font_small == NULL){
 
@@ -913,7 +1108,7 @@ int edit_loop(SDL_Renderer* renderer, char* filename){
     State* current_state = NULL;
 
     char filepath[256];
-    sprintf(filepath, "./puzzles/%s", filename);
+    snprintf(filepath, sizeof(filepath), "./puzzles/%s", filename);
     FILE* file = fopen(filepath, "r");
     if(file){
 
@@ -932,13 +1127,54 @@ int edit_loop(SDL_Renderer* renderer, char* filename){
     const int EDIT_GOOSE = 4;
     const int EDIT_ERASE = 5;
     const int EDIT_SAVE = 6;
+    const int EDIT_RESIZE = 7;
     int editor_mode = EDIT_HELP;
 
     int mouse_x = 0;
     int mouse_y = 0;
 
+    EditorAnalysis analysis;
+    analysis_init(&analysis);
+
+    EditorJournal journal;
+    journal_init(&journal, current_state);
+    bool painting = false;
+    bool selecting_rect = false;
+    int rect_anchor_x = 0;
+    int rect_anchor_y = 0;
+
+    Camera camera;
+    camera_init(&camera, SCREEN_WIDTH, SCREEN_HEIGHT);
+    Minimap minimap;
+    minimap_init(&minimap);
+    bool show_minimap = true;
+
     while(running){
 
+        // What a click paints in the current mode
+        const int NOTHING_TO_PAINT = -2;
+        int paint_entity = NOTHING_TO_PAINT;
+        if(editor_mode == EDIT_PLAYER){
+
+            paint_entity = EDIT_ENTITY_PLAYER;
+
+        }else if(editor_mode == EDIT_DUCK){
+
+            paint_entity = EDIT_ENTITY_DUCKLING;
+
+        }else if(editor_mode == EDIT_BREAD){
+
+            paint_entity = EDIT_ENTITY_BREAD;
+
+        }else if(editor_mode == EDIT_GOOSE){
+
+            paint_entity = EDIT_ENTITY_GOOSE;
+
+        }else if(editor_mode == EDIT_ERASE){
+
+            paint_entity = EDIT_ENTITY_NONE;
+        }
+
         // Poll events
         SDL_Event e;
         while(SDL_PollEvent(&e) != 0){
@@ -955,8 +1191,15 @@ int edit_loop(SDL_Renderer* renderer, char* filename){
 
                     if(key == SDLK_y){
 
-                        editor_save_puzzle(current_state, filename);
-                        running = false;
+                        if(editor_save_puzzle(current_state, filename)){
+
+                            puzzle_index_update(filename);
+                            running = false;
+
+                        }else{
+
+                            editor_mode = EDIT_HELP;
+                        }
 
                     }else if(key == SDLK_n){
 
@@ -965,7 +1208,24 @@ int edit_loop(SDL_Renderer* renderer, char* filename){
                     continue;
                 }
 
-                if(key == SDLK_h){
+                // A drag or rectangle belongs to the mode and the timeline it started in, so undo, redo or a new mode ends it first
+                int previous_mode = editor_mode;
+                bool undo_or_redo = (key == SDLK_z || key == SDLK_y) && (SDL_GetModState() & KMOD_CTRL);
+                if(undo_or_redo){
+
+                    editor_end_stroke(&journal, &painting, &selecting_rect);
+
+                    // Ctrl+Shift+Z redoes too
+                    if(key == SDLK_z && !(SDL_GetModState() & KMOD_SHIFT)){
+
+                        journal_undo(&journal, current_state);
+
+                    }else{
+
+                        journal_redo(&journal, current_state);
+                    }
+
+                }else if(key == SDLK_h){
 
                     editor_mode = EDIT_HELP;
 
@@ -992,108 +1252,142 @@ int edit_loop(SDL_Renderer* renderer, char* filename){
                 }else if(key == SDLK_s){
 
                     editor_mode = EDIT_SAVE;
-                }
 
-            }else if(e.type == SDL_MOUSEMOTION){
+                }else if(key == SDLK_r){
 
-                int x, y;
-                SDL_GetMouseState(&x, &y);
-                mouse_x = (int)(x / (double)TILE_WIDTH);
-                mouse_y = (int)(y / (double)TILE_HEIGHT);
-                if(mouse_x >= current_state->map_width){
+                    editor_mode = EDIT_RESIZE;
 
-                    mouse_x = current_state->map_width - 1;
-                }
-                if(mouse_y >= current_state->map_height){
+                }else if(key == SDLK_m){
 
-                    mouse_y = current_state->map_height - 1;
-                }
+                    show_minimap = !show_minimap;
 
-            }else if(e.type == SDL_MOUSEBUTTONDOWN){
+                }else if(key == SDLK_EQUALS || key == SDLK_KP_PLUS){
 
-                int x, y;
-                SDL_GetMouseState(&x, &y);
-                mouse_x = (int)(x / (double)TILE_WIDTH);
-                mouse_y = (int)(y / (double)TILE_HEIGHT);
-                if(mouse_x >= current_state->map_width){
+                    camera_zoom(&camera, current_state, 1, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
 
-                    mouse_x = current_state->map_width - 1;
-                }
-                if(mouse_y >= current_state->map_height){
+                }else if(key == SDLK_MINUS || key == SDLK_KP_MINUS){
 
-                    mouse_y = current_state->map_height - 1;
-                }
+                    camera_zoom(&camera, current_state, -1, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
 
-                if(editor_mode == EDIT_PLAYER){
+                }else if(key == SDLK_UP || key == SDLK_RIGHT || key == SDLK_DOWN || key == SDLK_LEFT){
 
-                    if(!square_occupied(current_state, mouse_x, mouse_y)){
+                    // Resizing moves the right and bottom edges, otherwise the arrows scroll. Shift goes ten at a time.
+                    int step = (SDL_GetModState() & KMOD_SHIFT) ? 10 : 1;
+                    int delta_x = key == SDLK_RIGHT ? step : (key == SDLK_LEFT ? -step : 0);
+                    int delta_y = key == SDLK_DOWN ? step : (key == SDLK_UP ? -step : 0);
+                    if(editor_mode == EDIT_RESIZE){
 
-                        current_state->player_x = mouse_x;
-                        current_state->player_y = mouse_y;
-                    }
+                        journal_resize(&journal, current_state, current_state->map_width + delta_x, current_state->map_height + delta_y);
 
-                }else if(editor_mode == EDIT_DUCK){
+                    }else{
 
-                    if(!square_occupied(current_state, mouse_x, mouse_y)){
+                        camera_pan(&camera, current_state, delta_x * camera.tile_size, delta_y * camera.tile_size);
+                    }
+                }
 
-                        for(int i = 0; i < MAX_DUCK_COUNT; i++){
+                if(editor_mode != previous_mode){
 
-                            if(current_state->duckling_x[i] == -1){
+                    editor_end_stroke(&journal, &painting, &selecting_rect);
+                }
 
-                                current_state->duckling_x[i] = mouse_x;
-                                current_state->duckling_y[i] = mouse_y;
-                                break;
-                            }
-                        }
-                    }
+                // Undo, redo, resizing and scrolling can all leave the mouse over a different square
+                camera_clamp(&camera, current_state);
+                editor_mouse_square(&camera, current_state, &mouse_x, &mouse_y);
 
-                }else if(editor_mode == EDIT_BREAD){
+            }else if(e.type == SDL_MOUSEWHEEL){
 
-                    if(!square_occupied(current_state, mouse_x, mouse_y)){
+                int x, y;
+                get_mouse_position(&x, &y);
+                camera_zoom(&camera, current_state, e.wheel.y, x, y);
+                editor_mouse_square(&camera, current_state, &mouse_x, &mouse_y);
 
-                        for(int i = 0; i < MAX_BREAD_COUNT; i++){
+            }else if(e.type == SDL_MOUSEMOTION || e.type == SDL_MOUSEBUTTONDOWN){
 
-                            if(current_state->bread_x[i] == -1){
+                // Dragging with the right button scrolls the view
+                if(e.type == SDL_MOUSEMOTION && (e.motion.state & SDL_BUTTON_RMASK)){
 
-                                current_state->bread_x[i] = mouse_x;
-                                current_state->bread_y[i] = mouse_y;
-                                break;
-                            }
-                        }
+                    // Measured in logical pixels, so the map keeps up with the mouse at any output scale
+                    int x = e.motion.x;
+                    int y = e.motion.y;
+                    int previous_x = e.motion.x - e.motion.xrel;
+                    int previous_y = e.motion.y - e.motion.yrel;
+                    if(use_upscaler){
+
+                        upscaler_map_point(&upscaler, x, y, &x, &y);
+                        upscaler_map_point(&upscaler, previous_x, previous_y, &previous_x, &previous_y);
                     }
+                    camera_pan(&camera, current_state, previous_x - x, previous_y - y);
+                }
 
-                }else if(editor_mode == EDIT_GOOSE){
+                int previous_mouse_x = mouse_x;
+                int previous_mouse_y = mouse_y;
+                editor_mouse_square(&camera, current_state, &mouse_x, &mouse_y);
 
-                    if(!square_occupied(current_state, mouse_x, mouse_y)){
+                if(e.type == SDL_MOUSEBUTTONDOWN && e.button.button == SDL_BUTTON_LEFT && paint_entity != NOTHING_TO_PAINT){
 
-                        for(int i = 0; i < MAX_GOOSE_COUNT; i++){
+                    // Shift drags out a rectangle, anything else paints every square the mouse passes over
+                    if((SDL_GetModState() & KMOD_SHIFT) && paint_entity != EDIT_ENTITY_PLAYER){
 
-                            if(current_state->goose_x[i] == -1){
+                        selecting_rect = true;
+                        rect_anchor_x = mouse_x;
+                        rect_anchor_y = mouse_y;
 
-                                current_state->goose_x[i] = mouse_x;
-                                current_state->goose_y[i] = mouse_y;
-                                break;
-                            }
-                        }
+                    }else{
+
+                        painting = true;
+                        journal_begin_batch(&journal);
+                        journal_paint(&journal, current_state, paint_entity, mouse_x, mouse_y);
                     }
 
-                }else if(editor_mode == EDIT_ERASE){
+                }else if(painting && (mouse_x != previous_mouse_x || mouse_y != previous_mouse_y)){
+
+                    journal_paint_line(&journal, current_state, paint_entity, previous_mouse_x, previous_mouse_y, mouse_x, mouse_y);
+                }
+
+            }else if(e.type == SDL_MOUSEBUTTONUP){
+
+                if(painting){
+
+                    journal_end_batch(&journal);
+                    painting = false;
+                }
+                if(selecting_rect){
 
-                    editor_erase_at(current_state, mouse_x, mouse_y);
+                    journal_paint_rect(&journal, current_state, paint_entity, rect_anchor_x, rect_anchor_y, mouse_x, mouse_y);
+                    selecting_rect = false;
                 }
             }
         }
 
+        analysis_update(&analysis, current_state, SDL_GetTicks());
+
         // Render
+        begin_frame(renderer);
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
 
-        render_state(renderer, current_state);
+        render_state(renderer, current_state, &camera);
 
         SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-        SDL_Rect cursor_rect = { .x = mouse_x * TILE_WIDTH, .y = mouse_y * TILE_HEIGHT, TILE_WIDTH, TILE_HEIGHT };
+        int cursor_x, cursor_y;
+        camera_square_to_screen(&camera, mouse_x, mouse_y, &cursor_x, &cursor_y);
+        SDL_Rect cursor_rect = { .x = cursor_x, .y = cursor_y, camera.tile_size, camera.tile_size };
         SDL_RenderFillRect(renderer, &cursor_rect);
 
+        if(selecting_rect){
+
+            int left, top;
+            camera_square_to_screen(&camera, rect_anchor_x < mouse_x ? rect_anchor_x : mouse_x, rect_anchor_y < mouse_y ? rect_anchor_y : mouse_y, &left, &top);
+            SDL_Rect selection_rect = { .x = left, .y = top, .w = (abs(mouse_x - rect_anchor_x) + 1) * camera.tile_size, .h = (abs(mouse_y - rect_anchor_y) + 1) * camera.tile_size };
+            SDL_RenderDrawRect(renderer, &selection_rect);
+        }
+
+        minimap_update(&minimap, renderer, current_state);
+        if(show_minimap){
+
+            minimap_render(&minimap, renderer, &camera);
+        }
+
         if(editor_mode == EDIT_HELP){
 
             render_text(renderer, font_small, "Welcome to the editor!", (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 0, 0);
@@ -1104,6 +1398,11 @@ int edit_loop(SDL_Renderer* renderer, char* filename){
             render_text(renderer, font_small, "Press B to place bread", (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 0, 50);
             render_text(renderer, font_small, "Press E to enter erase mode", (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 0, 60);
             render_text(renderer, font_small, "Press S to save", (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 0, 70);
+            render_text(renderer, font_small, "Drag to paint, hold Shift while dragging to fill or erase a rectangle", (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 0, 80);
+            render_text(renderer, font_small, "Press Ctrl+Z to undo and Ctrl+Y to redo", (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 0, 90);
+            render_text(renderer, font_small, "Press R to resize the map", (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 0, 100);
+            render_text(renderer, font_small, "Scroll with the arrow keys or by right dragging, zoom with the mouse wheel or +/-", (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 0, 110);
+            render_text(renderer, font_small, "Press M to show or hide the minimap on maps bigger than the screen", (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 0, 120);
 
         }else if(editor_mode == EDIT_PLAYER){
 
@@ -1134,9 +1433,17 @@ int edit_loop(SDL_Renderer* renderer, char* filename){
         }else if(editor_mode == EDIT_SAVE){
 
             render_text(renderer, font_small, "Save and exit? [Y/n]", (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 0, 0);
+
+        }else if(editor_mode == EDIT_RESIZE){
+
+            char mode_text[128];
+            sprintf(mode_text, "Resize mode %i x %i, arrow keys move the right and bottom edges, Shift for 10", current_state->map_width, current_state->map_height);
+            render_text(renderer, font_small, mode_text, (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 0, 0);
         }
 
-        SDL_RenderPresent(renderer);
+        render_analysis(renderer, font_small, &analysis, current_state, &camera);
+
+        present_frame(renderer);
         frames++;
 
         current_time = SDL_GetTicks();
@@ -1157,8 +1464,287 @@ int edit_loop(SDL_Renderer* renderer, char* filename){
         frame_before_time = SDL_GetTicks();
     }
 
-    // Close fonts
-    TTF_CloseFont(font_small);
+    minimap_destroy(&minimap);
+    analysis_destroy(&analysis);
+    journal_free(&journal);
+    free(current_state);
 
     return return_state;
 }
+
+// Keeps what a drag has painted so far as one undo step and drops a rectangle that hasn't been let go of
+void editor_end_stroke(EditorJournal* journal, bool* painting, bool* selecting_rect){
+
+    if(*painting){
+
+        journal_end_batch(journal);
+        *painting = false;
+    }
+    *selecting_rect = false;
+}
+
+// The square under the mouse, kept on the map
+void editor_mouse_square(Camera* camera, State* current_state, int* square_x, int* square_y){
+
+    int x, y;
+    get_mouse_position(&x, &y);
+    camera_screen_to_square(camera, x, y, square_x, square_y);
+    if(*square_x >= current_state->map_width){
+
+        *square_x = current_state->map_width - 1;
+    }
+    if(*square_y >= current_state->map_height){
+
+        *square_y = current_state->map_height - 1;
+    }
+    if(*square_x < 0){
+
+        *square_x = 0;
+    }
+    if(*square_y < 0){
+
+        *square_y = 0;
+    }
+}
+
+// A puzzle's preview at twice its size in the bottom right corner of the menu
+void render_thumbnail(SDL_Renderer* renderer, TTF_Font* font, ThumbnailBatch* thumbnails, int index){
+
+    SDL_Rect dest_rect = (SDL_Rect){ .x = SCREEN_WIDTH - (THUMBNAIL_WIDTH * 2) - 20, .y = SCREEN_HEIGHT - (THUMBNAIL_HEIGHT * 2) - 20, .w = THUMBNAIL_WIDTH * 2, .h = THUMBNAIL_HEIGHT * 2 };
+    SDL_Texture* texture = thumbnail_batch_texture(thumbnails, renderer, index);
+    if(texture != NULL){
+
+        SDL_RenderCopy(renderer, texture, NULL, &dest_rect);
+
+    }else if(index >= 0 && index < thumbnails->puzzle_count && SDL_AtomicGet(&thumbnails->status[index]) != THUMBNAIL_FAILED){
+
+        render_text(renderer, font, "Drawing preview...", (SDL_Color){ .r = 160, .g = 160, .b = 160, .a = 255 }, dest_rect.x + 4, dest_rect.y + 4);
+    }
+
+    SDL_SetRenderDrawColor(renderer, 160, 160, 160, 255);
+    SDL_RenderDrawRect(renderer, &dest_rect);
+}
+
+/*
+ * The matches from the list's scroll onwards, one row of 20 pixels each, followed by the search.
+ * Only rows on screen are drawn, from text cached in the list, and only their metadata is read.
+ * selected is counted from the first match, -1 for none.
+ */
+void render_puzzle_list(SDL_Renderer* renderer, TTF_Font* font_med, TTF_Font* font_small, PuzzleList* list, int y, int visible_rows, int selected){
+
+    if(selected >= 0){
+
+        puzzle_list_scroll_to(list, selected, visible_rows);
+    }
+    int first = list->match_first + list->scroll;
+    int last = first + visible_rows;
+    if(last > list->match_first + list->match_count){
+
+        last = list->match_first + list->match_count;
+    }
+    puzzle_list_request(list, first, last);
+
+    for(int i = first; i < last; i++){
+
+        int row_y = y + (20 * (i - first));
+        PuzzleListRow* row = puzzle_list_row(list, i);
+        if(row->name == NULL){
+
+            row->name = render_text_texture(renderer, font_med, list->files[i], (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, &row->name_width, &row->name_height);
+        }
+        PuzzleMetadata* metadata = puzzle_list_metadata(list, i);
+        if(row->details == NULL && metadata != NULL){
+
+            char details_text[48];
+            if(metadata->best_length == SOLUTION_UNSOLVABLE){
+
+                sprintf(details_text, "%ix%i, unsolvable", metadata->map_width, metadata->map_height);
+
+            }else if(metadata->best_length == SOLUTION_UNKNOWN){
+
+                sprintf(details_text, "%ix%i", metadata->map_width, metadata->map_height);
+
+            }else{
+
+                sprintf(details_text, "%ix%i, best: %i moves", metadata->map_width, metadata->map_height, metadata->best_length);
+            }
+            row->details = render_text_texture(renderer, font_small, details_text, (SDL_Color){ .r = 160, .g = 160, .b = 160, .a = 255 }, &row->details_width, &row->details_height);
+        }
+
+        if(i - list->match_first == selected){
+
+            render_text(renderer, font_med, ">", (SDL_Color){ .r = 255, .g = 255, .b = 255, .a = 255 }, 8, row_y);
+        }
+        if(row->name != NULL){
+
+            SDL_Rect dest_rect = (SDL_Rect){ .x = 20, .y = row_y, .w = row->name_width, .h = row->name_height };
+            SDL_RenderCopy(renderer, row->name, NULL, &dest_rect);
+        }
+        if(row->details != NULL){
+
+            SDL_Rect dest_rect = (SDL_Rect){ .x = 300, .y = row_y + 6, .w = row->details_width, .h = row->details_height };
+            SDL_RenderCopy(renderer, row->details, NULL, &dest_rect);
+        }
+    }
+
+    char search_text[PUZZLE_LIST_SEARCH_LENGTH + 48];
+    if(list->search_length == 0){
+
+        sprintf(search_text, "%i puzzles, type to search", list->count);
+
+    }else{
+
+        sprintf(search_text, "%s_ (%i of %i)", list->search, list->match_count, list->count);
+    }
+    render_text(renderer, font_small, search_text, (SDL_Color){ .r = 160, .g = 160, .b = 160, .a = 255 }, 20, SCREEN_HEIGHT - 16);
+}
+
+// What's on the selected puzzle's map, above its preview
+void render_puzzle_details(SDL_Renderer* renderer, TTF_Font* font, PuzzleList* list, int index){
+
+    PuzzleMetadata* metadata = puzzle_list_metadata(list, index);
+    if(metadata == NULL){
+
+        return;
+    }
+
+    char details_text[64];
+    sprintf(details_text, "%i ducklings, %i bread, %i geese", metadata->duckling_count, metadata->bread_count, metadata->goose_count);
+    render_text(renderer, font, details_text, (SDL_Color){ .r = 160, .g = 160, .b = 160, .a = 255 }, SCREEN_WIDTH - (THUMBNAIL_WIDTH * 2) - 20, SCREEN_HEIGHT - (THUMBNAIL_HEIGHT * 2) - 36);
+}
+
+// Text drawn once into a texture of its own, for text that's drawn again every frame
+SDL_Texture* render_text_texture(SDL_Renderer* renderer, TTF_Font* font, char* text, SDL_Color color, int* width, int* height){
+
+    if(font == NULL){
+
+        return NULL;
+    }
+
+    SDL_Surface* text_surface = TTF_RenderText_Solid(font, text, color);
+    if(text_surface == NULL){
+
+        printf("Unable to render text to surface! SDL Error: %s\n", TTF_GetError());
+        return NULL;
+    }
+
+    SDL_Texture* text_texture = SDL_CreateTextureFromSurface(renderer, text_surface);
+    if(text_texture == NULL){
+
+        printf("Unable to create texture! SDL Error: %s\n", SDL_GetError());
+    }
+    *width = text_surface->w;
+    *height = text_surface->h;
+    SDL_FreeSurface(text_surface);
+
+    return text_texture;
+}
+
+// The mouse in logical pixels, whatever the window has been scaled to
+void get_mouse_position(int* x, int* y){
+
+    SDL_GetMouseState(x, y);
+    if(use_upscaler){
+
+        upscaler_map_point(&upscaler, *x, *y, x, y);
+    }
+}
+
+void begin_frame(SDL_Renderer* renderer){
+
+    assets_upload(renderer);
+    if(use_upscaler){
+
+        upscaler_begin_frame(&upscaler, renderer);
+    }
+}
+
+void present_frame(SDL_Renderer* renderer){
+
+    if(use_upscaler){
+
+        upscaler_end_frame(&upscaler, renderer);
+    }
+    SDL_RenderPresent(renderer);
+    if(startup_probe_start != 0){
+
+        startup_probe_frame();
+    }
+}
+
+// Prints the milliseconds since the launcher started the game at the first frame and at the first with everything loaded, then quits
+void startup_probe_frame(){
+
+    double elapsed_ms = (double)(SDL_GetPerformanceCounter() - startup_probe_start) * 1000 / SDL_GetPerformanceFrequency();
+    if(!startup_probe_presented){
+
+        printf("first frame %.3f\n", elapsed_ms);
+        startup_probe_presented = true;
+    }
+    if(assets_outstanding() == 0){
+
+        printf("loaded %.3f\n", elapsed_ms);
+        fflush(stdout);
+        startup_probe_start = 0;
+
+        SDL_Event quit_event;
+        memset(&quit_event, 0, sizeof(SDL_Event));
+        quit_event.type = SDL_QUIT;
+        SDL_PushEvent(&quit_event);
+    }
+}
+
+void render_analysis(SDL_Renderer* renderer, TTF_Font* font, EditorAnalysis* analysis, State* current_state, Camera* camera){
+
+    SDL_Color white = { .r = 255, .g = 255, .b = 255, .a = 255 };
+    SDL_Color red = { .r = 255, .g = 0, .b = 0, .a = 255 };
+
+    char analysis_text[96];
+    SDL_Color analysis_color = white;
+    if(analysis->status == ANALYSIS_NONE){
+
+        sprintf(analysis_text, "Place some bread to check solvability");
+
+    }else if(analysis->status == ANALYSIS_PENDING){
+
+        sprintf(analysis_text, "Checking solvability...");
+
+    }else if(analysis->status == ANALYSIS_BOUNDED){
+
+        sprintf(analysis_text, "Solvable in at most %i moves, looking for fewer...", analysis->move_count);
+
+    }else if(analysis->status == ANALYSIS_SOLVABLE){
+
+        sprintf(analysis_text, "Solvable, optimal solution is %i moves", analysis->move_count);
+        analysis_color = (SDL_Color){ .r = 0, .g = 255, .b = 0, .a = 255 };
+
+    }else if(analysis->status == ANALYSIS_UNSOLVABLE){
+
+        sprintf(analysis_text, "Unsolvable");
+        analysis_color = red;
+
+    }else if(analysis->move_count != -1){
+
+        sprintf(analysis_text, "Solvable in at most %i moves, too hard to prove optimal", analysis->move_count);
+
+    }else{
+
+        sprintf(analysis_text, "Too hard to tell if this is solvable");
+    }
+    render_text(renderer, font, analysis_text, analysis_color, 0, SCREEN_HEIGHT - 12);
+
+    // Turns until each goose reaches its bread, red if nothing can stop it in time, as worked out when the layout last changed
+    for(int i = 0; i < MAX_GOOSE_COUNT; i++){
+
+        if(analysis->threat_distance[i] == -1 || current_state->goose_x[i] == -1 || !camera_square_visible(camera, current_state->goose_x[i], current_state->goose_y[i])){
+
+            continue;
+        }
+
+        char threat_text[8];
+        sprintf(threat_text, "%i", analysis->threat_distance[i]);
+        int x, y;
+        camera_square_to_screen(camera, current_state->goose_x[i], current_state->goose_y[i], &x, &y);
+        render_text(renderer, font, threat_text, analysis->threat_unstoppable[i] ? red : white, x, y);
+    }
+}
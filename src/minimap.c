@@ -0,0 +1,233 @@
+#include "minimap.h"
+
+void minimap_init(Minimap* minimap){
+
+    minimap->texture = NULL;
+    minimap->map_width = 0;
+    minimap->map_height = 0;
+    minimap->scale = 1;
+}
+
+void minimap_destroy(Minimap* minimap){
+
+    if(minimap->texture != NULL){
+
+        SDL_DestroyTexture(minimap->texture);
+    }
+    minimap->texture = NULL;
+    minimap->map_width = 0;
+    minimap->map_height = 0;
+}
+
+// Whatever render_state would draw on top at a square
+Uint32 minimap_square_color(State* current_state, int square_x, int square_y){
+
+    for(int i = 0; i < MAX_GOOSE_COUNT; i++){
+
+        if(current_state->goose_x[i] == square_x && current_state->goose_y[i] == square_y){
+
+            return MINIMAP_GOOSE;
+        }
+    }
+    for(int i = 0; i < MAX_BREAD_COUNT; i++){
+
+        if(current_state->bread_x[i] == square_x && current_state->bread_y[i] == square_y){
+
+            return MINIMAP_BREAD;
+        }
+    }
+    for(int i = 0; i < MAX_DUCK_COUNT; i++){
+
+        if(current_state->duckling_x[i] == square_x && current_state->duckling_y[i] == square_y){
+
+            return MINIMAP_DUCKLING;
+        }
+    }
+    if(current_state->player_x == square_x && current_state->player_y == square_y){
+
+        return MINIMAP_PLAYER;
+    }
+
+    return MINIMAP_GRASS;
+}
+
+// Fills one square's block of a locked texture, pixels pointing at the block's top left
+void minimap_fill(void* pixels, int pitch, int scale, Uint32 color){
+
+    for(int row = 0; row < scale; row++){
+
+        Uint32* line = (Uint32*)((Uint8*)pixels + (row * pitch));
+        for(int column = 0; column < scale; column++){
+
+            line[column] = color;
+        }
+    }
+}
+
+void minimap_repaint_square(Minimap* minimap, State* current_state, int square_x, int square_y){
+
+    if(square_x < 0 || square_x >= minimap->map_width || square_y < 0 || square_y >= minimap->map_height){
+
+        return;
+    }
+
+    // Locking only the square's block means only it has to be written
+    SDL_Rect block = { .x = square_x * minimap->scale, .y = square_y * minimap->scale, .w = minimap->scale, .h = minimap->scale };
+    void* pixels;
+    int pitch;
+    if(SDL_LockTexture(minimap->texture, &block, &pixels, &pitch) != 0){
+
+        return;
+    }
+    minimap_fill(pixels, pitch, minimap->scale, minimap_square_color(current_state, square_x, square_y));
+    SDL_UnlockTexture(minimap->texture);
+}
+
+void minimap_repaint_all(Minimap* minimap, State* current_state){
+
+    void* pixels;
+    int pitch;
+    if(SDL_LockTexture(minimap->texture, NULL, &pixels, &pitch) != 0){
+
+        printf("Unable to lock minimap texture! SDL Error: %s\n", SDL_GetError());
+        return;
+    }
+
+    int scale = minimap->scale;
+    for(int y = 0; y < minimap->map_height; y++){
+
+        for(int x = 0; x < minimap->map_width; x++){
+
+            minimap_fill((Uint8*)pixels + (y * scale * pitch) + (x * scale * 4), pitch, scale, MINIMAP_GRASS);
+        }
+    }
+
+    // In render_state's order, so whatever is drawn last ends up on top
+    int entity_count = 1 + MAX_DUCK_COUNT + MAX_BREAD_COUNT + MAX_GOOSE_COUNT;
+    for(int i = 0; i < entity_count; i++){
+
+        int x, y;
+        Uint32 color;
+        if(i == 0){
+
+            x = current_state->player_x;
+            y = current_state->player_y;
+            color = MINIMAP_PLAYER;
+
+        }else if(i < 1 + MAX_DUCK_COUNT){
+
+            x = current_state->duckling_x[i - 1];
+            y = current_state->duckling_y[i - 1];
+            color = MINIMAP_DUCKLING;
+
+        }else if(i < 1 + MAX_DUCK_COUNT + MAX_BREAD_COUNT){
+
+            x = current_state->bread_x[i - 1 - MAX_DUCK_COUNT];
+            y = current_state->bread_y[i - 1 - MAX_DUCK_COUNT];
+            color = MINIMAP_BREAD;
+
+        }else{
+
+            x = current_state->goose_x[i - 1 - MAX_DUCK_COUNT - MAX_BREAD_COUNT];
+            y = current_state->goose_y[i - 1 - MAX_DUCK_COUNT - MAX_BREAD_COUNT];
+            color = MINIMAP_GOOSE;
+        }
+
+        if(x >= 0 && x < minimap->map_width && y >= 0 && y < minimap->map_height){
+
+            minimap_fill((Uint8*)pixels + (y * scale * pitch) + (x * scale * 4), pitch, scale, color);
+        }
+    }
+
+    SDL_UnlockTexture(minimap->texture);
+}
+
+// Repaints both ends of an entity's move, if it moved at all
+void minimap_repaint_moved(Minimap* minimap, State* current_state, int old_x, int old_y, int new_x, int new_y){
+
+    if(old_x == new_x && old_y == new_y){
+
+        return;
+    }
+    minimap_repaint_square(minimap, current_state, old_x, old_y);
+    minimap_repaint_square(minimap, current_state, new_x, new_y);
+}
+
+void minimap_update(Minimap* minimap, SDL_Renderer* renderer, State* current_state){
+
+    if(current_state->map_width != minimap->map_width || current_state->map_height != minimap->map_height){
+
+        minimap_destroy(minimap);
+        minimap->map_width = current_state->map_width;
+        minimap->map_height = current_state->map_height;
+
+        int longest_side = minimap->map_width > minimap->map_height ? minimap->map_width : minimap->map_height;
+        minimap->scale = longest_side < MINIMAP_MAX_SIZE ? MINIMAP_MAX_SIZE / longest_side : 1;
+        minimap->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, minimap->map_width * minimap->scale, minimap->map_height * minimap->scale);
+        if(minimap->texture == NULL){
+
+            printf("Unable to create minimap texture! SDL Error: %s\n", SDL_GetError());
+            return;
+        }
+
+        minimap_repaint_all(minimap, current_state);
+        minimap->drawn_state = *current_state;
+        return;
+    }
+
+    if(minimap->texture == NULL){
+
+        return;
+    }
+
+    State* drawn_state = &minimap->drawn_state;
+    minimap_repaint_moved(minimap, current_state, drawn_state->player_x, drawn_state->player_y, current_state->player_x, current_state->player_y);
+    for(int i = 0; i < MAX_DUCK_COUNT; i++){
+
+        minimap_repaint_moved(minimap, current_state, drawn_state->duckling_x[i], drawn_state->duckling_y[i], current_state->duckling_x[i], current_state->duckling_y[i]);
+    }
+    for(int i = 0; i < MAX_BREAD_COUNT; i++){
+
+        minimap_repaint_moved(minimap, current_state, drawn_state->bread_x[i], drawn_state->bread_y[i], current_state->bread_x[i], current_state->bread_y[i]);
+    }
+    for(int i = 0; i < MAX_GOOSE_COUNT; i++){
+
+        minimap_repaint_moved(minimap, current_state, drawn_state->goose_x[i], drawn_state->goose_y[i], current_state->goose_x[i], current_state->goose_y[i]);
+    }
+    *drawn_state = *current_state;
+}
+
+void minimap_render(Minimap* minimap, SDL_Renderer* renderer, Camera* camera){
+
+    int map_pixel_width = minimap->map_width * camera->tile_size;
+    int map_pixel_height = minimap->map_height * camera->tile_size;
+    if(minimap->texture == NULL || (map_pixel_width <= camera->view_width && map_pixel_height <= camera->view_height)){
+
+        return;
+    }
+
+    // Big maps are shrunk to fit, one texture pixel per square
+    int texture_width = minimap->map_width * minimap->scale;
+    int texture_height = minimap->map_height * minimap->scale;
+    int longest_side = texture_width > texture_height ? texture_width : texture_height;
+    SDL_Rect dest_rect = { .x = 0, .y = MINIMAP_MARGIN, .w = texture_width, .h = texture_height };
+    if(longest_side > MINIMAP_MAX_SIZE){
+
+        dest_rect.w = (texture_width * MINIMAP_MAX_SIZE) / longest_side;
+        dest_rect.h = (texture_height * MINIMAP_MAX_SIZE) / longest_side;
+    }
+    dest_rect.x = camera->view_width - dest_rect.w - MINIMAP_MARGIN;
+    SDL_RenderCopy(renderer, minimap->texture, NULL, &dest_rect);
+
+    SDL_Rect view_rect = { .x = dest_rect.x + ((camera->x * dest_rect.w) / map_pixel_width), .y = dest_rect.y + ((camera->y * dest_rect.h) / map_pixel_height), .w = (camera->view_width * dest_rect.w) / map_pixel_width, .h = (camera->view_height * dest_rect.h) / map_pixel_height };
+    if(view_rect.w > dest_rect.w){
+
+        view_rect.w = dest_rect.w;
+    }
+    if(view_rect.h > dest_rect.h){
+
+        view_rect.h = dest_rect.h;
+    }
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderDrawRect(renderer, &view_rect);
+}
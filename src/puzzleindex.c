@@ -0,0 +1,584 @@
+#include "puzzleindex.h"
+#include "solutiondb.h"
+#include <SDL2/SDL.h>
+#include <sys/stat.h>
+#ifdef __linux__
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+#define INDEX_HEADER_SIZE 8
+#define INDEX_RECORD_HEADER_SIZE 48
+#define INDEX_EVENT_BUFFER_SIZE 4096
+#define INDEX_PATH_SIZE 256 // the same as get_from_file's, so any name that fits here can be loaded
+
+typedef struct PuzzleIndex{
+
+    char path[256];
+    SDL_mutex* mutex; // held while entries change, and by lookups from other threads
+
+    PuzzleIndexEntry** entries; // sorted by name with strcmp
+    int entry_count;
+    int entry_capacity;
+    bool dirty; // differs from the file
+
+    int watch_fd; // -1 without inotify, in which case the folder is compared every so often
+    Uint32 scan_time;
+
+    SDL_Thread* opener; // loading and comparing the folder, until poll or update waits for it
+    SDL_atomic_t ready; // set once the opener is done, nothing but the opener touches the rest before then
+} PuzzleIndex;
+
+PuzzleIndex* puzzle_index = NULL;
+
+int index_compare_entries(const void* a, const void* b){
+
+    return strcmp((*(PuzzleIndexEntry**)a)->name, (*(PuzzleIndexEntry**)b)->name);
+}
+
+int index_compare_names(const void* a, const void* b){
+
+    return strcmp(*(char**)a, *(char**)b);
+}
+
+// Where the name is, or where it would go, setting found if it's there
+int index_search(PuzzleIndex* index, char* name, bool* found){
+
+    int low = 0;
+    int high = index->entry_count;
+    while(low < high){
+
+        int middle = low + ((high - low) / 2);
+        int compare = strcmp(index->entries[middle]->name, name);
+        if(compare == 0){
+
+            *found = true;
+            return middle;
+        }
+        if(compare < 0){
+
+            low = middle + 1;
+
+        }else{
+
+            high = middle;
+        }
+    }
+    *found = false;
+
+    return low;
+}
+
+void index_free_entry(PuzzleIndexEntry* entry){
+
+    free(entry->name);
+    free(entry);
+}
+
+void index_remove(PuzzleIndex* index, int position){
+
+    SDL_LockMutex(index->mutex);
+    index_free_entry(index->entries[position]);
+    memmove(&index->entries[position], &index->entries[position + 1], (index->entry_count - position - 1) * sizeof(PuzzleIndexEntry*));
+    index->entry_count--;
+    index->dirty = true;
+    SDL_UnlockMutex(index->mutex);
+}
+
+// Takes ownership of the entry, replacing whatever was at its position if found is set
+void index_insert(PuzzleIndex* index, PuzzleIndexEntry* entry, int position, bool found){
+
+    SDL_LockMutex(index->mutex);
+    if(found){
+
+        index_free_entry(index->entries[position]);
+
+    }else{
+
+        if(index->entry_count == index->entry_capacity){
+
+            index->entry_capacity *= 2;
+            index->entries = (PuzzleIndexEntry**)realloc(index->entries, index->entry_capacity * sizeof(PuzzleIndexEntry*));
+        }
+        memmove(&index->entries[position + 1], &index->entries[position], (index->entry_count - position) * sizeof(PuzzleIndexEntry*));
+        index->entry_count++;
+    }
+    index->entries[position] = entry;
+    index->dirty = true;
+    SDL_UnlockMutex(index->mutex);
+}
+
+uint64_t puzzle_index_hash_file(char* path){
+
+    FILE* file = fopen(path, "rb");
+    if(file == NULL){
+
+        return 0;
+    }
+
+    uint64_t hash = 14695981039346656037ULL;
+    unsigned char buffer[4096];
+    size_t read_count;
+    while((read_count = fread(buffer, 1, sizeof(buffer), file)) > 0){
+
+        for(size_t i = 0; i < read_count; i++){
+
+            hash ^= buffer[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+    fclose(file);
+
+    return hash;
+}
+
+// False if the name is too long to make a path of, in which case the puzzle is treated as not being there
+bool index_puzzle_path(char* name, char* path){
+
+    int length = snprintf(path, INDEX_PATH_SIZE, "./puzzles/%s", name);
+
+    return length >= 0 && length < INDEX_PATH_SIZE;
+}
+
+// The path has to have come from index_puzzle_path
+PuzzleIndexEntry* index_read_puzzle(char* name, char* path, struct stat* file_stat){
+
+    PuzzleIndexEntry* entry = (PuzzleIndexEntry*)calloc(1, sizeof(PuzzleIndexEntry));
+    entry->name = (char*)malloc(strlen(name) + 1);
+    strcpy(entry->name, name);
+    entry->size = file_stat->st_size;
+    entry->mtime = file_stat->st_mtime;
+    entry->content_hash = puzzle_index_hash_file(path);
+
+    State* initial_state = get_from_file(name);
+    if(initial_state != NULL){
+
+        entry->valid = true;
+        entry->puzzle_hash = get_puzzle_hash(initial_state);
+        entry->map_width = initial_state->map_width;
+        entry->map_height = initial_state->map_height;
+        entry->duckling_count = get_duckling_count(initial_state);
+        entry->bread_count = get_bread_count(initial_state);
+        entry->goose_count = get_goose_count(initial_state);
+        free(initial_state);
+    }
+
+    return entry;
+}
+
+/*
+ * Brings one name up to date with the folder after something wrote, moved or removed it, returning
+ * whether its entry changed. The file is always read again: a write that keeps the size and lands
+ * within the mtime's second would otherwise go unnoticed.
+ */
+bool index_update(PuzzleIndex* index, char* name){
+
+    bool found;
+    int position = index_search(index, name, &found);
+
+    char path[INDEX_PATH_SIZE];
+    struct stat file_stat;
+    if(!is_puzzle_filename(name) || !index_puzzle_path(name, path) || stat(path, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)){
+
+        if(found){
+
+            index_remove(index, position);
+        }
+        return found;
+    }
+
+    PuzzleIndexEntry* entry = index_read_puzzle(name, path, &file_stat);
+    if(found && entry->content_hash == index->entries[position]->content_hash){
+
+        // Touched but not changed, only the times need keeping
+        SDL_LockMutex(index->mutex);
+        index->entries[position]->mtime = entry->mtime;
+        SDL_UnlockMutex(index->mutex);
+        index->dirty = true;
+        index_free_entry(entry);
+        return false;
+    }
+    index_insert(index, entry, position, found);
+
+    return true;
+}
+
+/*
+ * Lists the folder and builds the entries afresh in one go, reusing the ones whose file hasn't
+ * changed, rather than inserting names one at a time, which would shift the whole array for each
+ * new puzzle when the index starts out empty.
+ */
+bool index_scan(PuzzleIndex* index){
+
+    int name_count;
+    char** names = generate_puzzle_list(&name_count);
+    if(names != NULL){
+
+        qsort(names, name_count, sizeof(char*), index_compare_names);
+    }
+
+    PuzzleIndexEntry** entries = (PuzzleIndexEntry**)malloc((name_count + 64) * sizeof(PuzzleIndexEntry*));
+    bool* reused = (bool*)calloc(index->entry_count + 1, sizeof(bool));
+    int entry_count = 0;
+    bool changed = false;
+    for(int i = 0; i < name_count; i++){
+
+        char path[INDEX_PATH_SIZE];
+        struct stat file_stat;
+        if(!index_puzzle_path(names[i], path) || stat(path, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)){
+
+            continue;
+        }
+
+        bool found;
+        int position = index_search(index, names[i], &found);
+        PuzzleIndexEntry* old_entry = found ? index->entries[position] : NULL;
+        if(old_entry != NULL && old_entry->size == file_stat.st_size && old_entry->mtime == file_stat.st_mtime){
+
+            entries[entry_count] = old_entry;
+            entry_count++;
+            reused[position] = true;
+            continue;
+        }
+
+        PuzzleIndexEntry* entry = index_read_puzzle(names[i], path, &file_stat);
+        if(old_entry != NULL && old_entry->content_hash == entry->content_hash){
+
+            // Touched but not changed, only the times need keeping
+            SDL_LockMutex(index->mutex);
+            old_entry->mtime = entry->mtime;
+            SDL_UnlockMutex(index->mutex);
+            index_free_entry(entry);
+            entry = old_entry;
+            reused[position] = true;
+
+        }else{
+
+            changed = true;
+        }
+        entries[entry_count] = entry;
+        entry_count++;
+        index->dirty = true;
+    }
+    free_puzzle_list(names, name_count);
+
+    SDL_LockMutex(index->mutex);
+    for(int i = 0; i < index->entry_count; i++){
+
+        if(!reused[i]){
+
+            index_free_entry(index->entries[i]);
+            changed = true;
+            index->dirty = true;
+        }
+    }
+    free(index->entries);
+    index->entries = entries;
+    index->entry_count = entry_count;
+    index->entry_capacity = name_count + 64;
+    SDL_UnlockMutex(index->mutex);
+
+    free(reused);
+    index->scan_time = SDL_GetTicks();
+
+    return changed;
+}
+
+void index_load(PuzzleIndex* index){
+
+    FILE* file = fopen(index->path, "rb");
+    if(file == NULL){
+
+        return;
+    }
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char* bytes = (unsigned char*)malloc(file_size + 1);
+    bool read_ok = file_size > 0 && fread(bytes, 1, file_size, file) == (size_t)file_size;
+    fclose(file);
+
+    if(!read_ok || file_size < INDEX_HEADER_SIZE || memcmp(bytes, "DKPI", 4) != 0 || bytes[4] != PUZZLE_INDEX_VERSION){
+
+        free(bytes);
+        return;
+    }
+
+    long offset = INDEX_HEADER_SIZE;
+    while(offset + INDEX_RECORD_HEADER_SIZE <= file_size){
+
+        unsigned char* record = bytes + offset;
+        int name_length = read_uint_le(record, 2);
+        if(name_length == 0 || name_length > 255 || offset + INDEX_RECORD_HEADER_SIZE + name_length > file_size){
+
+            break;
+        }
+
+        PuzzleIndexEntry* entry = (PuzzleIndexEntry*)calloc(1, sizeof(PuzzleIndexEntry));
+        entry->name = (char*)malloc(name_length + 1);
+        memcpy(entry->name, record + INDEX_RECORD_HEADER_SIZE, name_length);
+        entry->name[name_length] = '\0';
+        entry->valid = (record[2] & 1) != 0;
+        entry->map_width = read_uint_le(record + 4, 2);
+        entry->map_height = read_uint_le(record + 6, 2);
+        entry->duckling_count = read_uint_le(record + 8, 2);
+        entry->bread_count = read_uint_le(record + 10, 2);
+        entry->goose_count = read_uint_le(record + 12, 2);
+        entry->size = (int64_t)read_uint_le(record + 16, 8);
+        entry->mtime = (int64_t)read_uint_le(record + 24, 8);
+        entry->content_hash = read_uint_le(record + 32, 8);
+        entry->puzzle_hash = read_uint_le(record + 40, 8);
+
+        if(index->entry_count == index->entry_capacity){
+
+            index->entry_capacity *= 2;
+            index->entries = (PuzzleIndexEntry**)realloc(index->entries, index->entry_capacity * sizeof(PuzzleIndexEntry*));
+        }
+        index->entries[index->entry_count] = entry;
+        index->entry_count++;
+        offset += INDEX_RECORD_HEADER_SIZE + name_length;
+    }
+    free(bytes);
+
+    // Written sorted, but a file from elsewhere might not be
+    qsort(index->entries, index->entry_count, sizeof(PuzzleIndexEntry*), index_compare_entries);
+}
+
+// Written to a temporary file and renamed over the old one, so a crash leaves the previous index
+void index_save(PuzzleIndex* index){
+
+    char temp_path[264];
+    sprintf(temp_path, "%s.tmp", index->path);
+    FILE* file = fopen(temp_path, "wb");
+    if(file == NULL){
+
+        printf("Unable to write puzzle index %s!\n", temp_path);
+        return;
+    }
+
+    unsigned char header[INDEX_HEADER_SIZE] = { 'D', 'K', 'P', 'I', PUZZLE_INDEX_VERSION, 0, 0, 0 };
+    bool success = fwrite(header, 1, INDEX_HEADER_SIZE, file) == INDEX_HEADER_SIZE;
+    for(int i = 0; i < index->entry_count && success; i++){
+
+        PuzzleIndexEntry* entry = index->entries[i];
+        int name_length = strlen(entry->name);
+        unsigned char record[INDEX_RECORD_HEADER_SIZE] = { 0 };
+        write_uint_le(record, name_length, 2);
+        record[2] = entry->valid ? 1 : 0;
+        write_uint_le(record + 4, entry->map_width, 2);
+        write_uint_le(record + 6, entry->map_height, 2);
+        write_uint_le(record + 8, entry->duckling_count, 2);
+        write_uint_le(record + 10, entry->bread_count, 2);
+        write_uint_le(record + 12, entry->goose_count, 2);
+        write_uint_le(record + 16, entry->size, 8);
+        write_uint_le(record + 24, entry->mtime, 8);
+        write_uint_le(record + 32, entry->content_hash, 8);
+        write_uint_le(record + 40, entry->puzzle_hash, 8);
+        success = fwrite(record, 1, INDEX_RECORD_HEADER_SIZE, file) == INDEX_RECORD_HEADER_SIZE && fwrite(entry->name, 1, name_length, file) == (size_t)name_length;
+    }
+    success = fclose(file) == 0 && success;
+
+    if(success){
+
+        // rename() won't replace an existing file on Windows
+        #ifdef _WIN32
+            remove(index->path);
+        #endif
+        rename(temp_path, index->path);
+        index->dirty = false;
+
+    }else{
+
+        printf("Unable to write puzzle index %s!\n", temp_path);
+        remove(temp_path);
+    }
+}
+
+int index_opener(void* data){
+
+    PuzzleIndex* index = (PuzzleIndex*)data;
+
+    // Watching starts before the folder is compared, so nothing saved in between is missed
+    #ifdef __linux__
+        index->watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if(index->watch_fd >= 0 && inotify_add_watch(index->watch_fd, "./puzzles", IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0){
+
+            close(index->watch_fd);
+            index->watch_fd = -1;
+        }
+    #endif
+
+    index_load(index);
+    index_scan(index);
+    if(index->dirty){
+
+        index_save(index);
+    }
+
+    // SDL_AtomicSet is a full barrier, so whoever sees ready also sees everything above
+    SDL_AtomicSet(&index->ready, 1);
+
+    return 0;
+}
+
+// Waits for the opener if it is still running, on the main thread only
+void index_join(PuzzleIndex* index){
+
+    if(index->opener != NULL){
+
+        SDL_WaitThread(index->opener, NULL);
+        index->opener = NULL;
+    }
+}
+
+bool puzzle_index_open(char* path){
+
+    if(puzzle_index != NULL){
+
+        return true;
+    }
+
+    puzzle_index = (PuzzleIndex*)calloc(1, sizeof(PuzzleIndex));
+    strncpy(puzzle_index->path, path, 255);
+    puzzle_index->mutex = SDL_CreateMutex();
+    puzzle_index->entry_capacity = 64;
+    puzzle_index->entries = (PuzzleIndexEntry**)malloc(puzzle_index->entry_capacity * sizeof(PuzzleIndexEntry*));
+    puzzle_index->watch_fd = -1;
+    SDL_AtomicSet(&puzzle_index->ready, 0);
+
+    puzzle_index->opener = SDL_CreateThread(index_opener, "puzzle index", puzzle_index);
+    if(puzzle_index->opener == NULL){
+
+        // Nothing to hand it to, it is opened now
+        printf("Unable to start puzzle index opener! SDL Error: %s\n", SDL_GetError());
+        index_opener(puzzle_index);
+    }
+
+    return true;
+}
+
+void puzzle_index_close(){
+
+    if(puzzle_index == NULL){
+
+        return;
+    }
+
+    index_join(puzzle_index);
+    if(puzzle_index->dirty){
+
+        index_save(puzzle_index);
+    }
+    #ifdef __linux__
+        if(puzzle_index->watch_fd >= 0){
+
+            close(puzzle_index->watch_fd);
+        }
+    #endif
+
+    for(int i = 0; i < puzzle_index->entry_count; i++){
+
+        index_free_entry(puzzle_index->entries[i]);
+    }
+    free(puzzle_index->entries);
+    SDL_DestroyMutex(puzzle_index->mutex);
+    free(puzzle_index);
+    puzzle_index = NULL;
+}
+
+bool puzzle_index_poll(){
+
+    if(puzzle_index == NULL || SDL_AtomicGet(&puzzle_index->ready) == 0){
+
+        return false;
+    }
+
+    // Lists made from the folder while the index was opening are made again from it
+    bool changed = false;
+    if(puzzle_index->opener != NULL){
+
+        index_join(puzzle_index);
+        changed = true;
+    }
+
+    if(puzzle_index->watch_fd < 0){
+
+        if(SDL_GetTicks() - puzzle_index->scan_time < PUZZLE_INDEX_RESCAN_MS){
+
+            return changed;
+        }
+        return index_scan(puzzle_index) || changed;
+    }
+
+    #ifdef __linux__
+        // Aligned for the event structs, as inotify(7) asks
+        char buffer[INDEX_EVENT_BUFFER_SIZE] __attribute__((aligned(__alignof__(struct inotify_event))));
+        ssize_t length;
+        while((length = read(puzzle_index->watch_fd, buffer, sizeof(buffer))) > 0){
+
+            for(char* pointer = buffer; pointer < buffer + length; pointer += sizeof(struct inotify_event) + ((struct inotify_event*)pointer)->len){
+
+                struct inotify_event* event = (struct inotify_event*)pointer;
+                if(event->mask & IN_Q_OVERFLOW){
+
+                    // Events were dropped, only the folder itself can say what happened
+                    changed = index_scan(puzzle_index) || changed;
+
+                }else if(event->len > 0){
+
+                    changed = index_update(puzzle_index, event->name) || changed;
+                }
+            }
+        }
+    #endif
+
+    return changed;
+}
+
+void puzzle_index_update(char* puzzle_filename){
+
+    if(puzzle_index != NULL){
+
+        index_join(puzzle_index);
+        index_update(puzzle_index, puzzle_filename);
+    }
+}
+
+bool puzzle_index_find(char* puzzle_filename, PuzzleIndexEntry* entry){
+
+    if(puzzle_index == NULL || SDL_AtomicGet(&puzzle_index->ready) == 0){
+
+        return false;
+    }
+
+    SDL_LockMutex(puzzle_index->mutex);
+    bool found;
+    int position = index_search(puzzle_index, puzzle_filename, &found);
+    if(found){
+
+        *entry = *puzzle_index->entries[position];
+        entry->name = NULL;
+    }
+    SDL_UnlockMutex(puzzle_index->mutex);
+
+    return found;
+}
+
+char** puzzle_index_names(int* puzzle_count){
+
+    *puzzle_count = 0;
+    if(puzzle_index == NULL || SDL_AtomicGet(&puzzle_index->ready) == 0 || puzzle_index->entry_count == 0){
+
+        return NULL;
+    }
+
+    char** names = (char**)malloc(puzzle_index->entry_count * sizeof(char*));
+    for(int i = 0; i < puzzle_index->entry_count; i++){
+
+        names[i] = (char*)malloc(strlen(puzzle_index->entries[i]->name) + 1);
+        strcpy(names[i], puzzle_index->entries[i]->name);
+    }
+    *puzzle_count = puzzle_index->entry_count;
+
+    return names;
+}
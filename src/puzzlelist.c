@@ -0,0 +1,238 @@
+#include "puzzlelist.h"
+#include "solutiondb.h"
+#include "puzzleindex.h"
+
+int puzzle_list_compare(const void* a, const void* b){
+
+    return SDL_strcasecmp(*(char**)a, *(char**)b);
+}
+
+// The first of the sorted files that doesn't come before the prefix, or after it if past is set
+int puzzle_list_bound(PuzzleList* list, char* prefix, int prefix_length, bool past){
+
+    int low = 0;
+    int high = list->count;
+    while(low < high){
+
+        int middle = low + ((high - low) / 2);
+        int compare = SDL_strncasecmp(list->files[middle], prefix, prefix_length);
+        if(compare < 0 || (past && compare == 0)){
+
+            low = middle + 1;
+
+        }else{
+
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+void puzzle_list_load_metadata(PuzzleList* list, int index){
+
+    // The index already knows everything but the best length, which is a lookup by its hash
+    PuzzleIndexEntry entry;
+    if(!puzzle_index_find(list->files[index], &entry)){
+
+        State* initial_state = get_from_file(list->files[index]);
+        entry.valid = initial_state != NULL;
+        if(entry.valid){
+
+            entry.map_width = initial_state->map_width;
+            entry.map_height = initial_state->map_height;
+            entry.duckling_count = get_duckling_count(initial_state);
+            entry.bread_count = get_bread_count(initial_state);
+            entry.goose_count = get_goose_count(initial_state);
+            entry.puzzle_hash = get_puzzle_hash(initial_state);
+            free(initial_state);
+        }
+    }
+    if(!entry.valid){
+
+        SDL_AtomicSet(&list->metadata_status[index], PUZZLE_METADATA_FAILED);
+        return;
+    }
+
+    PuzzleMetadata* metadata = &list->metadata[index];
+    metadata->map_width = entry.map_width;
+    metadata->map_height = entry.map_height;
+    metadata->duckling_count = entry.duckling_count;
+    metadata->bread_count = entry.bread_count;
+    metadata->goose_count = entry.goose_count;
+
+    metadata->best_length = solution_db_best_length(entry.puzzle_hash);
+
+    // SDL_AtomicSet is a full barrier, so whoever sees the status also sees the metadata
+    SDL_AtomicSet(&list->metadata_status[index], PUZZLE_METADATA_READY);
+}
+
+int puzzle_list_loader(void* data){
+
+    PuzzleList* list = (PuzzleList*)data;
+
+    while(SDL_AtomicGet(&list->quit) == 0){
+
+        // The window is only ever a screen or two long, so looking through it again after each file is cheap
+        int first = SDL_AtomicGet(&list->window_first);
+        int last = SDL_AtomicGet(&list->window_last);
+        int index = first;
+        while(index < last && SDL_AtomicGet(&list->metadata_status[index]) != PUZZLE_METADATA_PENDING){
+
+            index++;
+        }
+
+        if(index < last){
+
+            puzzle_list_load_metadata(list, index);
+
+        }else{
+
+            SDL_SemWait(list->wake);
+        }
+    }
+
+    return 0;
+}
+
+void puzzle_list_load(PuzzleList* list){
+
+    // The index has the folder listed already, listing it again is only for when it isn't open
+    list->files = puzzle_index_names(&list->count);
+    if(list->files == NULL){
+
+        list->files = generate_puzzle_list(&list->count);
+    }
+    if(list->files == NULL){
+
+        list->count = 0;
+    }
+    qsort(list->files, list->count, sizeof(char*), puzzle_list_compare);
+
+    list->search[0] = '\0';
+    list->search_length = 0;
+    list->match_first = 0;
+    list->match_count = list->count;
+    list->scroll = 0;
+
+    list->metadata = (PuzzleMetadata*)malloc((list->count + 1) * sizeof(PuzzleMetadata));
+    list->metadata_status = (SDL_atomic_t*)calloc(list->count + 1, sizeof(SDL_atomic_t));
+    SDL_AtomicSet(&list->window_first, 0);
+    SDL_AtomicSet(&list->window_last, 0);
+    SDL_AtomicSet(&list->quit, 0);
+    list->wake = SDL_CreateSemaphore(0);
+    list->loader = SDL_CreateThread(puzzle_list_loader, "puzzle list", list);
+    if(list->loader == NULL){
+
+        printf("Unable to start puzzle list loader! SDL Error: %s\n", SDL_GetError());
+    }
+
+    for(int i = 0; i < PUZZLE_LIST_ROW_CACHE; i++){
+
+        list->rows[i].index = -1;
+        list->rows[i].name = NULL;
+        list->rows[i].details = NULL;
+    }
+}
+
+void puzzle_list_free(PuzzleList* list){
+
+    SDL_AtomicSet(&list->quit, 1);
+    SDL_SemPost(list->wake);
+    if(list->loader != NULL){
+
+        SDL_WaitThread(list->loader, NULL);
+    }
+    SDL_DestroySemaphore(list->wake);
+
+    for(int i = 0; i < PUZZLE_LIST_ROW_CACHE; i++){
+
+        if(list->rows[i].name != NULL){
+
+            SDL_DestroyTexture(list->rows[i].name);
+        }
+        if(list->rows[i].details != NULL){
+
+            SDL_DestroyTexture(list->rows[i].details);
+        }
+    }
+
+    free_puzzle_list(list->files, list->count);
+    free(list->metadata);
+    free(list->metadata_status);
+    list->files = NULL;
+    list->count = 0;
+    list->match_count = 0;
+}
+
+void puzzle_list_search(PuzzleList* list){
+
+    list->match_first = puzzle_list_bound(list, list->search, list->search_length, false);
+    list->match_count = puzzle_list_bound(list, list->search, list->search_length, true) - list->match_first;
+    list->scroll = 0;
+}
+
+void puzzle_list_scroll_to(PuzzleList* list, int match, int visible_rows){
+
+    if(match < list->scroll){
+
+        list->scroll = match;
+
+    }else if(match >= list->scroll + visible_rows){
+
+        list->scroll = match - visible_rows + 1;
+    }
+    if(list->scroll > list->match_count - visible_rows){
+
+        list->scroll = list->match_count - visible_rows;
+    }
+    if(list->scroll < 0){
+
+        list->scroll = 0;
+    }
+}
+
+void puzzle_list_request(PuzzleList* list, int first, int last){
+
+    first = first < 0 ? 0 : first;
+    last = last > list->count ? list->count : last;
+    if(first == SDL_AtomicGet(&list->window_first) && last == SDL_AtomicGet(&list->window_last)){
+
+        return;
+    }
+
+    SDL_AtomicSet(&list->window_first, first);
+    SDL_AtomicSet(&list->window_last, last);
+    SDL_SemPost(list->wake);
+}
+
+PuzzleMetadata* puzzle_list_metadata(PuzzleList* list, int index){
+
+    if(index < 0 || index >= list->count || SDL_AtomicGet(&list->metadata_status[index]) != PUZZLE_METADATA_READY){
+
+        return NULL;
+    }
+
+    return &list->metadata[index];
+}
+
+PuzzleListRow* puzzle_list_row(PuzzleList* list, int index){
+
+    PuzzleListRow* row = &list->rows[index % PUZZLE_LIST_ROW_CACHE];
+    if(row->index != index){
+
+        if(row->name != NULL){
+
+            SDL_DestroyTexture(row->name);
+            row->name = NULL;
+        }
+        if(row->details != NULL){
+
+            SDL_DestroyTexture(row->details);
+            row->details = NULL;
+        }
+        row->index = index;
+    }
+
+    return row;
+}
@@ -0,0 +1,404 @@
+#include "replay.h"
+#include "solutiondb.h"
+#include <SDL2/SDL.h>
+#include <time.h>
+#ifdef _WIN32
+    #include <direct.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+typedef struct PuzzleEntry{
+
+    uint64_t hash;
+    State* initial_state;
+} PuzzleEntry;
+
+typedef struct VerifyJob{
+
+    char** paths;
+    int path_count;
+    int* verdicts;
+    long* move_counts;
+    int* optimal; // 1 or 0 for valid wins against a known solution, -1 otherwise
+    PuzzleEntry* puzzles;
+    int puzzle_count;
+    SDL_atomic_t next_path;
+} VerifyJob;
+
+void replay_begin(Replay* replay, State* initial_state){
+
+    replay->puzzle_hash = get_puzzle_hash(initial_state);
+    replay->victory = 0;
+    replay->move_count = 0;
+    replay->move_capacity = 256;
+    replay->packed_moves = (unsigned char*)calloc(replay->move_capacity / 2, 1);
+}
+
+void replay_record(Replay* replay, int player_move){
+
+    if(replay->move_count == replay->move_capacity){
+
+        replay->move_capacity = replay->move_capacity < 256 ? 256 : replay->move_capacity * 2;
+        replay->packed_moves = (unsigned char*)realloc(replay->packed_moves, replay->move_capacity / 2);
+        memset(replay->packed_moves + (replay->move_count / 2), 0, (replay->move_capacity - replay->move_count) / 2);
+    }
+
+    int byte_index = replay->move_count / 2;
+    if(replay->move_count % 2 == 0){
+
+        replay->packed_moves[byte_index] = player_move & 0x0F;
+
+    }else{
+
+        replay->packed_moves[byte_index] |= (player_move & 0x0F) << 4;
+    }
+    replay->move_count++;
+}
+
+int replay_get_move(Replay* replay, int index){
+
+    unsigned char packed = replay->packed_moves[index / 2];
+    if(index % 2 == 0){
+
+        return packed & 0x0F;
+    }
+
+    return packed >> 4;
+}
+
+void replay_free(Replay* replay){
+
+    free(replay->packed_moves);
+    replay->packed_moves = NULL;
+    replay->move_count = 0;
+    replay->move_capacity = 0;
+}
+
+bool replay_save(Replay* replay, char* path){
+
+    FILE* file = fopen(path, "wb");
+    if(file == NULL){
+
+        printf("Unable to save replay %s!\n", path);
+        return false;
+    }
+
+    unsigned char header[20] = { 'D', 'K', 'R', 'P', REPLAY_VERSION, (unsigned char)(signed char)replay->victory, 0, 0 };
+    for(int i = 0; i < 8; i++){
+
+        header[8 + i] = (replay->puzzle_hash >> (i * 8)) & 0xFF;
+    }
+    for(int i = 0; i < 4; i++){
+
+        header[16 + i] = ((unsigned int)replay->move_count >> (i * 8)) & 0xFF;
+    }
+
+    bool success = fwrite(header, 1, 20, file) == 20;
+    int packed_size = (replay->move_count + 1) / 2;
+    if(success && packed_size != 0){
+
+        success = fwrite(replay->packed_moves, 1, packed_size, file) == (size_t)packed_size;
+    }
+    fclose(file);
+
+    return success;
+}
+
+bool replay_load(Replay* replay, char* path){
+
+    replay->packed_moves = NULL;
+    replay->move_count = 0;
+    replay->move_capacity = 0;
+
+    FILE* file = fopen(path, "rb");
+    if(file == NULL){
+
+        return false;
+    }
+
+    unsigned char header[20];
+    if(fread(header, 1, 20, file) != 20 || memcmp(header, "DKRP", 4) != 0 || header[4] != REPLAY_VERSION){
+
+        fclose(file);
+        return false;
+    }
+
+    replay->victory = (signed char)header[5];
+    replay->puzzle_hash = 0;
+    for(int i = 0; i < 8; i++){
+
+        replay->puzzle_hash |= (uint64_t)header[8 + i] << (i * 8);
+    }
+    unsigned int move_count = 0;
+    for(int i = 0; i < 4; i++){
+
+        move_count |= (unsigned int)header[16 + i] << (i * 8);
+    }
+    // The header is untrusted, so nothing is allocated for moves the file doesn't actually hold
+    long header_end = ftell(file);
+    fseek(file, 0, SEEK_END);
+    long remaining = ftell(file) - header_end;
+    fseek(file, header_end, SEEK_SET);
+    if(move_count > 0x7FFFFFFE || header_end < 0 || remaining < (long)((move_count + 1) / 2)){
+
+        fclose(file);
+        return false;
+    }
+
+    int packed_size = (move_count + 1) / 2;
+    replay->move_count = move_count;
+    replay->move_capacity = packed_size * 2;
+    replay->packed_moves = (unsigned char*)malloc(packed_size + 1);
+    bool success = fread(replay->packed_moves, 1, packed_size, file) == (size_t)packed_size;
+    fclose(file);
+
+    if(!success){
+
+        replay_free(replay);
+    }
+
+    return success;
+}
+
+bool replay_save_session(Replay* replay, char* puzzle_filename){
+
+    #ifdef _WIN32
+        _mkdir("./replays");
+    #else
+        mkdir("./replays", 0755);
+    #endif
+
+    char puzzle_name[64];
+    strncpy(puzzle_name, puzzle_filename, 63);
+    puzzle_name[63] = '\0';
+    char* extension = strstr(puzzle_name, ".duck");
+    if(extension != NULL){
+
+        *extension = '\0';
+    }
+
+    // Sessions of one puzzle can end within the same second, a restart and quit for one, so the later ones get a sequence number
+    char path[256];
+    long save_time = (long)time(NULL);
+    for(int sequence = 1; sequence <= REPLAY_MAX_SEQUENCE; sequence++){
+
+        if(sequence == 1){
+
+            sprintf(path, "./replays/%s_%li.replay", puzzle_name, save_time);
+
+        }else{
+
+            sprintf(path, "./replays/%s_%li_%i.replay", puzzle_name, save_time, sequence);
+        }
+
+        FILE* existing = fopen(path, "rb");
+        if(existing == NULL){
+
+            return replay_save(replay, path);
+        }
+        fclose(existing);
+    }
+
+    printf("Unable to save replay, too many for %s this second!\n", puzzle_name);
+    return false;
+}
+
+/*
+ * Plays a replay from initial_state and returns the final victory, or -2 if it contains a move game_loop
+ * wouldn't have made. final_length gets the number of moves left standing once undos are taken out.
+ */
+int replay_run(Replay* replay, State* initial_state, int* final_length){
+
+    State* current_state = (State*)malloc(sizeof(State));
+    *current_state = *initial_state;
+    current_state->previous_state = NULL;
+
+    bool valid = true;
+    for(int i = 0; i < replay->move_count && valid; i++){
+
+        int player_move = replay_get_move(replay, i);
+        if(player_move == REPLAY_RESTART){
+
+            valid = current_state->victory == -1;
+            while(current_state->previous_state != NULL){
+
+                current_state = undo_move(current_state);
+            }
+
+        }else if(player_move == PLAYER_MOVE_UNDO){
+
+            // Scrubbing the timeline back is allowed after the game has ended
+            current_state = undo_move(current_state);
+
+        }else if(current_state->victory != 0 || player_move < PLAYER_MOVE_UP || player_move > PLAYER_MOVE_WAIT){
+
+            valid = false;
+
+        }else{
+
+            handle_move(current_state, player_move);
+        }
+    }
+
+    int victory = valid ? current_state->victory : -2;
+
+    *final_length = 0;
+    while(current_state->previous_state != NULL){
+
+        current_state = undo_move(current_state);
+        (*final_length)++;
+    }
+    free(current_state);
+
+    return victory;
+}
+
+int compare_puzzle_entries(const void* a, const void* b){
+
+    uint64_t hash_a = ((PuzzleEntry*)a)->hash;
+    uint64_t hash_b = ((PuzzleEntry*)b)->hash;
+
+    return hash_a < hash_b ? -1 : (hash_a > hash_b ? 1 : 0);
+}
+
+int replay_verify_thread(void* data){
+
+    VerifyJob* job = (VerifyJob*)data;
+
+    while(true){
+
+        int index = SDL_AtomicAdd(&job->next_path, 1);
+        if(index >= job->path_count){
+
+            break;
+        }
+
+        job->verdicts[index] = -1;
+        job->move_counts[index] = 0;
+        job->optimal[index] = -1;
+
+        Replay replay;
+        if(!replay_load(&replay, job->paths[index])){
+
+            continue;
+        }
+
+        PuzzleEntry key = { .hash = replay.puzzle_hash, .initial_state = NULL };
+        PuzzleEntry* puzzle = (PuzzleEntry*)bsearch(&key, job->puzzles, job->puzzle_count, sizeof(PuzzleEntry), compare_puzzle_entries);
+        if(puzzle != NULL){
+
+            int final_length;
+            int victory = replay_run(&replay, puzzle->initial_state, &final_length);
+            if(victory != -2){
+
+                job->verdicts[index] = victory == replay.victory ? 1 : 0;
+            }
+
+            SolutionRecord record;
+            if(victory == 1 && job->verdicts[index] == 1 && solution_db_lookup(puzzle->hash, &record) && record.solvable){
+
+                job->optimal[index] = final_length <= record.move_count ? 1 : 0;
+            }
+            job->move_counts[index] = replay.move_count;
+        }
+
+        replay_free(&replay);
+    }
+
+    return 0;
+}
+
+void replay_verify_files(char** paths, int path_count, int thread_count, int* verdicts, ReplayVerifyResult* result){
+
+    Uint64 start_time = SDL_GetPerformanceCounter();
+
+    // Index the puzzle library by content hash
+    int puzzle_count = 0;
+    char** puzzle_files = generate_puzzle_list(&puzzle_count);
+    PuzzleEntry* puzzles = (PuzzleEntry*)malloc((puzzle_count + 1) * sizeof(PuzzleEntry));
+    int loaded_count = 0;
+    for(int i = 0; i < puzzle_count; i++){
+
+        State* initial_state = get_from_file(puzzle_files[i]);
+        if(initial_state != NULL){
+
+            puzzles[loaded_count].hash = get_puzzle_hash(initial_state);
+            puzzles[loaded_count].initial_state = initial_state;
+            loaded_count++;
+        }
+        free(puzzle_files[i]);
+    }
+    free(puzzle_files);
+    qsort(puzzles, loaded_count, sizeof(PuzzleEntry), compare_puzzle_entries);
+
+    VerifyJob job;
+    job.paths = paths;
+    job.path_count = path_count;
+    job.verdicts = verdicts != NULL ? verdicts : (int*)malloc(path_count * sizeof(int));
+    job.move_counts = (long*)malloc(path_count * sizeof(long));
+    job.optimal = (int*)malloc(path_count * sizeof(int));
+    job.puzzles = puzzles;
+    job.puzzle_count = loaded_count;
+    SDL_AtomicSet(&job.next_path, 0);
+
+    if(thread_count < 1){
+
+        thread_count = 1;
+    }
+    SDL_Thread** threads = (SDL_Thread**)malloc(thread_count * sizeof(SDL_Thread*));
+    for(int i = 1; i < thread_count; i++){
+
+        threads[i] = SDL_CreateThread(replay_verify_thread, "verify", &job);
+    }
+    replay_verify_thread(&job);
+    for(int i = 1; i < thread_count; i++){
+
+        SDL_WaitThread(threads[i], NULL);
+    }
+    free(threads);
+
+    result->replay_count = path_count;
+    result->valid_count = 0;
+    result->mismatch_count = 0;
+    result->invalid_count = 0;
+    result->move_count = 0;
+    result->known_win_count = 0;
+    result->optimal_win_count = 0;
+    for(int i = 0; i < path_count; i++){
+
+        if(job.optimal[i] != -1){
+
+            result->known_win_count++;
+            result->optimal_win_count += job.optimal[i];
+        }
+
+        if(job.verdicts[i] == 1){
+
+            result->valid_count++;
+
+        }else if(job.verdicts[i] == 0){
+
+            result->mismatch_count++;
+
+        }else{
+
+            result->invalid_count++;
+        }
+        result->move_count += job.move_counts[i];
+    }
+
+    if(verdicts == NULL){
+
+        free(job.verdicts);
+    }
+    free(job.move_counts);
+    free(job.optimal);
+    for(int i = 0; i < loaded_count; i++){
+
+        free(puzzles[i].initial_state);
+    }
+    free(puzzles);
+
+    result->seconds = (SDL_GetPerformanceCounter() - start_time) / (double)SDL_GetPerformanceFrequency();
+}
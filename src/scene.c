@@ -0,0 +1,136 @@
+#include "scene.h"
+#include "animation.h"
+
+void scene_placeholder(SceneTarget* target, int x, int y, int size){
+
+    if(target->framebuffer != NULL){
+
+        framebuffer_fill_rect(target->framebuffer, x, y, size, size, SCENE_PLACEHOLDER_COLOR);
+        return;
+    }
+
+    Uint8 r, g, b, a;
+    SDL_GetRenderDrawColor(target->renderer, &r, &g, &b, &a);
+    SDL_SetRenderDrawColor(target->renderer, (SCENE_PLACEHOLDER_COLOR >> 16) & 0xFF, (SCENE_PLACEHOLDER_COLOR >> 8) & 0xFF, SCENE_PLACEHOLDER_COLOR & 0xFF, 255);
+    SDL_Rect dest_rect = (SDL_Rect){ .x = x, .y = y, .w = size, .h = size };
+    SDL_RenderFillRect(target->renderer, &dest_rect);
+    SDL_SetRenderDrawColor(target->renderer, r, g, b, a);
+}
+
+void scene_draw(SceneTarget* target, int sprite, int x, int y, int size, bool flipped){
+
+    if(target->framebuffer != NULL){
+
+        BlitSprite* blit_sprite = target->sprites[sprite];
+        if(blit_sprite == NULL || blit_sprite->pixels == NULL){
+
+            scene_placeholder(target, x, y, size);
+            return;
+        }
+        framebuffer_blit(target->framebuffer, blit_sprite, x, y, size, flipped);
+        return;
+    }
+
+    AssetImage* image = target->images[sprite];
+    if(image == NULL || image->texture == NULL){
+
+        scene_placeholder(target, x, y, size);
+        return;
+    }
+
+    SDL_Rect source_rect = (SDL_Rect){ .x = 0, .y = 0, .w = image->width, .h = image->height };
+    SDL_Rect dest_rect = (SDL_Rect){ .x = x, .y = y, .w = size, .h = size };
+    if(flipped){
+
+        SDL_RenderCopyEx(target->renderer, image->texture, &source_rect, &dest_rect, 0, NULL, SDL_FLIP_HORIZONTAL);
+
+    }else{
+
+        SDL_RenderCopy(target->renderer, image->texture, &source_rect, &dest_rect);
+    }
+}
+
+void scene_draw_facing(SceneTarget* target, int first_sprite, int direction, int x, int y, int size){
+
+    if(direction == 0){
+
+        scene_draw(target, first_sprite, x, y, size, false);
+
+    }else if(direction == 1){
+
+        scene_draw(target, first_sprite + 1, x, y, size, false);
+
+    }else if(direction == 2){
+
+        scene_draw(target, first_sprite + 2, x, y, size, false);
+
+    }else if(direction == 3){
+
+        scene_draw(target, first_sprite + 1, x, y, size, true);
+    }
+}
+
+void render_scene(SceneTarget* target, State* from, State* to, int blend, Camera* camera){
+
+    int left, top, right, bottom;
+    camera_visible_squares(camera, to, &left, &top, &right, &bottom);
+    int size = camera->tile_size;
+    int x, y;
+
+    if(target->framebuffer != NULL){
+
+        framebuffer_clear(target->framebuffer, 0xFF000000);
+    }
+
+    for(int i = left; i < right; i++){
+
+        for(int j = top; j < bottom; j++){
+
+            camera_square_to_screen(camera, i, j, &x, &y);
+            scene_draw(target, SCENE_GRASS, x, y, size, false);
+        }
+    }
+
+    if(blend_position(camera, from->player_x, from->player_y, to->player_x, to->player_y, blend, &x, &y)){
+
+        scene_draw_facing(target, SCENE_DUCK, to->player_direction, x, y, size);
+    }
+
+    for(int i = 0; i < MAX_DUCK_COUNT; i++){
+
+        if(blend_position(camera, from->duckling_x[i], from->duckling_y[i], to->duckling_x[i], to->duckling_y[i], blend, &x, &y)){
+
+            scene_draw_facing(target, SCENE_DUCKLING, to->duckling_direction[i], x, y, size);
+        }
+    }
+
+    for(int i = 0; i < MAX_BREAD_COUNT; i++){
+
+        if(blend_position(camera, from->bread_x[i], from->bread_y[i], to->bread_x[i], to->bread_y[i], blend, &x, &y)){
+
+            scene_draw(target, SCENE_BREAD, x, y, size, false);
+        }
+    }
+
+    // Geese stand on a blue square
+    if(target->framebuffer == NULL){
+
+        SDL_SetRenderDrawColor(target->renderer, 0, 0, 255, 255);
+    }
+    for(int i = 0; i < MAX_GOOSE_COUNT; i++){
+
+        if(blend_position(camera, from->goose_x[i], from->goose_y[i], to->goose_x[i], to->goose_y[i], blend, &x, &y)){
+
+            if(target->framebuffer != NULL){
+
+                framebuffer_fill_rect(target->framebuffer, x, y, size, size, 0xFF0000FF);
+
+            }else{
+
+                SDL_Rect goose_rect = (SDL_Rect){ .x = x, .y = y, .w = size, .h = size };
+                SDL_RenderFillRect(target->renderer, &goose_rect);
+            }
+            scene_draw_facing(target, SCENE_GOOSE, to->goose_direction[i], x, y, size);
+        }
+    }
+}
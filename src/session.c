@@ -0,0 +1,430 @@
+#include "session.h"
+#include <SDL2/SDL.h>
+#ifdef _WIN32
+    #include <direct.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+#define SESSION_HEADER_SIZE 32
+
+typedef struct SessionWrite{
+
+    char path[256];
+    unsigned char* data; // NULL removes the file instead
+    long size;
+    struct SessionWrite* next;
+} SessionWrite;
+
+SDL_Thread* session_writer = NULL;
+SDL_mutex* session_mutex = NULL;
+SDL_cond* session_cond = NULL;
+SDL_cond* session_idle = NULL; // broadcast whenever the writer finishes one
+bool session_writing = false;
+SessionWrite* session_queue_head = NULL;
+SessionWrite* session_queue_tail = NULL;
+bool session_quit = false;
+
+void write_int16(unsigned char** cursor, int value){
+
+    (*cursor)[0] = value & 0xFF;
+    (*cursor)[1] = (value >> 8) & 0xFF;
+    *cursor += 2;
+}
+
+int read_int16(unsigned char** cursor){
+
+    int value = (short)((*cursor)[0] | ((*cursor)[1] << 8));
+    *cursor += 2;
+
+    return value;
+}
+
+void write_int32(unsigned char* bytes, int value){
+
+    for(int i = 0; i < 4; i++){
+
+        bytes[i] = ((unsigned int)value >> (i * 8)) & 0xFF;
+    }
+}
+
+int read_int32(unsigned char* bytes){
+
+    unsigned int value = 0;
+    for(int i = 0; i < 4; i++){
+
+        value |= (unsigned int)bytes[i] << (i * 8);
+    }
+
+    return (int)value;
+}
+
+void state_encode(State* current_state, unsigned char* record){
+
+    unsigned char* cursor = record;
+
+    write_int16(&cursor, current_state->victory);
+    write_int16(&cursor, current_state->required_bread);
+    write_int16(&cursor, current_state->player_x);
+    write_int16(&cursor, current_state->player_y);
+    write_int16(&cursor, current_state->player_direction);
+    write_int16(&cursor, current_state->player_last_duckling);
+    write_int16(&cursor, current_state->player_bread_count);
+    write_int16(&cursor, current_state->map_width);
+    write_int16(&cursor, current_state->map_height);
+
+    for(int i = 0; i < MAX_DUCK_COUNT; i++){
+
+        write_int16(&cursor, current_state->duckling_x[i]);
+        write_int16(&cursor, current_state->duckling_y[i]);
+        write_int16(&cursor, current_state->duckling_follows[i]);
+        write_int16(&cursor, current_state->duckling_direction[i]);
+        *cursor = current_state->duckling_waddles[i] | (current_state->duckling_holds_bread[i] << 1);
+        cursor++;
+    }
+
+    for(int i = 0; i < MAX_BREAD_COUNT; i++){
+
+        write_int16(&cursor, current_state->bread_x[i]);
+        write_int16(&cursor, current_state->bread_y[i]);
+    }
+
+    for(int i = 0; i < MAX_GOOSE_COUNT; i++){
+
+        write_int16(&cursor, current_state->goose_x[i]);
+        write_int16(&cursor, current_state->goose_y[i]);
+        write_int16(&cursor, current_state->goose_direction[i]);
+    }
+}
+
+void state_decode(unsigned char* record, State* current_state){
+
+    unsigned char* cursor = record;
+
+    current_state->victory = read_int16(&cursor);
+    current_state->required_bread = read_int16(&cursor);
+    current_state->player_x = read_int16(&cursor);
+    current_state->player_y = read_int16(&cursor);
+    current_state->player_direction = read_int16(&cursor);
+    current_state->player_last_duckling = read_int16(&cursor);
+    current_state->player_bread_count = read_int16(&cursor);
+    current_state->map_width = read_int16(&cursor);
+    current_state->map_height = read_int16(&cursor);
+
+    for(int i = 0; i < MAX_DUCK_COUNT; i++){
+
+        current_state->duckling_x[i] = read_int16(&cursor);
+        current_state->duckling_y[i] = read_int16(&cursor);
+        current_state->duckling_follows[i] = read_int16(&cursor);
+        current_state->duckling_direction[i] = read_int16(&cursor);
+        current_state->duckling_waddles[i] = (*cursor & 1) != 0;
+        current_state->duckling_holds_bread[i] = (*cursor & 2) != 0;
+        cursor++;
+    }
+
+    for(int i = 0; i < MAX_BREAD_COUNT; i++){
+
+        current_state->bread_x[i] = read_int16(&cursor);
+        current_state->bread_y[i] = read_int16(&cursor);
+    }
+
+    for(int i = 0; i < MAX_GOOSE_COUNT; i++){
+
+        current_state->goose_x[i] = read_int16(&cursor);
+        current_state->goose_y[i] = read_int16(&cursor);
+        current_state->goose_direction[i] = read_int16(&cursor);
+    }
+
+    current_state->previous_state = NULL;
+}
+
+void get_session_path(char* puzzle_filename, char* path){
+
+    char puzzle_name[64];
+    strncpy(puzzle_name, puzzle_filename, 63);
+    puzzle_name[63] = '\0';
+    char* extension = strstr(puzzle_name, ".duck");
+    if(extension != NULL){
+
+        *extension = '\0';
+    }
+
+    sprintf(path, "./sessions/%s.session", puzzle_name);
+}
+
+int session_writer_thread(void* data){
+
+    while(true){
+
+        SDL_LockMutex(session_mutex);
+        while(session_queue_head == NULL && !session_quit){
+
+            SDL_CondWait(session_cond, session_mutex);
+        }
+        SessionWrite* write = session_queue_head;
+        if(write != NULL){
+
+            session_queue_head = write->next;
+            if(session_queue_head == NULL){
+
+                session_queue_tail = NULL;
+            }
+            session_writing = true;
+        }
+        SDL_UnlockMutex(session_mutex);
+
+        // The queue is only empty here once we've been asked to quit
+        if(write == NULL){
+
+            break;
+        }
+
+        if(write->data == NULL){
+
+            remove(write->path);
+
+        }else{
+
+            #ifdef _WIN32
+                _mkdir("./sessions");
+            #else
+                mkdir("./sessions", 0755);
+            #endif
+
+            char temp_path[264];
+            sprintf(temp_path, "%s.tmp", write->path);
+            FILE* file = fopen(temp_path, "wb");
+            if(file == NULL){
+
+                printf("Unable to save session %s!\n", write->path);
+
+            }else{
+
+                bool success = fwrite(write->data, 1, write->size, file) == (size_t)write->size;
+                success = fclose(file) == 0 && success;
+
+                if(success){
+
+                    // rename() won't replace an existing file on Windows
+                    #ifdef _WIN32
+                        remove(write->path);
+                    #endif
+                    rename(temp_path, write->path);
+
+                }else{
+
+                    printf("Unable to save session %s!\n", write->path);
+                    remove(temp_path);
+                }
+            }
+        }
+
+        free(write->data);
+        free(write);
+
+        SDL_LockMutex(session_mutex);
+        session_writing = false;
+        SDL_CondBroadcast(session_idle);
+        SDL_UnlockMutex(session_mutex);
+    }
+
+    return 0;
+}
+
+void session_queue_write(SessionWrite* write){
+
+    if(session_writer == NULL){
+
+        session_mutex = SDL_CreateMutex();
+        session_cond = SDL_CreateCond();
+        session_idle = SDL_CreateCond();
+        session_quit = false;
+        session_writer = SDL_CreateThread(session_writer_thread, "session writer", NULL);
+    }
+
+    write->next = NULL;
+    SDL_LockMutex(session_mutex);
+    if(session_queue_tail == NULL){
+
+        session_queue_head = write;
+
+    }else{
+
+        session_queue_tail->next = write;
+    }
+    session_queue_tail = write;
+    SDL_CondSignal(session_cond);
+    SDL_UnlockMutex(session_mutex);
+}
+
+void session_save_async(History* history, char* puzzle_filename){
+
+    int packed_size = (history->move_count + 1) / 2;
+    long size = SESSION_HEADER_SIZE + packed_size + ((history->keyframe_count + 1) * (4 + STATE_RECORD_SIZE));
+
+    SessionWrite* write = (SessionWrite*)malloc(sizeof(SessionWrite));
+    get_session_path(puzzle_filename, write->path);
+    write->size = size;
+    write->data = (unsigned char*)calloc(size, 1);
+
+    unsigned char* header = write->data;
+    memcpy(header, "DKSS", 4);
+    header[4] = SESSION_VERSION;
+    uint64_t puzzle_hash = get_puzzle_hash(&history->keyframes[0].state);
+    for(int i = 0; i < 8; i++){
+
+        header[8 + i] = (puzzle_hash >> (i * 8)) & 0xFF;
+    }
+    write_int32(header + 16, history->keyframe_interval);
+    write_int32(header + 20, history->position);
+    write_int32(header + 24, history->move_count);
+    write_int32(header + 28, history->keyframe_count);
+
+    unsigned char* cursor = write->data + SESSION_HEADER_SIZE;
+    memcpy(cursor, history->packed_moves, packed_size);
+    cursor += packed_size;
+
+    // Every keyframe followed by the current state, each as its move index and state record
+    for(int i = 0; i <= history->keyframe_count; i++){
+
+        bool is_current = i == history->keyframe_count;
+        write_int32(cursor, is_current ? history->position : history->keyframes[i].move_index);
+        state_encode(is_current ? &history->current : &history->keyframes[i].state, cursor + 4);
+        cursor += 4 + STATE_RECORD_SIZE;
+    }
+
+    session_queue_write(write);
+}
+
+void session_discard_async(char* puzzle_filename){
+
+    SessionWrite* write = (SessionWrite*)malloc(sizeof(SessionWrite));
+    get_session_path(puzzle_filename, write->path);
+    write->data = NULL;
+    write->size = 0;
+
+    session_queue_write(write);
+}
+
+void session_flush(){
+
+    if(session_writer == NULL){
+
+        return;
+    }
+
+    SDL_LockMutex(session_mutex);
+    while(session_queue_head != NULL || session_writing){
+
+        SDL_CondWait(session_idle, session_mutex);
+    }
+    SDL_UnlockMutex(session_mutex);
+}
+
+bool session_load(History* history, State* initial_state, char* puzzle_filename){
+
+    char path[256];
+    get_session_path(puzzle_filename, path);
+
+    // A save or discard of this puzzle may still be queued from leaving it a moment ago
+    session_flush();
+
+    FILE* file = fopen(path, "rb");
+    if(file == NULL){
+
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if(size < SESSION_HEADER_SIZE){
+
+        fclose(file);
+        return false;
+    }
+
+    unsigned char* data = (unsigned char*)malloc(size);
+    bool success = fread(data, 1, size, file) == (size_t)size;
+    fclose(file);
+
+    uint64_t puzzle_hash = 0;
+    for(int i = 0; i < 8; i++){
+
+        puzzle_hash |= (uint64_t)data[8 + i] << (i * 8);
+    }
+    int keyframe_interval = read_int32(data + 16);
+    int position = read_int32(data + 20);
+    int move_count = read_int32(data + 24);
+    int keyframe_count = read_int32(data + 28);
+
+    // A session for an older version of the puzzle is useless, so it is ignored
+    success = success && memcmp(data, "DKSS", 4) == 0 && data[4] == SESSION_VERSION && puzzle_hash == get_puzzle_hash(initial_state);
+    success = success && move_count >= 0 && keyframe_count >= 1 && position >= 0 && position <= move_count;
+    int packed_size = (move_count + 1) / 2;
+    success = success && size == SESSION_HEADER_SIZE + packed_size + ((long)(keyframe_count + 1) * (4 + STATE_RECORD_SIZE));
+    if(!success){
+
+        free(data);
+        return false;
+    }
+
+    history_init(history, initial_state, keyframe_interval, HISTORY_DEFAULT_MEMORY_BUDGET);
+
+    history->move_capacity = 256;
+    while(history->move_capacity < move_count + 2){
+
+        history->move_capacity *= 2;
+    }
+    history->packed_moves = (unsigned char*)realloc(history->packed_moves, history->move_capacity / 2);
+    memcpy(history->packed_moves, data + SESSION_HEADER_SIZE, packed_size);
+    history->move_count = move_count;
+
+    history->keyframe_capacity = keyframe_count;
+    history->keyframes = (HistoryKeyframe*)realloc(history->keyframes, history->keyframe_capacity * sizeof(HistoryKeyframe));
+    unsigned char* cursor = data + SESSION_HEADER_SIZE + packed_size;
+    for(int i = 0; i < keyframe_count; i++){
+
+        history->keyframes[i].move_index = read_int32(cursor);
+        state_decode(cursor + 4, &history->keyframes[i].state);
+        cursor += 4 + STATE_RECORD_SIZE;
+
+        // history_seek searches the keyframes by move index, so they have to start at 0 and keep increasing within the moves
+        int previous_index = i == 0 ? -1 : history->keyframes[i - 1].move_index;
+        success = success && history->keyframes[i].move_index > previous_index && history->keyframes[i].move_index <= move_count;
+    }
+    success = success && history->keyframes[0].move_index == 0;
+    history->keyframe_count = keyframe_count;
+    if(!success){
+
+        history_free(history);
+        free(data);
+        return false;
+    }
+
+    history->position = position;
+    state_decode(cursor + 4, &history->current);
+
+    free(data);
+
+    return true;
+}
+
+void session_shutdown(){
+
+    if(session_writer == NULL){
+
+        return;
+    }
+
+    SDL_LockMutex(session_mutex);
+    session_quit = true;
+    SDL_CondSignal(session_cond);
+    SDL_UnlockMutex(session_mutex);
+
+    SDL_WaitThread(session_writer, NULL);
+    SDL_DestroyCond(session_cond);
+    SDL_DestroyCond(session_idle);
+    SDL_DestroyMutex(session_mutex);
+    session_writer = NULL;
+}
@@ -0,0 +1,199 @@
+#include "simulation.h"
+
+#define SIMULATION_FRESH 4
+
+int simulation_worker_thread(void* data);
+
+void simulation_fill_snapshot(Simulation* simulation, SimulationSnapshot* snapshot){
+
+    snapshot->state = *history_current(simulation->history);
+    snapshot->state.previous_state = NULL;
+    snapshot->position = simulation->history->position;
+    snapshot->move_count = simulation->history->move_count;
+    snapshot->serial = simulation->publish_count;
+}
+
+void simulation_start(Simulation* simulation, History* history, Replay* replay){
+
+    simulation->history = history;
+    simulation->replay = replay;
+    simulation->replay_position = history->position;
+    simulation->publish_count = 0;
+
+    SDL_AtomicSet(&simulation->quit, 0);
+    SDL_AtomicSet(&simulation->command_head, 0);
+    SDL_AtomicSet(&simulation->command_tail, 0);
+
+    // All three slots start out as the current state, so the first frame has something to draw
+    for(int i = 0; i < 3; i++){
+
+        simulation_fill_snapshot(simulation, &simulation->snapshots[i]);
+    }
+    simulation->front = 0;
+    SDL_AtomicSet(&simulation->middle, 1);
+    simulation->back = 2;
+
+    simulation->wake = SDL_CreateSemaphore(0);
+    simulation->worker = SDL_CreateThread(simulation_worker_thread, "simulation", simulation);
+}
+
+void simulation_stop(Simulation* simulation){
+
+    SDL_AtomicSet(&simulation->quit, 1);
+    SDL_SemPost(simulation->wake);
+    SDL_WaitThread(simulation->worker, NULL);
+    SDL_DestroySemaphore(simulation->wake);
+    simulation->worker = NULL;
+
+    // The session ends wherever the timeline was left, which is the one seek the replay still needs
+    simulation_sync_replay(simulation);
+}
+
+bool simulation_send(Simulation* simulation, int type, int value){
+
+    int head = SDL_AtomicGet(&simulation->command_head);
+    if(head - SDL_AtomicGet(&simulation->command_tail) == SIMULATION_QUEUE_SIZE){
+
+        return false;
+    }
+
+    simulation->commands[head & (SIMULATION_QUEUE_SIZE - 1)] = (SimulationCommand){ .type = type, .value = value };
+    // Only now can the worker see the command, the atomic set orders the write above before it
+    SDL_AtomicSet(&simulation->command_head, head + 1);
+    SDL_SemPost(simulation->wake);
+
+    return true;
+}
+
+SimulationSnapshot* simulation_snapshot(Simulation* simulation){
+
+    if(SDL_AtomicGet(&simulation->middle) & SIMULATION_FRESH){
+
+        simulation->front = SDL_AtomicSet(&simulation->middle, simulation->front) & ~SIMULATION_FRESH;
+    }
+
+    return &simulation->snapshots[simulation->front];
+}
+
+void simulation_publish(Simulation* simulation){
+
+    simulation->publish_count++;
+    simulation_fill_snapshot(simulation, &simulation->snapshots[simulation->back]);
+    simulation->back = SDL_AtomicSet(&simulation->middle, simulation->back | SIMULATION_FRESH) & ~SIMULATION_FRESH;
+}
+
+void simulation_run_command(Simulation* simulation, SimulationCommand* command){
+
+    History* history = simulation->history;
+    int victory = history_current(history)->victory;
+
+    if(command->type == SIMULATION_MOVE){
+
+        if(victory != 0){
+
+            return;
+        }
+
+        if(command->value == PLAYER_MOVE_UNDO){
+
+            seek_timeline(history, history->position - 1);
+
+        }else{
+
+            simulation_sync_replay(simulation);
+            replay_record(simulation->replay, command->value);
+            history_push(history, command->value);
+            simulation->replay_position = history->position;
+        }
+
+    }else if(command->type == SIMULATION_SEEK){
+
+        seek_timeline(history, command->value);
+
+    }else if(command->type == SIMULATION_STEP){
+
+        seek_timeline(history, history->position + command->value);
+
+    }else if(command->type == SIMULATION_RESTART){
+
+        if(victory != -1){
+
+            return;
+        }
+
+        simulation_sync_replay(simulation);
+        replay_record(simulation->replay, REPLAY_RESTART);
+        simulation->replay_position = 0;
+
+        // Keyframe 0 is the start of the puzzle, so this is a single copy
+        history_seek(history, 0);
+        history_truncate(history);
+    }
+}
+
+int simulation_worker_thread(void* data){
+
+    Simulation* simulation = (Simulation*)data;
+
+    while(true){
+
+        SDL_SemWait(simulation->wake);
+
+        // Read before draining, as every command sent before the quit flag is then already visible
+        bool quitting = SDL_AtomicGet(&simulation->quit) != 0;
+
+        int tail = SDL_AtomicGet(&simulation->command_tail);
+        while(tail != SDL_AtomicGet(&simulation->command_head)){
+
+            SimulationCommand command = simulation->commands[tail & (SIMULATION_QUEUE_SIZE - 1)];
+            tail++;
+
+            // Scrubbing queues a seek per mouse event, only the last of a run matters
+            bool superseded = command.type == SIMULATION_SEEK && tail != SDL_AtomicGet(&simulation->command_head) && simulation->commands[tail & (SIMULATION_QUEUE_SIZE - 1)].type == SIMULATION_SEEK;
+            SDL_AtomicSet(&simulation->command_tail, tail);
+            if(superseded){
+
+                continue;
+            }
+
+            simulation_run_command(simulation, &command);
+            simulation_publish(simulation);
+        }
+
+        if(quitting){
+
+            break;
+        }
+    }
+
+    return 0;
+}
+
+void seek_timeline(History* history, int move_index){
+
+    if(move_index < 0){
+
+        move_index = 0;
+    }
+    if(move_index > history->move_count){
+
+        move_index = history->move_count;
+    }
+
+    history_seek(history, move_index);
+}
+
+void simulation_sync_replay(Simulation* simulation){
+
+    History* history = simulation->history;
+
+    // The history only drops moves past the position when a move or restart follows, and both sync first
+    for(; simulation->replay_position > history->position; simulation->replay_position--){
+
+        replay_record(simulation->replay, PLAYER_MOVE_UNDO);
+    }
+    for(; simulation->replay_position < history->position; simulation->replay_position++){
+
+        replay_record(simulation->replay, history_get_move(history, simulation->replay_position));
+    }
+}
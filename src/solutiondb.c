@@ -0,0 +1,448 @@
+#include "solutiondb.h"
+#include <SDL2/SDL.h>
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#define DB_HEADER_SIZE 8
+#define DB_RECORD_HEADER_SIZE 32
+
+typedef struct DbIndexEntry{
+
+    uint64_t hash;
+    long offset; // -1 is empty
+} DbIndexEntry;
+
+typedef struct SolutionDb{
+
+    char path[256];
+    SDL_mutex* mutex;
+
+    unsigned char* map;
+    long map_size;
+    long valid_size; // where the last intact record ends, and so where the next one goes
+    #ifdef _WIN32
+        HANDLE file_handle;
+        HANDLE mapping_handle;
+        HANDLE write_handle;
+    #else
+        int write_fd;
+    #endif
+
+    DbIndexEntry* index;
+    int index_capacity;
+    int index_count;
+} SolutionDb;
+
+SolutionDb* solution_db = NULL;
+
+void db_unmap(SolutionDb* db){
+
+    if(db->map == NULL){
+
+        return;
+    }
+
+    #ifdef _WIN32
+        UnmapViewOfFile(db->map);
+        CloseHandle(db->mapping_handle);
+        CloseHandle(db->file_handle);
+    #else
+        munmap(db->map, db->map_size);
+    #endif
+    db->map = NULL;
+    db->map_size = 0;
+}
+
+// Maps the whole file read only, leaving map NULL if it is missing or empty
+void db_map(SolutionDb* db){
+
+    db_unmap(db);
+
+    #ifdef _WIN32
+        db->file_handle = CreateFileA(db->path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if(db->file_handle == INVALID_HANDLE_VALUE){
+
+            return;
+        }
+        LARGE_INTEGER size;
+        if(!GetFileSizeEx(db->file_handle, &size) || size.QuadPart == 0){
+
+            CloseHandle(db->file_handle);
+            return;
+        }
+        db->mapping_handle = CreateFileMappingA(db->file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if(db->mapping_handle == NULL){
+
+            CloseHandle(db->file_handle);
+            return;
+        }
+        db->map = (unsigned char*)MapViewOfFile(db->mapping_handle, FILE_MAP_READ, 0, 0, 0);
+        if(db->map == NULL){
+
+            CloseHandle(db->mapping_handle);
+            CloseHandle(db->file_handle);
+            return;
+        }
+        db->map_size = (long)size.QuadPart;
+    #else
+        // Closing any descriptor for the file drops this process's lock on it, so while writing the locked one is used
+        int fd = db->write_fd >= 0 ? db->write_fd : open(db->path, O_RDONLY);
+        if(fd < 0){
+
+            return;
+        }
+        struct stat file_stat;
+        if(fstat(fd, &file_stat) != 0 || file_stat.st_size == 0){
+
+            if(fd != db->write_fd){
+
+                close(fd);
+            }
+            return;
+        }
+        void* map = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(fd != db->write_fd){
+
+            close(fd);
+        }
+        if(map == MAP_FAILED){
+
+            return;
+        }
+        db->map = (unsigned char*)map;
+        db->map_size = file_stat.st_size;
+    #endif
+}
+
+uint64_t read_uint_le(unsigned char* bytes, int byte_count){
+
+    uint64_t value = 0;
+    for(int i = 0; i < byte_count; i++){
+
+        value |= (uint64_t)bytes[i] << (i * 8);
+    }
+
+    return value;
+}
+
+void write_uint_le(unsigned char* bytes, uint64_t value, int byte_count){
+
+    for(int i = 0; i < byte_count; i++){
+
+        bytes[i] = (value >> (i * 8)) & 0xFF;
+    }
+}
+
+void db_index_insert(SolutionDb* db, uint64_t hash, long offset){
+
+    if((db->index_count + 1) * 4 > db->index_capacity * 3){
+
+        DbIndexEntry* old_index = db->index;
+        int old_capacity = db->index_capacity;
+        db->index_capacity *= 2;
+        db->index = (DbIndexEntry*)malloc(db->index_capacity * sizeof(DbIndexEntry));
+        for(int i = 0; i < db->index_capacity; i++){
+
+            db->index[i].offset = -1;
+        }
+        db->index_count = 0;
+        for(int i = 0; i < old_capacity; i++){
+
+            if(old_index[i].offset != -1){
+
+                db_index_insert(db, old_index[i].hash, old_index[i].offset);
+            }
+        }
+        free(old_index);
+    }
+
+    int slot = hash & (db->index_capacity - 1);
+    while(db->index[slot].offset != -1 && db->index[slot].hash != hash){
+
+        slot = (slot + 1) & (db->index_capacity - 1);
+    }
+    if(db->index[slot].offset == -1){
+
+        db->index_count++;
+    }
+    db->index[slot].hash = hash;
+    db->index[slot].offset = offset;
+}
+
+bool db_header_valid(SolutionDb* db){
+
+    return db->map != NULL && db->map_size >= DB_HEADER_SIZE && memcmp(db->map, "DKSD", 4) == 0 && db->map[4] == SOLUTION_DB_VERSION;
+}
+
+// Indexes every intact record from valid_size to the end of the map
+void db_index_records(SolutionDb* db){
+
+    if(!db_header_valid(db)){
+
+        return;
+    }
+    if(db->valid_size < DB_HEADER_SIZE){
+
+        db->valid_size = DB_HEADER_SIZE;
+    }
+
+    while(db->valid_size + DB_RECORD_HEADER_SIZE <= db->map_size){
+
+        unsigned char* record = db->map + db->valid_size;
+        int move_count = read_uint_le(record + 4, 2);
+        long record_size = DB_RECORD_HEADER_SIZE + (move_count + 1) / 2;
+        if(record[0] != 'S' || record[1] != 'R' || move_count > SOLVER_MAX_DEPTH || db->valid_size + record_size > db->map_size){
+
+            break;
+        }
+
+        db_index_insert(db, read_uint_le(record + 8, 8), db->valid_size);
+        db->valid_size += record_size;
+    }
+}
+
+bool solution_db_open(char* path){
+
+    if(solution_db != NULL){
+
+        return true;
+    }
+
+    solution_db = (SolutionDb*)calloc(1, sizeof(SolutionDb));
+    strncpy(solution_db->path, path, 255);
+    solution_db->mutex = SDL_CreateMutex();
+    #ifndef _WIN32
+        solution_db->write_fd = -1;
+    #endif
+    solution_db->index_capacity = 256;
+    solution_db->index = (DbIndexEntry*)malloc(solution_db->index_capacity * sizeof(DbIndexEntry));
+    for(int i = 0; i < solution_db->index_capacity; i++){
+
+        solution_db->index[i].offset = -1;
+    }
+
+    db_map(solution_db);
+    if(solution_db->map != NULL && solution_db->map_size >= DB_HEADER_SIZE && !db_header_valid(solution_db)){
+
+        // Its puzzle hashes mean nothing to this version, the first store starts the file again
+        printf("Solution database %s is from another version, starting a new one\n", path);
+        db_unmap(solution_db);
+        remove(solution_db->path);
+    }
+    db_index_records(solution_db);
+
+    return true;
+}
+
+void solution_db_close(){
+
+    if(solution_db == NULL){
+
+        return;
+    }
+
+    db_unmap(solution_db);
+    SDL_DestroyMutex(solution_db->mutex);
+    free(solution_db->index);
+    free(solution_db);
+    solution_db = NULL;
+}
+
+bool solution_db_lookup(uint64_t puzzle_hash, SolutionRecord* record){
+
+    if(solution_db == NULL){
+
+        return false;
+    }
+
+    SDL_LockMutex(solution_db->mutex);
+
+    bool found = false;
+    int slot = puzzle_hash & (solution_db->index_capacity - 1);
+    while(solution_db->index[slot].offset != -1){
+
+        if(solution_db->index[slot].hash == puzzle_hash){
+
+            found = true;
+            break;
+        }
+        slot = (slot + 1) & (solution_db->index_capacity - 1);
+    }
+
+    if(found){
+
+        unsigned char* bytes = solution_db->map + solution_db->index[slot].offset;
+        record->puzzle_hash = puzzle_hash;
+        record->solvable = (bytes[2] & 1) != 0;
+        record->move_count = read_uint_le(bytes + 4, 2);
+        record->nodes = read_uint_le(bytes + 16, 8);
+        record->milliseconds = read_uint_le(bytes + 24, 4);
+        for(int i = 0; i < record->move_count; i++){
+
+            unsigned char packed = bytes[DB_RECORD_HEADER_SIZE + (i / 2)];
+            record->moves[i] = i % 2 == 0 ? packed & 0x0F : packed >> 4;
+        }
+    }
+
+    SDL_UnlockMutex(solution_db->mutex);
+
+    return found;
+}
+
+// Opens the file for writing, creating it if it's missing, and waits until no other process is writing to it
+bool db_lock_file(SolutionDb* db){
+
+    #ifdef _WIN32
+        db->write_handle = CreateFileA(db->path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if(db->write_handle == INVALID_HANDLE_VALUE){
+
+            return false;
+        }
+        OVERLAPPED overlapped;
+        memset(&overlapped, 0, sizeof(OVERLAPPED));
+        if(!LockFileEx(db->write_handle, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &overlapped)){
+
+            CloseHandle(db->write_handle);
+            return false;
+        }
+    #else
+        db->write_fd = open(db->path, O_RDWR | O_CREAT, 0644);
+        if(db->write_fd < 0){
+
+            return false;
+        }
+        // A length of 0 covers the whole file, however far it grows
+        struct flock lock;
+        memset(&lock, 0, sizeof(struct flock));
+        lock.l_type = F_WRLCK;
+        lock.l_whence = SEEK_SET;
+        if(fcntl(db->write_fd, F_SETLKW, &lock) != 0){
+
+            close(db->write_fd);
+            db->write_fd = -1;
+            return false;
+        }
+    #endif
+
+    return true;
+}
+
+bool db_write_at(SolutionDb* db, long offset, unsigned char* bytes, long size){
+
+    #ifdef _WIN32
+        LARGE_INTEGER position;
+        position.QuadPart = offset;
+        DWORD written = 0;
+        return SetFilePointerEx(db->write_handle, position, NULL, FILE_BEGIN) && WriteFile(db->write_handle, bytes, (DWORD)size, &written, NULL) && written == (DWORD)size;
+    #else
+        return lseek(db->write_fd, offset, SEEK_SET) == offset && write(db->write_fd, bytes, size) == size;
+    #endif
+}
+
+// Closing the file lets go of the lock
+bool db_unlock_file(SolutionDb* db){
+
+    #ifdef _WIN32
+        OVERLAPPED overlapped;
+        memset(&overlapped, 0, sizeof(OVERLAPPED));
+        UnlockFileEx(db->write_handle, 0, MAXDWORD, MAXDWORD, &overlapped);
+        return CloseHandle(db->write_handle) != 0;
+    #else
+        bool closed = close(db->write_fd) == 0;
+        db->write_fd = -1;
+        return closed;
+    #endif
+}
+
+bool solution_db_store(uint64_t puzzle_hash, SolverResult* result){
+
+    if(solution_db == NULL || !result->solved){
+
+        return false;
+    }
+
+    long record_size = DB_RECORD_HEADER_SIZE + (result->move_count + 1) / 2;
+    unsigned char* record = (unsigned char*)calloc(record_size, 1);
+    record[0] = 'S';
+    record[1] = 'R';
+    record[2] = 1;
+    write_uint_le(record + 4, result->move_count, 2);
+    write_uint_le(record + 8, puzzle_hash, 8);
+    write_uint_le(record + 16, result->nodes, 8);
+    write_uint_le(record + 24, (uint64_t)(result->seconds * 1000), 4);
+    for(int i = 0; i < result->move_count; i++){
+
+        record[DB_RECORD_HEADER_SIZE + (i / 2)] |= (result->moves[i] & 0x0F) << (i % 2 == 0 ? 0 : 4);
+    }
+
+    SDL_LockMutex(solution_db->mutex);
+
+    // Other processes append to the same file, whatever they added while we weren't looking is indexed and the record goes after it
+    bool locked = db_lock_file(solution_db);
+    bool success = locked;
+    if(success){
+
+        db_map(solution_db);
+        bool empty = solution_db->map == NULL || solution_db->map_size < DB_HEADER_SIZE;
+        if(!empty && !db_header_valid(solution_db)){
+
+            success = false;
+
+        }else{
+
+            db_index_records(solution_db);
+        }
+        // The mapping has to go before writing, Windows won't extend a mapped file
+        db_unmap(solution_db);
+
+        if(success && empty){
+
+            unsigned char header[DB_HEADER_SIZE] = { 'D', 'K', 'S', 'D', SOLUTION_DB_VERSION, 0, 0, 0 };
+            success = db_write_at(solution_db, 0, header, DB_HEADER_SIZE);
+            solution_db->valid_size = success ? DB_HEADER_SIZE : 0;
+        }
+    }
+
+    // Writing after the last intact record overwrites whatever a torn write left behind, only the one record needs indexing
+    long offset = solution_db->valid_size;
+    if(success){
+
+        success = db_write_at(solution_db, offset, record, record_size);
+    }
+    if(locked){
+
+        success = db_unlock_file(solution_db) && success;
+    }
+    if(success){
+
+        solution_db->valid_size = offset + record_size;
+        db_index_insert(solution_db, puzzle_hash, offset);
+
+    }else{
+
+        printf("Unable to write to solution database %s!\n", solution_db->path);
+    }
+    db_map(solution_db);
+
+    SDL_UnlockMutex(solution_db->mutex);
+    free(record);
+
+    return success;
+}
+
+int solution_db_best_length(uint64_t puzzle_hash){
+
+    SolutionRecord record;
+    if(!solution_db_lookup(puzzle_hash, &record)){
+
+        return SOLUTION_UNKNOWN;
+    }
+
+    return record.solvable ? record.move_count : SOLUTION_UNSOLVABLE;
+}
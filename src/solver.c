@@ -0,0 +1,374 @@
+#include "solver.h"
+#include <SDL2/SDL.h>
+#include <limits.h>
+#ifndef _WIN32
+    #include <sys/resource.h>
+#endif
+
+#define SEARCH_FOUND -1
+#define SEARCH_ABORTED -2
+
+typedef struct TableEntry{
+
+    uint64_t hash;
+    int iteration;
+    int depth;
+} TableEntry;
+
+typedef struct IdaSearch{
+
+    SolverOptions* options;
+    SolverResult* result;
+
+    // One snapshot per ply, restoring from it is how moves are taken back
+    State* snapshots;
+    int path[SOLVER_MAX_DEPTH + 1]; // the last move is followed by NOTHING, even at the deepest ply
+    Pathfinder pathfinder;
+
+    TableEntry* table;
+    uint64_t table_mask;
+    int iteration;
+} IdaSearch;
+
+typedef struct BfsNode{
+
+    State state;
+    int parent;
+    int move;
+} BfsNode;
+
+bool solve_ida(State* initial_state, SolverOptions* options, SolverResult* result);
+bool solve_bfs(State* initial_state, SolverOptions* options, SolverResult* result);
+int ida_search(IdaSearch* search, State* current_state, int depth, int bound);
+bool solver_cancelled(SolverOptions* options, long nodes);
+
+void solver_default_options(SolverOptions* options){
+
+    options->mode = SOLVER_MODE_IDA;
+    options->max_depth = 100;
+    options->max_nodes = 0;
+    options->table_megabytes = 64;
+    options->cancelled = NULL;
+    options->cancel_data = NULL;
+}
+
+bool solver_cancelled(SolverOptions* options, long nodes){
+
+    return options->cancelled != NULL && nodes % SOLVER_CANCEL_INTERVAL == 0 && options->cancelled(options->cancel_data);
+}
+
+bool solve_state(State* initial_state, SolverOptions* options, SolverResult* result){
+
+    result->solved = false;
+    result->exhausted = false;
+    result->move_count = 0;
+    result->nodes = 0;
+
+    // Clamped on a copy, the hint engine and tools reuse their options from one call to the next
+    SolverOptions clamped_options = *options;
+    if(clamped_options.max_depth > SOLVER_MAX_DEPTH){
+
+        clamped_options.max_depth = SOLVER_MAX_DEPTH;
+    }
+    if(clamped_options.max_depth < 0){
+
+        clamped_options.max_depth = 0;
+    }
+
+    Uint64 start_time = SDL_GetPerformanceCounter();
+    if(clamped_options.mode == SOLVER_MODE_BFS){
+
+        solve_bfs(initial_state, &clamped_options, result);
+
+    }else{
+
+        solve_ida(initial_state, &clamped_options, result);
+    }
+    result->seconds = (SDL_GetPerformanceCounter() - start_time) / (double)SDL_GetPerformanceFrequency();
+    result->peak_memory_kb = get_peak_memory_kb();
+
+    return result->solved;
+}
+
+long get_peak_memory_kb(){
+
+    #ifdef _WIN32
+        return 0;
+    #else
+        struct rusage usage;
+        if(getrusage(RUSAGE_SELF, &usage) != 0){
+
+            return 0;
+        }
+
+        // Linux reports kilobytes, macOS bytes
+        #ifdef __APPLE__
+            return usage.ru_maxrss / 1024;
+        #else
+            return usage.ru_maxrss;
+        #endif
+    #endif
+}
+
+bool solve_ida(State* initial_state, SolverOptions* options, SolverResult* result){
+
+    IdaSearch search;
+    search.options = options;
+    search.result = result;
+    search.snapshots = (State*)malloc((options->max_depth + 1) * sizeof(State));
+    pathfinder_init(&search.pathfinder);
+
+    uint64_t table_size = 1;
+    while(table_size * 2 * sizeof(TableEntry) <= (uint64_t)options->table_megabytes * 1024 * 1024){
+
+        table_size *= 2;
+    }
+    search.table = (TableEntry*)calloc(table_size, sizeof(TableEntry));
+    search.table_mask = table_size - 1;
+
+    State current_state = *initial_state;
+    current_state.previous_state = NULL;
+
+    int bound = moves_to_win_lower_bound(&current_state);
+    search.iteration = 0;
+    while(true){
+
+        // Iterations are told apart by their number so the table never needs clearing
+        search.iteration++;
+        int next_bound = ida_search(&search, &current_state, 0, bound);
+
+        if(next_bound == SEARCH_FOUND){
+
+            result->solved = true;
+            result->move_count = 0;
+            while(result->move_count < options->max_depth && search.path[result->move_count] != NOTHING){
+
+                result->moves[result->move_count] = search.path[result->move_count];
+                result->move_count++;
+            }
+            break;
+        }
+        if(next_bound == SEARCH_ABORTED){
+
+            break;
+        }
+        if(next_bound == INT_MAX){
+
+            result->exhausted = true;
+            break;
+        }
+
+        bound = next_bound;
+    }
+
+    free(search.snapshots);
+    free(search.table);
+    pathfinder_free(&search.pathfinder);
+
+    return result->solved;
+}
+
+// Returns SEARCH_FOUND, SEARCH_ABORTED or the smallest f cost above bound, which is INT_MAX if there is none
+int ida_search(IdaSearch* search, State* current_state, int depth, int bound){
+
+    search->result->nodes++;
+    if(search->options->max_nodes != 0 && search->result->nodes > search->options->max_nodes){
+
+        return SEARCH_ABORTED;
+    }
+    if(solver_cancelled(search->options, search->result->nodes)){
+
+        return SEARCH_ABORTED;
+    }
+
+    if(current_state->victory == 1){
+
+        search->path[depth] = NOTHING;
+        return SEARCH_FOUND;
+    }
+    if(state_is_dead(current_state)){
+
+        return INT_MAX;
+    }
+
+    int f = depth + moves_to_win_lower_bound(current_state);
+    if(f > bound){
+
+        return f;
+    }
+    if(depth >= search->options->max_depth){
+
+        return INT_MAX;
+    }
+
+    // Skip states already reached this iteration at the same depth or shallower
+    uint64_t hash = canonical_hash(current_state);
+    TableEntry* entry = &search->table[hash & search->table_mask];
+    if(entry->hash == hash && entry->iteration == search->iteration && entry->depth <= depth){
+
+        return INT_MAX;
+    }
+    if(entry->iteration != search->iteration || entry->hash == hash || depth <= entry->depth){
+
+        entry->hash = hash;
+        entry->iteration = search->iteration;
+        entry->depth = depth;
+    }
+
+    int moves[MAX_GENERATED_MOVES];
+    int move_count = generate_moves(current_state, moves);
+    int min_cost = INT_MAX;
+    State* snapshot = &search->snapshots[depth];
+
+    for(int i = 0; i < move_count; i++){
+
+        *snapshot = *current_state;
+        simulate_move(current_state, snapshot, MOVE_CODE(moves[i]), &search->pathfinder);
+        search->path[depth] = MOVE_CODE(moves[i]);
+
+        int cost = ida_search(search, current_state, depth + 1, bound);
+        *current_state = *snapshot;
+
+        if(cost == SEARCH_FOUND || cost == SEARCH_ABORTED){
+
+            return cost;
+        }
+        if(cost < min_cost){
+
+            min_cost = cost;
+        }
+    }
+
+    return min_cost;
+}
+
+bool solve_bfs(State* initial_state, SolverOptions* options, SolverResult* result){
+
+    int node_capacity = 1024;
+    int node_count = 0;
+    BfsNode* nodes = (BfsNode*)malloc(node_capacity * sizeof(BfsNode));
+    int* depths = (int*)malloc(node_capacity * sizeof(int));
+
+    // Open addressing set of node indices, -1 is empty
+    int table_capacity = node_capacity * 2;
+    int* table = (int*)malloc(table_capacity * sizeof(int));
+    memset(table, -1, table_capacity * sizeof(int));
+    uint64_t* hashes = (uint64_t*)malloc(node_capacity * sizeof(uint64_t));
+
+    nodes[0].state = *initial_state;
+    nodes[0].state.previous_state = NULL;
+    nodes[0].parent = -1;
+    nodes[0].move = NOTHING;
+    depths[0] = 0;
+    hashes[0] = canonical_hash(&nodes[0].state);
+    table[hashes[0] & (table_capacity - 1)] = 0;
+    node_count = 1;
+
+    Pathfinder pathfinder;
+    pathfinder_init(&pathfinder);
+
+    int solution_node = -1;
+    bool aborted = false;
+    for(int head = 0; head < node_count && solution_node == -1 && !aborted; head++){
+
+        result->nodes++;
+        if(nodes[head].state.victory == 1){
+
+            solution_node = head;
+            break;
+        }
+        if(solver_cancelled(options, result->nodes)){
+
+            aborted = true;
+            break;
+        }
+        if(depths[head] >= options->max_depth || state_is_dead(&nodes[head].state)){
+
+            continue;
+        }
+
+        int moves[MAX_GENERATED_MOVES];
+        int move_count = generate_moves(&nodes[head].state, moves);
+        for(int i = 0; i < move_count; i++){
+
+            if(options->max_nodes != 0 && node_count >= options->max_nodes){
+
+                aborted = true;
+                break;
+            }
+
+            if(node_count == node_capacity){
+
+                node_capacity *= 2;
+                nodes = (BfsNode*)realloc(nodes, node_capacity * sizeof(BfsNode));
+                depths = (int*)realloc(depths, node_capacity * sizeof(int));
+                hashes = (uint64_t*)realloc(hashes, node_capacity * sizeof(uint64_t));
+
+                table_capacity = node_capacity * 2;
+                table = (int*)realloc(table, table_capacity * sizeof(int));
+                memset(table, -1, table_capacity * sizeof(int));
+                for(int j = 0; j < node_count; j++){
+
+                    int slot = hashes[j] & (table_capacity - 1);
+                    while(table[slot] != -1){
+
+                        slot = (slot + 1) & (table_capacity - 1);
+                    }
+                    table[slot] = j;
+                }
+            }
+
+            BfsNode* child = &nodes[node_count];
+            child->state = nodes[head].state;
+            simulate_move(&child->state, &nodes[head].state, MOVE_CODE(moves[i]), &pathfinder);
+
+            uint64_t hash = canonical_hash(&child->state);
+            int slot = hash & (table_capacity - 1);
+            bool seen = false;
+            while(table[slot] != -1){
+
+                if(hashes[table[slot]] == hash){
+
+                    seen = true;
+                    break;
+                }
+                slot = (slot + 1) & (table_capacity - 1);
+            }
+            if(seen){
+
+                continue;
+            }
+
+            child->parent = head;
+            child->move = MOVE_CODE(moves[i]);
+            depths[node_count] = depths[head] + 1;
+            hashes[node_count] = hash;
+            table[slot] = node_count;
+            node_count++;
+        }
+    }
+
+    if(solution_node != -1){
+
+        result->solved = true;
+        result->move_count = depths[solution_node];
+        int current_node = solution_node;
+        for(int i = result->move_count - 1; i >= 0; i--){
+
+            result->moves[i] = nodes[current_node].move;
+            current_node = nodes[current_node].parent;
+        }
+
+    }else if(!aborted){
+
+        result->exhausted = true;
+    }
+
+    free(nodes);
+    free(depths);
+    free(table);
+    free(hashes);
+    pathfinder_free(&pathfinder);
+
+    return result->solved;
+}
@@ -0,0 +1,512 @@
+#include "thumbnail.h"
+#include "minimap.h"
+#include "animation.h"
+#include "assets.h"
+#include "puzzleindex.h"
+#include <SDL2/SDL_image.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+    #include <direct.h>
+#endif
+
+// In the order of the SCENE_* sprite slots
+char* thumbnail_sprite_names[THUMBNAIL_SPRITE_COUNT] = {
+    "momduck_up.png", "momduck_leftright.png", "momduck_down.png",
+    "babyduck_up.png", "babyduck_leftright.png", "babyduck_down.png",
+    "goose_up.png", "goose_leftright.png", "goose_down.png",
+    "grass_tile.png", "bread.png"
+};
+
+bool thumbnail_sprites_load(ThumbnailSprites* sprites){
+
+    bool success = true;
+    for(int i = 0; i < THUMBNAIL_SPRITE_COUNT; i++){
+
+        BlitSprite* sprite = &sprites->sprites[i];
+        SDL_Surface* surface = assets_load_surface(thumbnail_sprite_names[i]);
+        if(surface == NULL){
+
+            sprite->pixels = NULL;
+            sprite->scaled = NULL;
+            sprite->scaled_flipped = NULL;
+            sprite->scaled_size = 0;
+            success = false;
+            continue;
+        }
+        success = blit_sprite_from_surface(sprite, surface) && success;
+        SDL_FreeSurface(surface);
+    }
+
+    return success;
+}
+
+void thumbnail_sprites_free(ThumbnailSprites* sprites){
+
+    for(int i = 0; i < THUMBNAIL_SPRITE_COUNT; i++){
+
+        blit_sprite_free(&sprites->sprites[i]);
+    }
+}
+
+void thumbnail_sprites_share(ThumbnailSprites* sprites, ThumbnailSprites* source){
+
+    for(int i = 0; i < THUMBNAIL_SPRITE_COUNT; i++){
+
+        sprites->sprites[i] = source->sprites[i];
+        sprites->sprites[i].scaled_size = 0;
+        sprites->sprites[i].scaled = NULL;
+        sprites->sprites[i].scaled_flipped = NULL;
+    }
+}
+
+void thumbnail_sprites_unshare(ThumbnailSprites* sprites){
+
+    for(int i = 0; i < THUMBNAIL_SPRITE_COUNT; i++){
+
+        free(sprites->sprites[i].scaled);
+        free(sprites->sprites[i].scaled_flipped);
+        sprites->sprites[i].pixels = NULL;
+        sprites->sprites[i].scaled = NULL;
+        sprites->sprites[i].scaled_flipped = NULL;
+    }
+}
+
+// For maps too big for sprites, the minimap's flat colours. Every entity gets a pixel even when several squares share one.
+void thumbnail_render_colors(Framebuffer* framebuffer, State* current_state){
+
+    int width = framebuffer->width;
+    int height = framebuffer->height;
+    if(current_state->map_width * framebuffer->height > current_state->map_height * framebuffer->width){
+
+        height = (current_state->map_height * framebuffer->width) / current_state->map_width;
+
+    }else{
+
+        width = (current_state->map_width * framebuffer->height) / current_state->map_height;
+    }
+    width = width < 1 ? 1 : width;
+    height = height < 1 ? 1 : height;
+    int origin_x = (framebuffer->width - width) / 2;
+    int origin_y = (framebuffer->height - height) / 2;
+    framebuffer_fill_rect(framebuffer, origin_x, origin_y, width, height, MINIMAP_GRASS);
+
+    int square_count = 1 + MAX_DUCK_COUNT + MAX_BREAD_COUNT + MAX_GOOSE_COUNT;
+    for(int i = 0; i < square_count; i++){
+
+        int square_x, square_y;
+        if(i == 0){
+
+            square_x = current_state->player_x;
+            square_y = current_state->player_y;
+
+        }else if(i <= MAX_DUCK_COUNT){
+
+            square_x = current_state->duckling_x[i - 1];
+            square_y = current_state->duckling_y[i - 1];
+
+        }else if(i <= MAX_DUCK_COUNT + MAX_BREAD_COUNT){
+
+            square_x = current_state->bread_x[i - 1 - MAX_DUCK_COUNT];
+            square_y = current_state->bread_y[i - 1 - MAX_DUCK_COUNT];
+
+        }else{
+
+            square_x = current_state->goose_x[i - 1 - MAX_DUCK_COUNT - MAX_BREAD_COUNT];
+            square_y = current_state->goose_y[i - 1 - MAX_DUCK_COUNT - MAX_BREAD_COUNT];
+        }
+        if(square_x == -1){
+
+            continue;
+        }
+
+        // Later entities win a shared pixel, so geese stay visible the way they do on the minimap
+        int x = origin_x + ((square_x * width) / current_state->map_width);
+        int y = origin_y + ((square_y * height) / current_state->map_height);
+        framebuffer->pixels[(y * framebuffer->width) + x] = minimap_square_color(current_state, square_x, square_y);
+    }
+}
+
+void thumbnail_scene_target(SceneTarget* target, Framebuffer* framebuffer, ThumbnailSprites* sprites){
+
+    target->renderer = NULL;
+    target->framebuffer = framebuffer;
+    for(int i = 0; i < SCENE_SPRITE_COUNT; i++){
+
+        target->images[i] = NULL;
+        target->sprites[i] = &sprites->sprites[i];
+    }
+}
+
+void thumbnail_render_state(Framebuffer* framebuffer, ThumbnailSprites* sprites, State* current_state){
+
+    if(current_state->map_width <= 0 || current_state->map_height <= 0){
+
+        framebuffer_clear(framebuffer, 0xFF000000);
+        return;
+    }
+
+    int size_x = framebuffer->width / current_state->map_width;
+    int size_y = framebuffer->height / current_state->map_height;
+    int size = size_x < size_y ? size_x : size_y;
+    if(size < THUMBNAIL_MIN_TILE_SIZE){
+
+        framebuffer_clear(framebuffer, 0xFF000000);
+        thumbnail_render_colors(framebuffer, current_state);
+        return;
+    }
+
+    // A camera at an odd tile size, scrolled back to centre the map
+    Camera camera;
+    camera_init(&camera, framebuffer->width, framebuffer->height);
+    camera.tile_size = size;
+    camera.x = -((framebuffer->width - (current_state->map_width * size)) / 2);
+    camera.y = -((framebuffer->height - (current_state->map_height * size)) / 2);
+    SceneTarget target;
+    thumbnail_scene_target(&target, framebuffer, sprites);
+    render_scene(&target, current_state, current_state, ANIMATION_SCALE, &camera);
+}
+
+void get_thumbnail_path(uint64_t content_hash, char* path){
+
+    sprintf(path, "./thumbnails/%016llx.png", (unsigned long long)content_hash);
+}
+
+bool thumbnail_load_cached(char* path, Uint32* pixels){
+
+    SDL_Surface* loaded_surface = IMG_Load(path);
+    if(loaded_surface == NULL){
+
+        return false;
+    }
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(loaded_surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(loaded_surface);
+    if(converted == NULL){
+
+        return false;
+    }
+
+    // Anything drawn at another size is as good as stale
+    bool success = converted->w == THUMBNAIL_WIDTH && converted->h == THUMBNAIL_HEIGHT;
+    if(success){
+
+        SDL_LockSurface(converted);
+        for(int y = 0; y < THUMBNAIL_HEIGHT; y++){
+
+            memcpy(pixels + (y * THUMBNAIL_WIDTH), (Uint8*)converted->pixels + (y * converted->pitch), THUMBNAIL_WIDTH * sizeof(Uint32));
+        }
+        SDL_UnlockSurface(converted);
+    }
+    SDL_FreeSurface(converted);
+
+    return success;
+}
+
+// Written to a temporary file and renamed over the old one, so the menu never loads half a PNG
+void thumbnail_save(char* path, Uint32* pixels){
+
+    #ifdef _WIN32
+        _mkdir("./thumbnails");
+    #else
+        mkdir("./thumbnails", 0755);
+    #endif
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(pixels, THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT, 32, THUMBNAIL_WIDTH * sizeof(Uint32), SDL_PIXELFORMAT_ARGB8888);
+    if(surface == NULL){
+
+        printf("Unable to save thumbnail %s! SDL Error: %s\n", path, SDL_GetError());
+        return;
+    }
+
+    char temp_path[264];
+    sprintf(temp_path, "%s.tmp", path);
+    if(IMG_SavePNG(surface, temp_path) == 0){
+
+        // rename() won't replace an existing file on Windows
+        #ifdef _WIN32
+            remove(path);
+        #endif
+        rename(temp_path, path);
+
+    }else{
+
+        printf("Unable to save thumbnail %s! SDL Error: %s\n", path, IMG_GetError());
+        remove(temp_path);
+    }
+    SDL_FreeSurface(surface);
+}
+
+int thumbnail_thread(void* data){
+
+    ThumbnailWorker* worker = (ThumbnailWorker*)data;
+    ThumbnailBatch* batch = worker->batch;
+
+    while(SDL_AtomicGet(&batch->cancel) == 0){
+
+        /*
+         * The index and the claim on it are taken together under the lock, so the window can't
+         * move in between: everything marked WORKING is inside the window, or inside the held
+         * range thumbnail_batch_request keeps for it, and is always dropped later.
+         */
+        SDL_LockMutex(batch->mutex);
+        int index = batch->next_puzzle++;
+        bool in_window = index < batch->window_end;
+        // Already drawn, or being drawn, for an earlier window
+        bool claimed = in_window && SDL_AtomicCAS(&batch->status[index], THUMBNAIL_PENDING, THUMBNAIL_WORKING);
+        SDL_UnlockMutex(batch->mutex);
+
+        if(!in_window){
+
+            if(SDL_AtomicGet(&batch->finish) != 0){
+
+                break;
+            }
+            SDL_SemWait(batch->wake);
+            continue;
+        }
+        if(!claimed){
+
+            continue;
+        }
+
+        // Hashed here rather than taken from the puzzle index, which can lag behind a file that has just changed
+        char puzzle_path[256];
+        char thumbnail_path[256];
+        snprintf(puzzle_path, sizeof(puzzle_path), "./puzzles/%s", batch->puzzle_files[index]);
+        uint64_t content_hash = puzzle_index_hash_file(puzzle_path);
+        get_thumbnail_path(content_hash, thumbnail_path);
+
+        Uint32* pixels = (Uint32*)malloc(THUMBNAIL_WIDTH * THUMBNAIL_HEIGHT * sizeof(Uint32));
+        if(content_hash != 0 && thumbnail_load_cached(thumbnail_path, pixels)){
+
+            SDL_AtomicAdd(&batch->cached_count, 1);
+
+        }else{
+
+            State* initial_state = get_from_file(batch->puzzle_files[index]);
+            if(initial_state == NULL){
+
+                free(pixels);
+                SDL_AtomicSet(&batch->status[index], THUMBNAIL_FAILED);
+                continue;
+            }
+            thumbnail_render_state(&worker->framebuffer, &worker->sprites, initial_state);
+            memcpy(pixels, worker->framebuffer.pixels, THUMBNAIL_WIDTH * THUMBNAIL_HEIGHT * sizeof(Uint32));
+            free(initial_state);
+
+            if(content_hash != 0){
+
+                thumbnail_save(thumbnail_path, pixels);
+            }
+            SDL_AtomicAdd(&batch->rendered_count, 1);
+        }
+
+        // SDL_AtomicSet is a full barrier, so whoever sees the status also sees the pixels
+        batch->pixels[index] = pixels;
+        SDL_AtomicSet(&batch->status[index], THUMBNAIL_READY);
+    }
+
+    return 0;
+}
+
+bool thumbnail_batch_start(ThumbnailBatch* batch, char** puzzle_files, int puzzle_count, int thread_count){
+
+    batch->puzzle_count = puzzle_files != NULL ? puzzle_count : 0;
+    batch->puzzle_files = (char**)malloc((batch->puzzle_count + 1) * sizeof(char*));
+    for(int i = 0; i < batch->puzzle_count; i++){
+
+        batch->puzzle_files[i] = (char*)malloc(strlen(puzzle_files[i]) + 1);
+        strcpy(batch->puzzle_files[i], puzzle_files[i]);
+    }
+    batch->status = (SDL_atomic_t*)calloc(batch->puzzle_count + 1, sizeof(SDL_atomic_t));
+    batch->pixels = (Uint32**)calloc(batch->puzzle_count + 1, sizeof(Uint32*));
+    batch->textures = (SDL_Texture**)calloc(batch->puzzle_count + 1, sizeof(SDL_Texture*));
+    batch->mutex = SDL_CreateMutex();
+    batch->next_puzzle = 0;
+    batch->window_end = 0;
+    SDL_AtomicSet(&batch->finish, 0);
+    SDL_AtomicSet(&batch->cancel, 0);
+    batch->wake = SDL_CreateSemaphore(0);
+    batch->window_first = 0;
+    batch->window_last = 0;
+    batch->held_first = 0;
+    batch->held_last = 0;
+    SDL_AtomicSet(&batch->rendered_count, 0);
+    SDL_AtomicSet(&batch->cached_count, 0);
+
+    // Missing sprites just aren't drawn, the rest of the preview is still worth having
+    thumbnail_sprites_load(&batch->sprites);
+
+    if(thread_count < 1){
+
+        thread_count = SDL_GetCPUCount();
+        if(thread_count > THUMBNAIL_MAX_THREADS){
+
+            thread_count = THUMBNAIL_MAX_THREADS;
+        }
+    }
+    if(thread_count > batch->puzzle_count){
+
+        thread_count = batch->puzzle_count;
+    }
+    if(thread_count < 1){
+
+        thread_count = 1;
+    }
+
+    batch->worker_count = thread_count;
+    batch->workers = (ThumbnailWorker*)malloc((thread_count + 1) * sizeof(ThumbnailWorker));
+    int started_count = 0;
+    for(int i = 0; i < thread_count; i++){
+
+        ThumbnailWorker* worker = &batch->workers[i];
+        worker->batch = batch;
+        thumbnail_sprites_share(&worker->sprites, &batch->sprites);
+        worker->framebuffer.width = THUMBNAIL_WIDTH;
+        worker->framebuffer.height = THUMBNAIL_HEIGHT;
+        worker->framebuffer.pixels = (Uint32*)malloc(THUMBNAIL_WIDTH * THUMBNAIL_HEIGHT * sizeof(Uint32));
+        worker->framebuffer.texture = NULL;
+        worker->thread = SDL_CreateThread(thumbnail_thread, "thumbnail", worker);
+        if(worker->thread != NULL){
+
+            started_count++;
+        }
+    }
+    if(started_count == 0 && batch->puzzle_count > 0){
+
+        printf("Unable to start thumbnail threads! SDL Error: %s\n", SDL_GetError());
+        thumbnail_batch_stop(batch);
+        return false;
+    }
+
+    return true;
+}
+
+void thumbnail_batch_request(ThumbnailBatch* batch, int first, int last){
+
+    first = first < 0 ? 0 : first;
+    last = last > batch->puzzle_count ? batch->puzzle_count : last;
+    if(first == batch->window_first && last == batch->window_last){
+
+        return;
+    }
+
+    /*
+     * Once a worker has marked a preview READY it belongs to this thread, so it can be thrown away
+     * here. One still being drawn can't be yet, so it stays in the held range and goes next time,
+     * otherwise it would finish outside every window and never be dropped.
+     */
+    SDL_LockMutex(batch->mutex);
+    int held_first = first;
+    int held_last = last;
+    for(int i = batch->held_first; i < batch->held_last; i++){
+
+        if(i >= first && i < last){
+
+            continue;
+        }
+
+        int status = SDL_AtomicGet(&batch->status[i]);
+        if(status == THUMBNAIL_READY){
+
+            if(batch->textures[i] != NULL){
+
+                SDL_DestroyTexture(batch->textures[i]);
+                batch->textures[i] = NULL;
+            }
+            free(batch->pixels[i]);
+            batch->pixels[i] = NULL;
+            SDL_AtomicSet(&batch->status[i], THUMBNAIL_PENDING);
+
+        }else if(status == THUMBNAIL_WORKING){
+
+            held_first = i < held_first ? i : held_first;
+            held_last = i + 1 > held_last ? i + 1 : held_last;
+        }
+    }
+    batch->window_first = first;
+    batch->window_last = last;
+    batch->held_first = held_first;
+    batch->held_last = held_last;
+
+    batch->next_puzzle = first;
+    batch->window_end = last;
+    SDL_UnlockMutex(batch->mutex);
+
+    for(int i = 0; i < batch->worker_count; i++){
+
+        SDL_SemPost(batch->wake);
+    }
+}
+
+SDL_Texture* thumbnail_batch_texture(ThumbnailBatch* batch, SDL_Renderer* renderer, int index){
+
+    if(index < 0 || index >= batch->puzzle_count){
+
+        return NULL;
+    }
+
+    // The status is read first, the pixels pointer is only meaningful once it says READY
+    if(batch->textures[index] == NULL && SDL_AtomicGet(&batch->status[index]) == THUMBNAIL_READY && batch->pixels[index] != NULL){
+
+        SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT);
+        if(texture != NULL){
+
+            SDL_UpdateTexture(texture, NULL, batch->pixels[index], THUMBNAIL_WIDTH * sizeof(Uint32));
+        }
+        free(batch->pixels[index]);
+        batch->pixels[index] = NULL;
+        batch->textures[index] = texture;
+    }
+
+    return batch->textures[index];
+}
+
+void thumbnail_batch_wait(ThumbnailBatch* batch){
+
+    SDL_AtomicSet(&batch->finish, 1);
+    for(int i = 0; i < batch->worker_count; i++){
+
+        SDL_SemPost(batch->wake);
+    }
+    for(int i = 0; i < batch->worker_count; i++){
+
+        if(batch->workers[i].thread != NULL){
+
+            SDL_WaitThread(batch->workers[i].thread, NULL);
+            batch->workers[i].thread = NULL;
+        }
+    }
+}
+
+void thumbnail_batch_stop(ThumbnailBatch* batch){
+
+    SDL_AtomicSet(&batch->cancel, 1);
+    thumbnail_batch_wait(batch);
+
+    for(int i = 0; i < batch->worker_count; i++){
+
+        thumbnail_sprites_unshare(&batch->workers[i].sprites);
+        framebuffer_free(&batch->workers[i].framebuffer);
+    }
+    free(batch->workers);
+    thumbnail_sprites_free(&batch->sprites);
+
+    for(int i = 0; i < batch->puzzle_count; i++){
+
+        if(batch->textures[i] != NULL){
+
+            SDL_DestroyTexture(batch->textures[i]);
+        }
+        free(batch->pixels[i]);
+        free(batch->puzzle_files[i]);
+    }
+    free(batch->textures);
+    free(batch->pixels);
+    free(batch->status);
+    free(batch->puzzle_files);
+    SDL_DestroySemaphore(batch->wake);
+    SDL_DestroyMutex(batch->mutex);
+    batch->workers = NULL;
+    batch->worker_count = 0;
+    batch->puzzle_count = 0;
+}
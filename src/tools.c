@@ -0,0 +1,1059 @@
+#include "tools.h"
+#include "solver.h"
+#include "replay.h"
+#include "solutiondb.h"
+#include "generator.h"
+#include "blitter.h"
+#include "thumbnail.h"
+#include "export.h"
+#include "assets.h"
+#include <dirent.h>
+#ifdef _WIN32
+    #include <direct.h>
+#else
+    #include <sys/stat.h>
+#endif
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+typedef struct Tool{
+
+    char* name;
+    char* usage;
+    int (*run)(int argc, char** argv);
+} Tool;
+
+Tool tools[] = {
+    { "--bench-dead", "--bench-dead [max states per puzzle]", bench_dead_states },
+    { "--check-canonical", "--check-canonical [games per puzzle] [moves per game] (random play from each puzzle and its canonical form, reporting moves where they disagree)", check_canonical },
+    { "--solve", "--solve <puzzle.duck> [ida|bfs] [table megabytes] [max depth] (without a mode, known solutions come from the solution database)", solve_puzzle },
+    { "--verify", "--verify [-j threads] <replay files or directories>...", verify_replays },
+    { "--generate", "--generate [-j threads] [-s seed] <count> [width] [height] [min moves] [max moves]", generate_puzzle_set },
+    { "--bench-blit", "--bench-blit [frames] (SDL's software renderer against the --blitter framebuffer)", bench_blitter },
+    { "--bench-assets", "--bench-assets [runs] (time from starting the game to its first frame, loading from ./res against the built in sprites and font)", bench_assets },
+    { "--thumbnails", "--thumbnails [-j threads] (draws the menu's puzzle previews into ./thumbnails ahead of time)", render_thumbnails },
+    { "--export", "--export <puzzle.duck> [moves like RRDl or a .replay] [-j threads] [-o directory, or - for raw 640x360 RGBA to pipe into ffmpeg -f rawvideo -pix_fmt rgba -s 640x360 -r 60 -i -] [-f frames per move] [-z zoom 0-6] (without moves, the solution database's solution)", export_replay },
+};
+const int TOOL_COUNT = sizeof(tools) / sizeof(Tool);
+
+// argv[0], for tools that start the game again
+char* tool_program = NULL;
+
+int run_tool(int argc, char** argv){
+
+    tool_program = argv[0];
+    if(argc < 2){
+
+        return -1;
+    }
+
+    for(int i = 0; i < TOOL_COUNT; i++){
+
+        if(strcmp(argv[1], tools[i].name) == 0){
+
+            return tools[i].run(argc - 2, argv + 2);
+        }
+    }
+
+    if(strcmp(argv[1], "--help") == 0){
+
+        printf("Usage:\n");
+        printf("    %s [--blitter] [--scale [N]] [--res] (--blitter composites the map on the CPU instead of with SDL_RenderCopy)\n", argv[0]);
+        printf("        (--scale draws at 640x360 and scales up by whole steps, fullscreen or in a window N times that size)\n");
+        printf("        (--res loads the sprites and font from ./res instead of the ones built in)\n");
+        for(int i = 0; i < TOOL_COUNT; i++){
+
+            printf("    %s %s\n", argv[0], tools[i].usage);
+        }
+        return 0;
+    }
+
+    return -1;
+}
+
+double seconds_since(Uint64 start_time){
+
+    return (SDL_GetPerformanceCounter() - start_time) / (double)SDL_GetPerformanceFrequency();
+}
+
+/*
+ * Breadth first search over the distinct states of a puzzle, up to max_states of them.
+ * With prune_dead set, states flagged by state_is_dead are counted but not expanded.
+ */
+void bench_explore(State* initial_state, int max_states, bool prune_dead, int* expanded_count, int* dead_count, double* dead_seconds){
+
+    int table_capacity = 1;
+    while(table_capacity < max_states * 2){
+
+        table_capacity *= 2;
+    }
+    uint64_t* table = (uint64_t*)calloc(table_capacity, sizeof(uint64_t));
+    State* queue = (State*)malloc(max_states * sizeof(State));
+    int queue_head = 0;
+    int queue_size = 0;
+
+    *expanded_count = 0;
+    *dead_count = 0;
+    *dead_seconds = 0;
+
+    queue[queue_size] = *initial_state;
+    queue[queue_size].previous_state = NULL;
+    queue_size++;
+    uint64_t initial_hash = canonical_hash(initial_state) | 1;
+    table[initial_hash & (table_capacity - 1)] = initial_hash;
+
+    while(queue_head < queue_size){
+
+        State* current_state = &queue[queue_head];
+        queue_head++;
+
+        if(current_state->victory != 0){
+
+            continue;
+        }
+
+        Uint64 start_time = SDL_GetPerformanceCounter();
+        bool dead = state_is_dead(current_state);
+        *dead_seconds += seconds_since(start_time);
+        if(dead){
+
+            (*dead_count)++;
+            if(prune_dead){
+
+                continue;
+            }
+        }
+
+        (*expanded_count)++;
+
+        int moves[MAX_GENERATED_MOVES];
+        int move_count = generate_moves(current_state, moves);
+        for(int i = 0; i < move_count && queue_size < max_states; i++){
+
+            State next_state = *current_state;
+            simulate_move(&next_state, current_state, MOVE_CODE(moves[i]), NULL);
+
+            // Zero marks an empty slot, so every stored hash gets its low bit set
+            uint64_t hash = canonical_hash(&next_state) | 1;
+            int slot = hash & (table_capacity - 1);
+            while(table[slot] != 0 && table[slot] != hash){
+
+                slot = (slot + 1) & (table_capacity - 1);
+            }
+            if(table[slot] == hash){
+
+                continue;
+            }
+            table[slot] = hash;
+
+            queue[queue_size] = next_state;
+            queue_size++;
+        }
+    }
+
+    free(table);
+    free(queue);
+}
+
+/*
+ * Checks state_is_dead against the unpruned search. Every exact state of the puzzle up to max_states is
+ * explored with all of its edges kept, then which of them can still be won is worked out backwards from the
+ * winning ones. A flagged state that can be won is a false positive. One that can't, but leads somewhere the
+ * search ran out of room before reaching, can't be settled either way and counts as unchecked.
+ * Exact rather than canonical hashes, so no two states that play out differently are ever merged.
+ */
+void bench_check_dead(State* initial_state, int max_states, int* flagged_count, int* false_count, int* unchecked_count){
+
+    int table_capacity = 1;
+    while(table_capacity < max_states * 2){
+
+        table_capacity *= 2;
+    }
+    uint64_t* table = (uint64_t*)calloc(table_capacity, sizeof(uint64_t));
+    int* table_index = (int*)malloc(table_capacity * sizeof(int));
+    State* states = (State*)malloc(max_states * sizeof(State));
+    int* children = (int*)malloc((long)max_states * MAX_GENERATED_MOVES * sizeof(int));
+    int* child_counts = (int*)calloc(max_states, sizeof(int));
+    bool* dead = (bool*)calloc(max_states, sizeof(bool));
+    bool* winnable = (bool*)calloc(max_states, sizeof(bool));
+    bool* open = (bool*)calloc(max_states, sizeof(bool)); // something past the edge of the search is reachable
+
+    int state_count = 1;
+    states[0] = *initial_state;
+    states[0].previous_state = NULL;
+    uint64_t initial_hash = hash_state(&states[0]) | 1;
+    table[initial_hash & (table_capacity - 1)] = initial_hash;
+    table_index[initial_hash & (table_capacity - 1)] = 0;
+
+    for(int head = 0; head < state_count; head++){
+
+        State* current_state = &states[head];
+        if(current_state->victory != 0){
+
+            winnable[head] = current_state->victory == 1;
+            continue;
+        }
+        dead[head] = state_is_dead(current_state);
+
+        int moves[MAX_GENERATED_MOVES];
+        int move_count = generate_moves(current_state, moves);
+        for(int i = 0; i < move_count; i++){
+
+            State next_state = *current_state;
+            simulate_move(&next_state, current_state, MOVE_CODE(moves[i]), NULL);
+            next_state.previous_state = NULL;
+
+            uint64_t hash = hash_state(&next_state) | 1;
+            int slot = hash & (table_capacity - 1);
+            while(table[slot] != 0 && table[slot] != hash){
+
+                slot = (slot + 1) & (table_capacity - 1);
+            }
+
+            int child = -1;
+            if(table[slot] == hash){
+
+                child = table_index[slot];
+
+            }else if(state_count < max_states){
+
+                child = state_count;
+                states[state_count] = next_state;
+                state_count++;
+                table[slot] = hash;
+                table_index[slot] = child;
+            }
+
+            if(child == -1){
+
+                open[head] = true;
+
+            }else{
+
+                children[((long)head * MAX_GENERATED_MOVES) + child_counts[head]] = child;
+                child_counts[head]++;
+            }
+        }
+    }
+
+    // Both spread from child to parent, so passes from the deepest states up until nothing changes
+    bool changed = true;
+    while(changed){
+
+        changed = false;
+        for(int i = state_count - 1; i >= 0; i--){
+
+            for(int j = 0; j < child_counts[i]; j++){
+
+                int child = children[((long)i * MAX_GENERATED_MOVES) + j];
+                if(winnable[child] && !winnable[i]){
+
+                    winnable[i] = true;
+                    changed = true;
+                }
+                if(open[child] && !open[i]){
+
+                    open[i] = true;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    *flagged_count = 0;
+    *false_count = 0;
+    *unchecked_count = 0;
+    for(int i = 0; i < state_count; i++){
+
+        if(dead[i]){
+
+            (*flagged_count)++;
+            if(winnable[i]){
+
+                (*false_count)++;
+
+            }else if(open[i]){
+
+                (*unchecked_count)++;
+            }
+        }
+    }
+
+    free(table);
+    free(table_index);
+    free(states);
+    free(children);
+    free(child_counts);
+    free(dead);
+    free(winnable);
+    free(open);
+}
+
+int bench_dead_states(int argc, char** argv){
+
+    int max_states = 200000;
+    if(argc > 0){
+
+        max_states = atoi(argv[0]);
+    }
+    if(max_states <= 0 || max_states > 4000000){
+
+        printf("The state limit has to be between 1 and 4000000!\n");
+        return 1;
+    }
+
+    int puzzle_count = 0;
+    char** puzzle_files = generate_puzzle_list(&puzzle_count);
+    if(puzzle_files == NULL || puzzle_count == 0){
+
+        printf("No puzzles found!\n");
+        return 1;
+    }
+
+    printf("%-24s %10s %10s %8s %10s %8s %10s %8s\n", "puzzle", "expanded", "dead", "dead %", "pruned", "saved %", "ns/check", "false +");
+
+    long total_expanded = 0;
+    long total_pruned = 0;
+    long total_flagged = 0;
+    long total_false = 0;
+    long total_unchecked = 0;
+    for(int i = 0; i < puzzle_count; i++){
+
+        State* initial_state = get_from_file(puzzle_files[i]);
+        if(initial_state == NULL){
+
+            continue;
+        }
+
+        int full_expanded, full_dead, pruned_expanded, pruned_dead;
+        double full_seconds, pruned_seconds;
+        bench_explore(initial_state, max_states, false, &full_expanded, &full_dead, &full_seconds);
+        bench_explore(initial_state, max_states, true, &pruned_expanded, &pruned_dead, &pruned_seconds);
+        int flagged, false_positives, unchecked;
+        bench_check_dead(initial_state, max_states, &flagged, &false_positives, &unchecked);
+
+        // Without pruning every non-terminal state is both checked and expanded
+        printf("%-24s %10i %10i %7.1f%% %10i %7.1f%% %10.0f %8i\n", puzzle_files[i], full_expanded, full_dead,
+               full_expanded == 0 ? 0 : (100.0 * full_dead) / full_expanded, pruned_expanded,
+               full_expanded == 0 ? 0 : 100.0 * (full_expanded - pruned_expanded) / full_expanded,
+               full_expanded == 0 ? 0 : (1e9 * full_seconds) / full_expanded, false_positives);
+
+        total_expanded += full_expanded;
+        total_pruned += pruned_expanded;
+        total_flagged += flagged;
+        total_false += false_positives;
+        total_unchecked += unchecked;
+        free(initial_state);
+    }
+    free_puzzle_list(puzzle_files, puzzle_count);
+
+    if(total_expanded != 0){
+
+        printf("Total: %li states expanded without pruning, %li with, %.1f%% saved\n", total_expanded, total_pruned, 100.0 * (total_expanded - total_pruned) / total_expanded);
+    }
+    printf("Checked against the unpruned search: %li states flagged dead, %li of them winnable, %li not settled within the state limit\n", total_flagged, total_false, total_unchecked);
+
+    return total_false == 0 ? 0 : 2;
+}
+
+/*
+ * Plays random games from each puzzle and, in step, from the canonical form of every state along the way,
+ * checking the equivalence canonicalize_state claims: both successors must have the same canonical form.
+ */
+int check_canonical(int argc, char** argv){
+
+    int game_count = argc > 0 ? atoi(argv[0]) : 100;
+    int move_limit = argc > 1 ? atoi(argv[1]) : 200;
+    if(game_count <= 0 || move_limit <= 0){
+
+        printf("The game and move counts have to be positive!\n");
+        return 1;
+    }
+
+    int puzzle_count = 0;
+    char** puzzle_files = generate_puzzle_list(&puzzle_count);
+    if(puzzle_files == NULL){
+
+        printf("No puzzles found!\n");
+        return 1;
+    }
+
+    unsigned int rng = 1;
+    long checked_moves = 0;
+    long disagreements = 0;
+    for(int i = 0; i < puzzle_count; i++){
+
+        State* initial_state = get_from_file(puzzle_files[i]);
+        if(initial_state == NULL){
+
+            continue;
+        }
+
+        for(int game = 0; game < game_count; game++){
+
+            State current_state = *initial_state;
+            for(int move = 0; move < move_limit && current_state.victory == 0; move++){
+
+                int moves[MAX_GENERATED_MOVES];
+                int move_count = generate_moves(&current_state, moves);
+                if(move_count == 0){
+
+                    break;
+                }
+                rng = (rng * 1103515245u) + 12345u;
+                int player_move = MOVE_CODE(moves[(rng >> 16) % move_count]);
+
+                State canonical_state = current_state;
+                canonicalize_state(&canonical_state);
+                State previous_state = current_state;
+                State previous_canonical_state = canonical_state;
+                simulate_move(&current_state, &previous_state, player_move, NULL);
+                simulate_move(&canonical_state, &previous_canonical_state, player_move, NULL);
+                canonicalize_state(&canonical_state);
+
+                State expected_state = current_state;
+                canonicalize_state(&expected_state);
+                checked_moves++;
+                if(!states_equal(&expected_state, &canonical_state)){
+
+                    if(disagreements < 10){
+
+                        printf("%s: game %i, move %i (%c) comes out differently from the canonical form\n", puzzle_files[i], game, move, get_move_char(player_move));
+                    }
+                    disagreements++;
+                }
+            }
+        }
+        free(initial_state);
+    }
+    free_puzzle_list(puzzle_files, puzzle_count);
+
+    printf("%li moves checked over %i puzzles, %li disagreed\n", checked_moves, puzzle_count, disagreements);
+
+    return disagreements == 0 ? 0 : 2;
+}
+
+int solve_puzzle(int argc, char** argv){
+
+    if(argc < 1){
+
+        printf("Which puzzle should be solved?\n");
+        return 1;
+    }
+
+    SolverOptions options;
+    solver_default_options(&options);
+    if(argc > 1 && strcmp(argv[1], "bfs") == 0){
+
+        options.mode = SOLVER_MODE_BFS;
+    }
+    if(argc > 2){
+
+        options.table_megabytes = atoi(argv[2]);
+    }
+    if(argc > 3){
+
+        options.max_depth = atoi(argv[3]);
+        if(options.max_depth <= 0){
+
+            printf("The max depth has to be positive!\n");
+            return 1;
+        }
+    }
+
+    State* initial_state = get_from_file(argv[0]);
+    if(initial_state == NULL){
+
+        return 1;
+    }
+
+    uint64_t puzzle_hash = get_puzzle_hash(initial_state);
+    SolutionRecord record;
+    if(argc == 1 && solution_db_lookup(puzzle_hash, &record)){
+
+        free(initial_state);
+        if(record.solvable){
+
+            char solution_text[SOLVER_MAX_DEPTH + 1];
+            for(int i = 0; i < record.move_count; i++){
+
+                solution_text[i] = get_move_char(record.moves[i]);
+            }
+            solution_text[record.move_count] = '\0';
+            printf("Solved in %i moves: %s\n", record.move_count, solution_text);
+
+        }else{
+
+            printf("No solution within %i moves\n", SOLVER_MAX_DEPTH);
+        }
+        printf("From the solution database, originally %li nodes in %.3fs\n", record.nodes, record.milliseconds / 1000.0);
+
+        return record.solvable ? 0 : 2;
+    }
+
+    SolverResult result;
+    solve_state(initial_state, &options, &result);
+    free(initial_state);
+    solution_db_store(puzzle_hash, &result);
+
+    if(result.solved){
+
+        char solution_text[SOLVER_MAX_DEPTH + 1];
+        for(int i = 0; i < result.move_count; i++){
+
+            solution_text[i] = get_move_char(result.moves[i]);
+        }
+        solution_text[result.move_count] = '\0';
+        printf("Solved in %i moves: %s\n", result.move_count, solution_text);
+
+    }else if(result.exhausted){
+
+        printf("No solution within %i moves\n", options.max_depth < SOLVER_MAX_DEPTH ? options.max_depth : SOLVER_MAX_DEPTH);
+
+    }else{
+
+        printf("Gave up after %li nodes\n", result.nodes);
+    }
+
+    printf("Mode: %s, nodes: %li, time: %.3fs, nodes/s: %.0f, peak memory: %li KB\n", options.mode == SOLVER_MODE_BFS ? "bfs" : "ida*",
+           result.nodes, result.seconds, result.seconds > 0 ? result.nodes / result.seconds : 0, result.peak_memory_kb);
+
+    return result.solved ? 0 : 2;
+}
+
+int verify_replays(int argc, char** argv){
+
+    int thread_count = SDL_GetCPUCount();
+    int path_count = 0;
+    int path_capacity = 64;
+    char** paths = (char**)malloc(path_capacity * sizeof(char*));
+
+    for(int i = 0; i < argc; i++){
+
+        if(strcmp(argv[i], "-j") == 0 && i + 1 < argc){
+
+            thread_count = atoi(argv[i + 1]);
+            i++;
+            continue;
+        }
+
+        // Directories contribute every .replay file inside them
+        DIR* dir = opendir(argv[i]);
+        if(dir == NULL){
+
+            if(path_count == path_capacity){
+
+                path_capacity *= 2;
+                paths = (char**)realloc(paths, path_capacity * sizeof(char*));
+            }
+            paths[path_count] = (char*)malloc(strlen(argv[i]) + 1);
+            strcpy(paths[path_count], argv[i]);
+            path_count++;
+            continue;
+        }
+
+        struct dirent* ent;
+        while((ent = readdir(dir)) != NULL){
+
+            int name_length = strlen(ent->d_name);
+            if(name_length > 7 && strcmp(ent->d_name + name_length - 7, ".replay") == 0){
+
+                if(path_count == path_capacity){
+
+                    path_capacity *= 2;
+                    paths = (char**)realloc(paths, path_capacity * sizeof(char*));
+                }
+                paths[path_count] = (char*)malloc(strlen(argv[i]) + name_length + 2);
+                sprintf(paths[path_count], "%s/%s", argv[i], ent->d_name);
+                path_count++;
+            }
+        }
+        closedir(dir);
+    }
+
+    if(path_count == 0){
+
+        printf("No replays to verify!\n");
+        free(paths);
+        return 1;
+    }
+
+    int* verdicts = (int*)malloc(path_count * sizeof(int));
+    ReplayVerifyResult result;
+    replay_verify_files(paths, path_count, thread_count, verdicts, &result);
+
+    for(int i = 0; i < path_count; i++){
+
+        if(verdicts[i] != 1){
+
+            printf("%s: %s\n", paths[i], verdicts[i] == 0 ? "outcome mismatch" : "invalid");
+        }
+        free(paths[i]);
+    }
+    free(paths);
+    free(verdicts);
+
+    printf("%i replays: %i valid, %i mismatched, %i invalid\n", result.replay_count, result.valid_count, result.mismatch_count, result.invalid_count);
+    if(result.known_win_count != 0){
+
+        printf("%i of %i wins with a known optimal solution took the fewest moves possible\n", result.optimal_win_count, result.known_win_count);
+    }
+    printf("%li moves in %.3fs on %i threads, %.0f replays/s, %.0f moves/s\n", result.move_count, result.seconds, thread_count,
+           result.seconds > 0 ? result.replay_count / result.seconds : 0, result.seconds > 0 ? result.move_count / result.seconds : 0);
+
+    return result.valid_count == result.replay_count ? 0 : 2;
+}
+
+int generate_puzzle_set(int argc, char** argv){
+
+    GeneratorOptions options;
+    generator_default_options(&options);
+
+    int positional_count = 0;
+    for(int i = 0; i < argc; i++){
+
+        if(strcmp(argv[i], "-j") == 0 && i + 1 < argc){
+
+            options.thread_count = atoi(argv[i + 1]);
+            i++;
+
+        }else if(strcmp(argv[i], "-s") == 0 && i + 1 < argc){
+
+            options.seed = atoi(argv[i + 1]);
+            i++;
+
+        }else{
+
+            int value = atoi(argv[i]);
+            if(positional_count == 0){
+
+                options.puzzle_count = value;
+
+            }else if(positional_count == 1){
+
+                options.map_width = value;
+
+            }else if(positional_count == 2){
+
+                options.map_height = value;
+
+            }else if(positional_count == 3){
+
+                options.min_moves = value;
+
+            }else if(positional_count == 4){
+
+                options.max_moves = value;
+            }
+            positional_count++;
+        }
+    }
+
+    if(positional_count == 0){
+
+        printf("How many puzzles should be generated?\n");
+        return 1;
+    }
+
+    GeneratorResult result;
+    generate_puzzles(&options, &result);
+
+    printf("%i puzzles from %lli candidates: %lli trivial, %lli unsolved, %lli duplicates\n", result.accepted_count, (long long)result.candidate_count,
+           (long long)result.trivial_count, (long long)result.unsolved_count, (long long)result.duplicate_count);
+    for(int i = 0; i <= SOLVER_MAX_DEPTH; i++){
+
+        if(result.move_histogram[i] != 0){
+
+            printf("%4i moves: %i\n", i, result.move_histogram[i]);
+        }
+    }
+    printf("%.3fs on %i threads, %.0f puzzles/min\n", result.seconds, result.thread_count, result.seconds > 0 ? 60 * result.accepted_count / result.seconds : 0);
+
+    return result.accepted_count == options.puzzle_count ? 0 : 2;
+}
+
+#define BENCH_SPRITE_COUNT 5
+#define BENCH_WIDTH 640
+#define BENCH_HEIGHT 360
+
+/*
+ * Draws the same scene as render_state, a screen of grass plus every entity slot filled, half of
+ * them mirrored, both through an SDL software renderer and through the framebuffer.
+ */
+void bench_draw_scene(SDL_Renderer* renderer, SDL_Texture** textures, Framebuffer* framebuffer, BlitSprite* sprites, int tile_size){
+
+    int columns = (BENCH_WIDTH + tile_size - 1) / tile_size;
+    int rows = (BENCH_HEIGHT + tile_size - 1) / tile_size;
+    int entity_count = 1 + MAX_DUCK_COUNT + MAX_BREAD_COUNT + MAX_GOOSE_COUNT;
+
+    if(framebuffer != NULL){
+
+        framebuffer_clear(framebuffer, 0xFF000000);
+
+    }else{
+
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+    }
+
+    for(int i = 0; i < columns * rows + entity_count; i++){
+
+        int sprite = 0;
+        int x = i % columns;
+        int y = i / columns;
+        if(i >= columns * rows){
+
+            int entity = i - (columns * rows);
+            sprite = 1 + (entity % (BENCH_SPRITE_COUNT - 1));
+            x = (entity * 7) % columns;
+            y = (entity * 5) % rows;
+        }
+        bool flipped = sprite != 0 && i % 2 == 1;
+
+        if(framebuffer != NULL){
+
+            framebuffer_blit(framebuffer, &sprites[sprite], x * tile_size, y * tile_size, tile_size, flipped);
+
+        }else{
+
+            SDL_Rect dest_rect = { .x = x * tile_size, .y = y * tile_size, .w = tile_size, .h = tile_size };
+            SDL_RenderCopyEx(renderer, textures[sprite], NULL, &dest_rect, 0, NULL, flipped ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE);
+        }
+    }
+
+    if(framebuffer != NULL){
+
+        framebuffer_present(framebuffer, renderer);
+    }
+}
+
+void bench_blitter_free(SDL_Renderer* renderer, SDL_Surface* target, SDL_Texture** textures, BlitSprite* sprites){
+
+    for(int i = 0; i < BENCH_SPRITE_COUNT; i++){
+
+        if(textures[i] != NULL){
+
+            SDL_DestroyTexture(textures[i]);
+        }
+        blit_sprite_free(&sprites[i]);
+    }
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(target);
+}
+
+int bench_blitter(int argc, char** argv){
+
+    int frame_count = 300;
+    if(argc > 0){
+
+        frame_count = atoi(argv[0]);
+    }
+    if(frame_count < 1){
+
+        printf("The frame count has to be positive!\n");
+        return 1;
+    }
+
+    char* sprite_names[BENCH_SPRITE_COUNT] = { "grass_tile.png", "momduck_leftright.png", "babyduck_leftright.png", "bread.png", "goose_leftright.png" };
+    SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, BENCH_WIDTH, BENCH_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* renderer = target != NULL ? SDL_CreateSoftwareRenderer(target) : NULL;
+    if(renderer == NULL){
+
+        printf("Unable to create a software renderer! SDL Error: %s\n", SDL_GetError());
+        SDL_FreeSurface(target);
+        return 1;
+    }
+
+    // Zeroed so that everything can be freed the same way whether or not it was loaded
+    SDL_Texture* textures[BENCH_SPRITE_COUNT] = { NULL };
+    BlitSprite sprites[BENCH_SPRITE_COUNT];
+    memset(sprites, 0, sizeof(sprites));
+    Framebuffer framebuffer;
+    bool loaded = true;
+    for(int i = 0; i < BENCH_SPRITE_COUNT && loaded; i++){
+
+        SDL_Surface* surface = assets_load_surface(sprite_names[i]);
+        if(surface == NULL){
+
+            loaded = false;
+            break;
+        }
+        textures[i] = SDL_CreateTextureFromSurface(renderer, surface);
+        loaded = textures[i] != NULL && blit_sprite_from_surface(&sprites[i], surface);
+        SDL_FreeSurface(surface);
+    }
+    if(loaded && !framebuffer_init(&framebuffer, renderer, BENCH_WIDTH, BENCH_HEIGHT)){
+
+        loaded = false;
+    }
+    if(!loaded){
+
+        bench_blitter_free(renderer, target, textures, sprites);
+        return 1;
+    }
+
+    printf("%i frames of %ix%i, blend kernel: %s\n", frame_count, BENCH_WIDTH, BENCH_HEIGHT, blitter_kernel_name());
+    printf("%-6s %14s %14s %8s\n", "tile", "renderer ms", "blitter ms", "speedup");
+
+    int tile_sizes[3] = { 16, 32, 64 };
+    for(int i = 0; i < 3; i++){
+
+        Uint64 start_time = SDL_GetPerformanceCounter();
+        for(int frame = 0; frame < frame_count; frame++){
+
+            bench_draw_scene(renderer, textures, NULL, sprites, tile_sizes[i]);
+        }
+        double renderer_ms = seconds_since(start_time) * 1000 / frame_count;
+
+        start_time = SDL_GetPerformanceCounter();
+        for(int frame = 0; frame < frame_count; frame++){
+
+            bench_draw_scene(renderer, textures, &framebuffer, sprites, tile_sizes[i]);
+        }
+        double blitter_ms = seconds_since(start_time) * 1000 / frame_count;
+
+        printf("%-6i %14.3f %14.3f %7.2fx\n", tile_sizes[i], renderer_ms, blitter_ms, blitter_ms > 0 ? renderer_ms / blitter_ms : 0);
+    }
+
+    framebuffer_free(&framebuffer);
+    bench_blitter_free(renderer, target, textures, sprites);
+
+    return 0;
+}
+
+#define BENCH_PROBE_PATH "./startup_probe.tmp"
+
+int bench_assets(int argc, char** argv){
+
+    int run_count = 10;
+    if(argc > 0){
+
+        run_count = atoi(argv[0]);
+    }
+    if(run_count < 1){
+
+        printf("The number of runs has to be at least 1!\n");
+        return 1;
+    }
+
+    // Each run starts the game itself, which prints its timings into BENCH_PROBE_PATH and quits once everything has loaded
+    printf("%i runs from starting %s to its first frame, and to the first with every sprite and font loaded\n", run_count, tool_program);
+    printf("%-12s %12s %14s\n", "", "./res ms", "embedded ms");
+
+    double first_frame_ms[2] = { 0, 0 };
+    double loaded_ms[2] = { 0, 0 };
+    for(int run = 0; run < run_count; run++){
+
+        for(int embedded = 0; embedded < 2; embedded++){
+
+            char command[512];
+            Uint64 start_time = SDL_GetPerformanceCounter();
+            snprintf(command, sizeof(command), "\"%s\" --startup-probe %llu%s > %s", tool_program, (unsigned long long)start_time, embedded ? "" : " --res", BENCH_PROBE_PATH);
+            system(command);
+
+            double first_frame = -1;
+            double loaded = -1;
+            FILE* probe = fopen(BENCH_PROBE_PATH, "r");
+            if(probe != NULL){
+
+                // Anything else is the game saying why it couldn't start
+                char line[256];
+                while(fgets(line, sizeof(line), probe) != NULL){
+
+                    if(sscanf(line, "first frame %lf", &first_frame) != 1 && sscanf(line, "loaded %lf", &loaded) != 1){
+
+                        printf("%s", line);
+                    }
+                }
+                fclose(probe);
+                remove(BENCH_PROBE_PATH);
+            }
+            if(first_frame < 0 || loaded < 0){
+
+                printf("The game quit before drawing everything!\n");
+                return 1;
+            }
+            first_frame_ms[embedded] += first_frame;
+            loaded_ms[embedded] += loaded;
+        }
+    }
+    printf("%-12s %12.3f %14.3f\n", "first frame", first_frame_ms[0] / run_count, first_frame_ms[1] / run_count);
+    printf("%-12s %12.3f %14.3f\n", "loaded", loaded_ms[0] / run_count, loaded_ms[1] / run_count);
+
+    return 0;
+}
+
+int render_thumbnails(int argc, char** argv){
+
+    int thread_count = 0;
+    for(int i = 0; i < argc; i++){
+
+        if(strcmp(argv[i], "-j") == 0 && i + 1 < argc){
+
+            thread_count = atoi(argv[i + 1]);
+            i++;
+        }
+    }
+
+    int puzzle_count = 0;
+    char** puzzle_files = generate_puzzle_list(&puzzle_count);
+    if(puzzle_files == NULL || puzzle_count == 0){
+
+        printf("No puzzles to draw!\n");
+        return 1;
+    }
+
+    Uint64 start_time = SDL_GetPerformanceCounter();
+    ThumbnailBatch batch;
+    if(!thumbnail_batch_start(&batch, puzzle_files, puzzle_count, thread_count)){
+
+        free_puzzle_list(puzzle_files, puzzle_count);
+        return 1;
+    }
+    thumbnail_batch_request(&batch, 0, puzzle_count);
+    thumbnail_batch_wait(&batch);
+    double seconds = seconds_since(start_time);
+
+    int failed_count = 0;
+    for(int i = 0; i < puzzle_count; i++){
+
+        if(SDL_AtomicGet(&batch.status[i]) != THUMBNAIL_READY){
+
+            failed_count++;
+        }
+    }
+    printf("Thumbnails: %i, rendered: %i, cached: %i, failed: %i, threads: %i, time: %.3fs\n", puzzle_count,
+           SDL_AtomicGet(&batch.rendered_count), SDL_AtomicGet(&batch.cached_count), failed_count, batch.worker_count, seconds);
+    thumbnail_batch_stop(&batch);
+    free_puzzle_list(puzzle_files, puzzle_count);
+
+    return failed_count == 0 ? 0 : 2;
+}
+
+int export_replay(int argc, char** argv){
+
+    ExportOptions options;
+    export_default_options(&options);
+    char* move_source = NULL;
+
+    for(int i = 0; i < argc; i++){
+
+        if(strcmp(argv[i], "-j") == 0 && i + 1 < argc){
+
+            options.thread_count = atoi(argv[i + 1]);
+            i++;
+
+        }else if(strcmp(argv[i], "-o") == 0 && i + 1 < argc){
+
+            options.output = argv[i + 1];
+            i++;
+
+        }else if(strcmp(argv[i], "-f") == 0 && i + 1 < argc){
+
+            options.frames_per_move = atoi(argv[i + 1]);
+            i++;
+
+        }else if(strcmp(argv[i], "-z") == 0 && i + 1 < argc){
+
+            options.zoom = atoi(argv[i + 1]);
+            i++;
+
+        }else if(options.puzzle_filename == NULL){
+
+            options.puzzle_filename = argv[i];
+
+        }else{
+
+            move_source = argv[i];
+        }
+    }
+
+    // Messages go to stderr, stdout may be the video
+    if(options.puzzle_filename == NULL){
+
+        fprintf(stderr, "Usage: --export <puzzle.duck> [moves or replay file] [-j threads] [-o directory or -] [-f frames per move] [-z zoom]\n");
+        return 1;
+    }
+
+    char default_output[128];
+    if(options.output == NULL){
+
+        char puzzle_name[64];
+        strncpy(puzzle_name, options.puzzle_filename, 63);
+        puzzle_name[63] = '\0';
+        char* extension = strstr(puzzle_name, ".duck");
+        if(extension != NULL){
+
+            *extension = '\0';
+        }
+        #ifdef _WIN32
+            _mkdir("./videos");
+        #else
+            mkdir("./videos", 0755);
+        #endif
+        sprintf(default_output, "./videos/%s", puzzle_name);
+        options.output = default_output;
+    }
+
+    int move_length = move_source != NULL ? strlen(move_source) : 0;
+    Replay replay;
+    if(move_source != NULL && move_length > 7 && strcmp(move_source + move_length - 7, ".replay") == 0){
+
+        if(!replay_load(&replay, move_source)){
+
+            fprintf(stderr, "Unable to load replay %s!\n", move_source);
+            return 1;
+        }
+        options.move_count = replay.move_count;
+        options.moves = (int*)malloc((replay.move_count + 1) * sizeof(int));
+        for(int i = 0; i < replay.move_count; i++){
+
+            options.moves[i] = replay_get_move(&replay, i);
+        }
+        replay_free(&replay);
+
+    }else if(move_source != NULL){
+
+        options.move_count = move_length;
+        options.moves = (int*)malloc((move_length + 1) * sizeof(int));
+        for(int i = 0; i < move_length; i++){
+
+            options.moves[i] = get_move_from_char(move_source[i]);
+            if(options.moves[i] == NOTHING){
+
+                fprintf(stderr, "Unknown move '%c'!\n", move_source[i]);
+                free(options.moves);
+                return 1;
+            }
+        }
+
+    }else{
+
+        State* initial_state = get_from_file(options.puzzle_filename);
+        SolutionRecord record;
+        if(initial_state == NULL || !solution_db_lookup(get_puzzle_hash(initial_state), &record) || !record.solvable){
+
+            fprintf(stderr, "No known solution for %s, run --solve on it first or give the moves!\n", options.puzzle_filename);
+            free(initial_state);
+            return 1;
+        }
+        free(initial_state);
+        options.move_count = record.move_count;
+        options.moves = (int*)malloc((record.move_count + 1) * sizeof(int));
+        memcpy(options.moves, record.moves, record.move_count * sizeof(int));
+    }
+
+    ExportResult result;
+    bool success = export_video(&options, &result);
+    free(options.moves);
+    if(!success){
+
+        fprintf(stderr, "Export failed!\n");
+        return 2;
+    }
+
+    fprintf(stderr, "Frames: %i, %ix%i, threads: %i, time: %.3fs, frames/s: %.1f, output: %s\n", result.frame_count, EXPORT_WIDTH, EXPORT_HEIGHT,
+            result.thread_count, result.seconds, result.seconds > 0 ? result.frame_count / result.seconds : 0, options.output);
+
+    return 0;
+}
@@ -0,0 +1,261 @@
+#include "upscale.h"
+
+// SSE2 is part of x86_64 itself, so unlike the blitter there's no need to ask the CPU first
+#if defined(__x86_64__) && defined(__GNUC__)
+    #define UPSCALE_SSE2
+    #include <emmintrin.h>
+#endif
+
+void upscale_row_scalar(Uint32* dest, Uint32* source, int width, int scale){
+
+    for(int i = 0; i < width; i++){
+
+        Uint32 pixel = source[i];
+        for(int j = 0; j < scale; j++){
+
+            *dest++ = pixel;
+        }
+    }
+}
+
+#ifdef UPSCALE_SSE2
+
+/*
+ * The small factors, which are what fit on ordinary screens, each turn four source pixels into
+ * scale whole vectors with unpacks or shuffles. Bigger factors store each pixel four at a time.
+ */
+void upscale_row_sse2(Uint32* dest, Uint32* source, int width, int scale){
+
+    int i = 0;
+    if(scale == 2){
+
+        for(; i + 4 <= width; i += 4){
+
+            __m128i pixels = _mm_loadu_si128((__m128i*)(source + i));
+            _mm_storeu_si128((__m128i*)dest, _mm_unpacklo_epi32(pixels, pixels));
+            _mm_storeu_si128((__m128i*)(dest + 4), _mm_unpackhi_epi32(pixels, pixels));
+            dest += 8;
+        }
+
+    }else if(scale == 3){
+
+        for(; i + 4 <= width; i += 4){
+
+            __m128i pixels = _mm_loadu_si128((__m128i*)(source + i));
+            _mm_storeu_si128((__m128i*)dest, _mm_shuffle_epi32(pixels, _MM_SHUFFLE(1, 0, 0, 0)));
+            _mm_storeu_si128((__m128i*)(dest + 4), _mm_shuffle_epi32(pixels, _MM_SHUFFLE(2, 2, 1, 1)));
+            _mm_storeu_si128((__m128i*)(dest + 8), _mm_shuffle_epi32(pixels, _MM_SHUFFLE(3, 3, 3, 2)));
+            dest += 12;
+        }
+
+    }else if(scale == 4){
+
+        for(; i + 4 <= width; i += 4){
+
+            __m128i pixels = _mm_loadu_si128((__m128i*)(source + i));
+            _mm_storeu_si128((__m128i*)dest, _mm_shuffle_epi32(pixels, _MM_SHUFFLE(0, 0, 0, 0)));
+            _mm_storeu_si128((__m128i*)(dest + 4), _mm_shuffle_epi32(pixels, _MM_SHUFFLE(1, 1, 1, 1)));
+            _mm_storeu_si128((__m128i*)(dest + 8), _mm_shuffle_epi32(pixels, _MM_SHUFFLE(2, 2, 2, 2)));
+            _mm_storeu_si128((__m128i*)(dest + 12), _mm_shuffle_epi32(pixels, _MM_SHUFFLE(3, 3, 3, 3)));
+            dest += 16;
+        }
+
+    }else{
+
+        for(; i < width; i++){
+
+            __m128i pixel = _mm_set1_epi32((int)source[i]);
+            int j = 0;
+            for(; j + 4 <= scale; j += 4){
+
+                _mm_storeu_si128((__m128i*)(dest + j), pixel);
+            }
+            for(; j < scale; j++){
+
+                dest[j] = source[i];
+            }
+            dest += scale;
+        }
+    }
+
+    upscale_row_scalar(dest, source + i, width - i, scale);
+}
+
+#endif
+
+void upscale_row(Uint32* dest, Uint32* source, int width, int scale){
+
+    if(scale == 1){
+
+        memcpy(dest, source, width * sizeof(Uint32));
+        return;
+    }
+#ifdef UPSCALE_SSE2
+    upscale_row_sse2(dest, source, width, scale);
+#else
+    upscale_row_scalar(dest, source, width, scale);
+#endif
+}
+
+bool upscaler_init(Upscaler* upscaler, SDL_Renderer* renderer, int logical_width, int logical_height){
+
+    upscaler->logical_width = logical_width;
+    upscaler->logical_height = logical_height;
+    upscaler->scale = 1;
+    upscaler->offset_x = 0;
+    upscaler->offset_y = 0;
+    upscaler->output_width = 0;
+    upscaler->output_height = 0;
+    upscaler->output = NULL;
+    upscaler->frame = NULL;
+
+    // Nearest neighbour for the accelerated stretch, must be set before the texture is made
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
+
+    SDL_RendererInfo info;
+    upscaler->software = SDL_GetRendererInfo(renderer, &info) != 0 || (info.flags & SDL_RENDERER_SOFTWARE);
+
+    upscaler->target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, logical_width, logical_height);
+    if(upscaler->target == NULL){
+
+        printf("Unable to create upscale target! SDL Error: %s\n", SDL_GetError());
+        return false;
+    }
+    if(upscaler->software){
+
+        upscaler->frame = (Uint32*)malloc(logical_width * logical_height * sizeof(Uint32));
+    }
+
+    return true;
+}
+
+void upscaler_free(Upscaler* upscaler){
+
+    if(upscaler->target != NULL){
+
+        SDL_DestroyTexture(upscaler->target);
+    }
+    if(upscaler->output != NULL){
+
+        SDL_DestroyTexture(upscaler->output);
+    }
+    free(upscaler->frame);
+    upscaler->target = NULL;
+    upscaler->output = NULL;
+    upscaler->frame = NULL;
+}
+
+// Picks the factor for the window's current size, only doing any work when that size changes
+void upscaler_fit(Upscaler* upscaler, SDL_Renderer* renderer){
+
+    int width, height;
+    if(SDL_GetRendererOutputSize(renderer, &width, &height) != 0){
+
+        return;
+    }
+    if(width == upscaler->output_width && height == upscaler->output_height && (upscaler->output != NULL || !upscaler->software)){
+
+        return;
+    }
+    upscaler->output_width = width;
+    upscaler->output_height = height;
+
+    int scale_x = width / upscaler->logical_width;
+    int scale_y = height / upscaler->logical_height;
+    upscaler->scale = scale_x < scale_y ? scale_x : scale_y;
+    if(upscaler->scale < 1){
+
+        upscaler->scale = 1;
+    }
+    upscaler->offset_x = (width - (upscaler->logical_width * upscaler->scale)) / 2;
+    upscaler->offset_y = (height - (upscaler->logical_height * upscaler->scale)) / 2;
+
+    if(upscaler->software){
+
+        if(upscaler->output != NULL){
+
+            SDL_DestroyTexture(upscaler->output);
+        }
+        upscaler->output = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, upscaler->logical_width * upscaler->scale, upscaler->logical_height * upscaler->scale);
+        if(upscaler->output == NULL){
+
+            printf("Unable to create upscale output! SDL Error: %s\n", SDL_GetError());
+        }
+    }
+}
+
+void upscaler_begin_frame(Upscaler* upscaler, SDL_Renderer* renderer){
+
+    upscaler_fit(upscaler, renderer);
+    SDL_SetRenderTarget(renderer, upscaler->target);
+}
+
+void upscaler_end_frame(Upscaler* upscaler, SDL_Renderer* renderer){
+
+    SDL_Rect dest = { upscaler->offset_x, upscaler->offset_y, upscaler->logical_width * upscaler->scale, upscaler->logical_height * upscaler->scale };
+
+    if(!upscaler->software){
+
+        SDL_SetRenderTarget(renderer, NULL);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+        SDL_RenderCopy(renderer, upscaler->target, NULL, &dest);
+        return;
+    }
+
+    if(upscaler->frame == NULL || upscaler->output == NULL){
+
+        SDL_SetRenderTarget(renderer, NULL);
+        return;
+    }
+    SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ARGB8888, upscaler->frame, upscaler->logical_width * sizeof(Uint32));
+    SDL_SetRenderTarget(renderer, NULL);
+
+    void* pixels;
+    int pitch;
+    if(SDL_LockTexture(upscaler->output, NULL, &pixels, &pitch) != 0){
+
+        return;
+    }
+
+    // Widen each row once, then the other scale - 1 copies of it are plain row copies
+    int row_bytes = dest.w * sizeof(Uint32);
+    for(int row = 0; row < upscaler->logical_height; row++){
+
+        Uint8* first = (Uint8*)pixels + (row * upscaler->scale * pitch);
+        upscale_row((Uint32*)first, upscaler->frame + (row * upscaler->logical_width), upscaler->logical_width, upscaler->scale);
+        for(int copy = 1; copy < upscaler->scale; copy++){
+
+            memcpy(first + (copy * pitch), first, row_bytes);
+        }
+    }
+    SDL_UnlockTexture(upscaler->output);
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, upscaler->output, NULL, &dest);
+}
+
+void upscaler_map_point(Upscaler* upscaler, int window_x, int window_y, int* x, int* y){
+
+    *x = (window_x - upscaler->offset_x) / upscaler->scale;
+    *y = (window_y - upscaler->offset_y) / upscaler->scale;
+
+    // Clicks on the black bars land on the nearest edge
+    if(window_x < upscaler->offset_x){
+
+        *x = 0;
+    }
+    if(window_y < upscaler->offset_y){
+
+        *y = 0;
+    }
+    if(*x >= upscaler->logical_width){
+
+        *x = upscaler->logical_width - 1;
+    }
+    if(*y >= upscaler->logical_height){
+
+        *y = upscaler->logical_height - 1;
+    }
+}
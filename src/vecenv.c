@@ -0,0 +1,344 @@
+#include "vecenv.h"
+#include <SDL2/SDL.h>
+
+typedef struct Env{
+
+    State state;
+
+    // Ring buffer of earlier states for undo, so that stepping never touches the heap
+    State history[VECENV_HISTORY_DEPTH];
+    int history_start;
+    int history_length;
+} Env;
+
+typedef struct VecEnvWorker{
+
+    struct VecEnv* vecenv;
+    SDL_Thread* thread;
+    SDL_sem* start;
+    int first_env;
+    int end_env;
+    Pathfinder pathfinder;
+} VecEnvWorker;
+
+struct VecEnv{
+
+    State initial_state;
+    int env_count;
+    int plane_size;
+    int env_observation_size;
+    Env* envs;
+
+    int thread_count;
+    VecEnvWorker* workers;
+    SDL_sem* done;
+    bool quit;
+
+    // Arguments of the batch currently being processed by the workers
+    bool resetting;
+    int* actions;
+    unsigned char* observations;
+    float* rewards;
+    bool* dones;
+};
+
+void vecenv_reset_env(VecEnv* vecenv, Env* env);
+void vecenv_step_env(VecEnv* vecenv, int env_index, Pathfinder* pathfinder);
+void vecenv_write_observation(VecEnv* vecenv, State* current_state, unsigned char* observation);
+void vecenv_run_slice(VecEnvWorker* worker);
+int vecenv_worker_thread(void* data);
+
+VecEnv* vecenv_create(char* filename, int env_count, int thread_count){
+
+    if(env_count <= 0){
+
+        return NULL;
+    }
+
+    State* loaded_state = get_from_file(filename);
+    if(loaded_state == NULL){
+
+        return NULL;
+    }
+
+    VecEnv* vecenv = (VecEnv*)malloc(sizeof(VecEnv));
+    vecenv->initial_state = *loaded_state;
+    vecenv->initial_state.previous_state = NULL;
+    free(loaded_state);
+
+    vecenv->env_count = env_count;
+    vecenv->plane_size = vecenv->initial_state.map_width * vecenv->initial_state.map_height;
+    vecenv->env_observation_size = VECENV_CHANNEL_COUNT * vecenv->plane_size;
+    vecenv->envs = (Env*)malloc(env_count * sizeof(Env));
+    for(int i = 0; i < env_count; i++){
+
+        vecenv_reset_env(vecenv, &vecenv->envs[i]);
+    }
+
+    if(thread_count < 1){
+
+        thread_count = 1;
+    }
+    if(thread_count > env_count){
+
+        thread_count = env_count;
+    }
+    vecenv->thread_count = thread_count;
+    vecenv->quit = false;
+    vecenv->done = SDL_CreateSemaphore(0);
+    vecenv->workers = (VecEnvWorker*)malloc(thread_count * sizeof(VecEnvWorker));
+
+    // Worker 0 is the calling thread, the others wait on their start semaphore for each batch
+    for(int i = 0; i < thread_count; i++){
+
+        VecEnvWorker* worker = &vecenv->workers[i];
+        worker->vecenv = vecenv;
+        worker->first_env = (env_count * i) / thread_count;
+        worker->end_env = (env_count * (i + 1)) / thread_count;
+        worker->start = NULL;
+        worker->thread = NULL;
+        pathfinder_init(&worker->pathfinder);
+
+        if(i != 0){
+
+            worker->start = SDL_CreateSemaphore(0);
+            worker->thread = SDL_CreateThread(vecenv_worker_thread, "vecenv", worker);
+        }
+    }
+
+    return vecenv;
+}
+
+void vecenv_destroy(VecEnv* vecenv){
+
+    vecenv->quit = true;
+    for(int i = 1; i < vecenv->thread_count; i++){
+
+        SDL_SemPost(vecenv->workers[i].start);
+    }
+    for(int i = 0; i < vecenv->thread_count; i++){
+
+        VecEnvWorker* worker = &vecenv->workers[i];
+        if(worker->thread != NULL){
+
+            SDL_WaitThread(worker->thread, NULL);
+            SDL_DestroySemaphore(worker->start);
+        }
+        pathfinder_free(&worker->pathfinder);
+    }
+
+    SDL_DestroySemaphore(vecenv->done);
+    free(vecenv->workers);
+    free(vecenv->envs);
+    free(vecenv);
+}
+
+int vecenv_env_count(VecEnv* vecenv){
+
+    return vecenv->env_count;
+}
+
+int vecenv_map_width(VecEnv* vecenv){
+
+    return vecenv->initial_state.map_width;
+}
+
+int vecenv_map_height(VecEnv* vecenv){
+
+    return vecenv->initial_state.map_height;
+}
+
+int vecenv_observation_size(VecEnv* vecenv){
+
+    return vecenv->env_count * vecenv->env_observation_size;
+}
+
+State* vecenv_get_state(VecEnv* vecenv, int env_index){
+
+    return &vecenv->envs[env_index].state;
+}
+
+void vecenv_reset(VecEnv* vecenv, unsigned char* observations){
+
+    vecenv->resetting = true;
+    vecenv->actions = NULL;
+    vecenv->observations = observations;
+    vecenv->rewards = NULL;
+    vecenv->dones = NULL;
+
+    for(int i = 1; i < vecenv->thread_count; i++){
+
+        SDL_SemPost(vecenv->workers[i].start);
+    }
+    vecenv_run_slice(&vecenv->workers[0]);
+    for(int i = 1; i < vecenv->thread_count; i++){
+
+        SDL_SemWait(vecenv->done);
+    }
+}
+
+void vecenv_step(VecEnv* vecenv, int* actions, unsigned char* observations, float* rewards, bool* dones){
+
+    vecenv->resetting = false;
+    vecenv->actions = actions;
+    vecenv->observations = observations;
+    vecenv->rewards = rewards;
+    vecenv->dones = dones;
+
+    for(int i = 1; i < vecenv->thread_count; i++){
+
+        SDL_SemPost(vecenv->workers[i].start);
+    }
+    vecenv_run_slice(&vecenv->workers[0]);
+    for(int i = 1; i < vecenv->thread_count; i++){
+
+        SDL_SemWait(vecenv->done);
+    }
+}
+
+void vecenv_reset_env(VecEnv* vecenv, Env* env){
+
+    env->state = vecenv->initial_state;
+    env->history_start = 0;
+    env->history_length = 0;
+}
+
+void vecenv_step_env(VecEnv* vecenv, int env_index, Pathfinder* pathfinder){
+
+    Env* env = &vecenv->envs[env_index];
+    int action = vecenv->actions[env_index];
+
+    if(action == PLAYER_MOVE_UNDO){
+
+        if(env->history_length != 0){
+
+            env->history_length--;
+            env->state = env->history[(env->history_start + env->history_length) % VECENV_HISTORY_DEPTH];
+        }
+
+    }else if(action >= PLAYER_MOVE_UP && action <= PLAYER_MOVE_WAIT){
+
+        // Push the current state, dropping the oldest one once the history is full
+        State* previous_state = &env->history[(env->history_start + env->history_length) % VECENV_HISTORY_DEPTH];
+        if(env->history_length == VECENV_HISTORY_DEPTH){
+
+            env->history_start = (env->history_start + 1) % VECENV_HISTORY_DEPTH;
+
+        }else{
+
+            env->history_length++;
+        }
+        *previous_state = env->state;
+
+        simulate_move(&env->state, previous_state, action, pathfinder);
+    }
+
+    int victory = env->state.victory;
+    if(vecenv->rewards != NULL){
+
+        vecenv->rewards[env_index] = (float)victory;
+    }
+    if(vecenv->dones != NULL){
+
+        vecenv->dones[env_index] = victory != 0;
+    }
+    if(victory != 0){
+
+        vecenv_reset_env(vecenv, env);
+    }
+}
+
+void vecenv_write_observation(VecEnv* vecenv, State* current_state, unsigned char* observation){
+
+    int plane_size = vecenv->plane_size;
+    int map_width = current_state->map_width;
+    memset(observation, 0, vecenv->env_observation_size);
+
+    if(square_in_bounds(current_state, current_state->player_x, current_state->player_y)){
+
+        observation[(VECENV_CHANNEL_PLAYER * plane_size) + (current_state->player_y * map_width) + current_state->player_x] = 1;
+    }
+
+    for(int i = 0; i < MAX_DUCK_COUNT; i++){
+
+        int x = current_state->duckling_x[i];
+        int y = current_state->duckling_y[i];
+        if(x == -1 || !square_in_bounds(current_state, x, y)){
+
+            continue;
+        }
+
+        int channel = VECENV_CHANNEL_FOLLOWING_DUCKLING;
+        if(current_state->duckling_follows[i] == i){
+
+            channel = current_state->duckling_waddles[i] ? VECENV_CHANNEL_WADDLER : VECENV_CHANNEL_IDLE_DUCKLING;
+        }
+        observation[(channel * plane_size) + (y * map_width) + x] = 1;
+
+        if(current_state->duckling_holds_bread[i]){
+
+            observation[(VECENV_CHANNEL_HELD_BREAD * plane_size) + (y * map_width) + x] = 1;
+        }
+    }
+
+    for(int i = 0; i < MAX_BREAD_COUNT; i++){
+
+        int x = current_state->bread_x[i];
+        int y = current_state->bread_y[i];
+        if(x != -1 && square_in_bounds(current_state, x, y)){
+
+            observation[(VECENV_CHANNEL_BREAD * plane_size) + (y * map_width) + x] = 1;
+        }
+    }
+
+    for(int i = 0; i < MAX_GOOSE_COUNT; i++){
+
+        int x = current_state->goose_x[i];
+        int y = current_state->goose_y[i];
+        if(x != -1 && square_in_bounds(current_state, x, y)){
+
+            observation[(VECENV_CHANNEL_GOOSE * plane_size) + (y * map_width) + x] = 1;
+        }
+    }
+}
+
+void vecenv_run_slice(VecEnvWorker* worker){
+
+    VecEnv* vecenv = worker->vecenv;
+    for(int i = worker->first_env; i < worker->end_env; i++){
+
+        if(vecenv->resetting){
+
+            vecenv_reset_env(vecenv, &vecenv->envs[i]);
+
+        }else{
+
+            vecenv_step_env(vecenv, i, &worker->pathfinder);
+        }
+
+        if(vecenv->observations != NULL){
+
+            vecenv_write_observation(vecenv, &vecenv->envs[i].state, vecenv->observations + (i * vecenv->env_observation_size));
+        }
+    }
+}
+
+int vecenv_worker_thread(void* data){
+
+    VecEnvWorker* worker = (VecEnvWorker*)data;
+    VecEnv* vecenv = worker->vecenv;
+
+    while(true){
+
+        SDL_SemWait(worker->start);
+        if(vecenv->quit){
+
+            break;
+        }
+
+        vecenv_run_slice(worker);
+        SDL_SemPost(vecenv->done);
+    }
+
+    return 0;
+}